@@ -0,0 +1,99 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.h"
+#include "testsuite.h"
+#include "errorlogger.h"
+
+#include <cstring>
+#include <list>
+#include <sstream>
+#include <string>
+
+class BenchErrorLogger : public TestFixture
+{
+public:
+    BenchErrorLogger() : TestFixture("BenchErrorLogger")
+    { }
+
+private:
+
+    void run()
+    {
+        TEST_CASE(errorMessageIpc);
+    }
+
+    /**
+     * Round trip of error messages through the framing that the child
+     * processes of -j use: serialize and frame them in batches, then
+     * parse the frames and deserialize the messages.
+     */
+    void errorMessageIpc()
+    {
+        std::list<ErrorLogger::ErrorMessage::FileLocation> locations;
+        locations.push_back(ErrorLogger::ErrorMessage::FileLocation("lib/checkmemoryleak.cpp", 1234));
+        locations.push_back(ErrorLogger::ErrorMessage::FileLocation("lib/tokenize.h", 56));
+        const ErrorLogger::ErrorMessage msg(locations,
+                                            Severity::style,
+                                            "Variable 'abc' is assigned a value that is never used\n"
+                                            "Variable 'abc' is assigned a value that is never used",
+                                            "unreadVariable");
+
+        const unsigned int messages = 100000;
+        const std::size_t batchSize = 65536;
+        std::size_t bytes = 0;
+        unsigned int received = 0;
+
+        Stopwatch stopwatch;
+        std::string batch;
+        for (unsigned int i = 0; i < messages; ++i)
+        {
+            const std::string data(msg.serialize());
+            const unsigned int len = data.size();
+            batch.append(1, '2');
+            batch.append(reinterpret_cast<const char *>(&len), sizeof(len));
+            batch.append(data);
+
+            if (batch.size() < batchSize && i + 1 < messages)
+                continue;
+
+            // Parse the frames where they are in the batch
+            std::size_t pos = 0;
+            while (pos < batch.size())
+            {
+                unsigned int frameLen = 0;
+                std::memcpy(&frameLen, batch.data() + pos + 1, sizeof(frameLen));
+                ErrorLogger::ErrorMessage parsed;
+                if (parsed.deserialize(batch.data() + pos + 1 + sizeof(frameLen), frameLen))
+                    ++received;
+                pos += 1 + sizeof(frameLen) + frameLen;
+            }
+            bytes += batch.size();
+            batch.clear();
+        }
+        const double ms = stopwatch.elapsed();
+
+        std::ostringstream ostr;
+        ostr << messages << " messages, " << (ms > 0 ? bytes / 1048576.0 / (ms / 1000.0) : 0.0) << " MB/s,";
+        report("errorMessageIpc", ostr.str(), ms);
+
+        ASSERT_EQUALS(messages, received);
+    }
+};
+
+REGISTER_TEST(BenchErrorLogger)
@@ -0,0 +1,47 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.h"
+
+#include <iostream>
+#include <sstream>
+
+void report(const std::string &benchmark, const std::string &what, double ms)
+{
+    std::cout << benchmark << ": " << what << " " << ms << " ms" << std::endl;
+}
+
+std::string benchmarkCode(unsigned int functions)
+{
+    std::ostringstream ostr;
+    for (unsigned int i = 0; i < functions; ++i)
+    {
+        ostr << "int f" << i << "(int a, char *p)\n"
+             << "{\n"
+             << "    int x = 3;\n"
+             << "    char *s = new char[10];\n"
+             << "    if (a == 0) { return x; }\n"
+             << "    while (x < a) { x += a | 1; p[x] = 0; }\n"
+             << "    if (!p || a > 10) { delete [] s; return 0; }\n"
+             << "    strcpy(s, \"abc\");\n"
+             << "    delete [] s;\n"
+             << "    return a + x;\n"
+             << "}\n";
+    }
+    return ostr.str();
+}
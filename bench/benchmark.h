@@ -0,0 +1,52 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef benchmarkH
+#define benchmarkH
+
+#include "timer.h"
+
+#include <string>
+
+/**
+ * @brief Wall time since the Stopwatch was created, for the
+ * benchmarks
+ */
+class Stopwatch
+{
+public:
+    Stopwatch() : _start(Timer::now())
+    { }
+
+    /** Elapsed time in milliseconds */
+    double elapsed() const
+    {
+        return (Timer::now() - _start) * 1000.0;
+    }
+
+private:
+    const double _start;
+};
+
+/** Write the time of a benchmark to stdout */
+void report(const std::string &benchmark, const std::string &what, double ms);
+
+/** Synthetic code with the given number of functions */
+std::string benchmarkCode(unsigned int functions);
+
+#endif
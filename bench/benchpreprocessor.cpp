@@ -0,0 +1,149 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.h"
+#include "testsuite.h"
+#include "settings.h"
+#include "preprocessor.h"
+
+#include <list>
+#include <sstream>
+#include <string>
+
+class BenchPreprocessor : public TestFixture
+{
+public:
+    BenchPreprocessor() : TestFixture("BenchPreprocessor")
+    { }
+
+private:
+
+    void run()
+    {
+        TEST_CASE(preprocessorRead);
+        TEST_CASE(preprocessorConfigurations);
+    }
+
+    /**
+     * Throughput of Preprocessor::read() on a large header with
+     * comments, line splices and CRLF line endings.
+     */
+    void preprocessorRead()
+    {
+        std::ostringstream ostr;
+        for (unsigned int i = 0; i < 2000; ++i)
+        {
+            ostr << "/**\r\n"
+                 << " * Documentation of f" << i << "()\r\n"
+                 << " * @param a the value\r\n"
+                 << " */\r\n"
+                 << "#define F" << i << "(a) \\\r\n"
+                 << "    ((a) + " << i << ")\r\n"
+                 << "\r\n"
+                 << "// f" << i << "\r\n"
+                 << "inline int f" << i << "(int a, char *p)\r\n"
+                 << "{\r\n"
+                 << "\tint x = F" << i << "(a); /* x */\r\n"
+                 << "\tif (!p || a > 10) { return 0; }\r\n"
+                 << "\tstrcpy(p, \"abc // def\");\r\n"
+                 << "\treturn a + x;\r\n"
+                 << "}\r\n";
+        }
+        const std::string header(ostr.str());
+
+        Settings settings;
+        Preprocessor preprocessor(&settings, this);
+        const unsigned int rounds = 10;
+        std::size_t length = 0;
+
+        Stopwatch stopwatch;
+        for (unsigned int i = 0; i < rounds; ++i)
+        {
+            std::istringstream istr(header);
+            length += preprocessor.read(istr, "header.h", &settings).size();
+        }
+        const double ms = stopwatch.elapsed();
+
+        std::ostringstream result;
+        result << (header.size() / 1024) << " kB header, " << (ms > 0 ? rounds * header.size() / 1048576.0 / (ms / 1000.0) : 0.0) << " MB/s,";
+        report("preprocessorRead", result.str(), ms);
+
+        ASSERT_EQUALS(true, length > 0);
+    }
+
+    /**
+     * Find the configurations of a file with thousands of #ifdef and
+     * #define lines and deep #if nesting.
+     */
+    void preprocessorConfigurations()
+    {
+        std::ostringstream ostr;
+        unsigned int directives = 0;
+        for (unsigned int block = 0; block < 100; ++block)
+        {
+            const unsigned int depth = 20;
+            for (unsigned int level = 0; level < depth; ++level)
+            {
+                switch (level % 4)
+                {
+                case 0:
+                    ostr << "#ifdef A" << level << "\n";
+                    break;
+                case 1:
+                    ostr << "#ifndef B" << block << "_" << level << "\n";
+                    break;
+                case 2:
+                    ostr << "#if defined(A" << level << ") && defined(C" << block % 10 << ")\n";
+                    break;
+                default:
+                    ostr << "#if D" << block << " > 1\n";
+                    break;
+                }
+                ostr << "#define K" << block << "_" << level << " " << level << "\n"
+                     << "int x" << block << "_" << level << ";\n";
+                directives += 2;
+            }
+            for (unsigned int level = 0; level < depth; ++level)
+            {
+                ostr << "#else\n"
+                     << "int y" << block << "_" << level << ";\n"
+                     << "#endif\n";
+                directives += 2;
+            }
+        }
+        const std::string code(ostr.str());
+
+        Settings settings;
+        Preprocessor preprocessor(&settings, this);
+        std::istringstream istr(code);
+        std::string processedFile;
+        std::list<std::string> configurations;
+
+        Stopwatch stopwatch;
+        preprocessor.preprocess(istr, processedFile, configurations, "file.c", std::list<std::string>());
+        const double ms = stopwatch.elapsed();
+
+        std::ostringstream result;
+        result << directives << " directives, " << configurations.size() << " configurations,";
+        report("preprocessorConfigurations", result.str(), ms);
+
+        ASSERT_EQUALS(true, configurations.size() > 1);
+    }
+};
+
+REGISTER_TEST(BenchPreprocessor)
@@ -0,0 +1,35 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// Micro benchmarks. They are not run by testrunner, build and run them with:
+// make benchmark && ./benchmark [BenchmarkName]
+
+
+#include <cstdlib>
+#include "testsuite.h"
+#include "options.h"
+
+int main(int argc, const char *argv[])
+{
+    options args(argc, argv);
+
+    size_t ret = TestFixture::runTests(args);
+
+    return (ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,171 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.h"
+#include "testsuite.h"
+#include "testutils.h"
+#include "token.h"
+#include "tokenize.h"
+#include "settings.h"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+class BenchToken : public TestFixture
+{
+public:
+    BenchToken() : TestFixture("BenchToken")
+    { }
+
+private:
+
+    void run()
+    {
+        TEST_CASE(tokenMatch);
+        TEST_CASE(tokenArena);
+        TEST_CASE(tokenLayout);
+    }
+
+    void tokenMatch()
+    {
+        const char * const patterns[] =
+        {
+            "%var% = %num% ;",
+            "[;{}] %type% * %var% = new",
+            "if|while ( %var% ==|<|> %any% )",
+            "delete [ ] %var% ;",
+            "return %var%|%num% ;",
+            "{|} !!else",
+            "strcpy|strcat ( %var% , %str% )",
+            "%var% [ %var% ] =",
+            0
+        };
+
+        givenACodeSampleToTokenize sample(benchmarkCode(100));
+
+        std::vector<MatchPattern *> compiled;
+        for (unsigned int i = 0; patterns[i]; ++i)
+            compiled.push_back(new MatchPattern(patterns[i]));
+
+        const unsigned int iterations = 20;
+        unsigned int matchCount = 0, compiledCount = 0;
+
+        {
+            Stopwatch stopwatch;
+            for (unsigned int n = 0; n < iterations; ++n)
+            {
+                for (const Token *tok = sample.tokens(); tok; tok = tok->next())
+                {
+                    for (unsigned int i = 0; patterns[i]; ++i)
+                        matchCount += Token::Match(tok, patterns[i]) ? 1U : 0U;
+                }
+            }
+            report("tokenMatch", "Token::Match", stopwatch.elapsed());
+        }
+
+        {
+            Stopwatch stopwatch;
+            for (unsigned int n = 0; n < iterations; ++n)
+            {
+                for (const Token *tok = sample.tokens(); tok; tok = tok->next())
+                {
+                    for (unsigned int i = 0; i < compiled.size(); ++i)
+                        compiledCount += compiled[i]->match(tok) ? 1U : 0U;
+                }
+            }
+            report("tokenMatch", "MatchPattern::match", stopwatch.elapsed());
+        }
+
+        for (unsigned int i = 0; i < compiled.size(); ++i)
+            delete compiled[i];
+
+        ASSERT(matchCount > 0);
+        ASSERT_EQUALS(matchCount, compiledCount);
+    }
+
+    /** Tokenize and simplify the code, return the simplified code */
+    static std::string tokenizeAndSimplify(const std::string &code, bool arena)
+    {
+        Settings settings;
+        Tokenizer tokenizer(&settings, 0);
+        if (!arena)
+            tokenizer.allocateTokensWithNew();
+        std::istringstream istr(code);
+        tokenizer.tokenize(istr, "test.cpp");
+        tokenizer.simplifyTokenList();
+        return tokenizer.tokens()->stringifyList(false);
+    }
+
+    void tokenArena()
+    {
+        const std::string sample(benchmarkCode(100));
+        const unsigned int iterations = 3;
+
+        std::string withArena, withoutArena;
+
+        {
+            Stopwatch stopwatch;
+            for (unsigned int n = 0; n < iterations; ++n)
+                withArena = tokenizeAndSimplify(sample, true);
+            report("tokenArena", "with arena", stopwatch.elapsed());
+        }
+
+        {
+            Stopwatch stopwatch;
+            for (unsigned int n = 0; n < iterations; ++n)
+                withoutArena = tokenizeAndSimplify(sample, false);
+            report("tokenArena", "without arena", stopwatch.elapsed());
+        }
+
+        ASSERT_EQUALS(withoutArena, withArena);
+    }
+
+    void tokenLayout()
+    {
+        std::cout << "tokenLayout: sizeof(Token) " << sizeof(Token) << " bytes" << std::endl;
+
+        givenACodeSampleToTokenize sample(benchmarkCode(200));
+
+        // Walk the token list and look at the properties that the checks use the most
+        const unsigned int iterations = 50;
+        unsigned int names = 0, numbers = 0, links = 0, varids = 0;
+        Stopwatch stopwatch;
+        for (unsigned int n = 0; n < iterations; ++n)
+        {
+            for (const Token *tok = sample.tokens(); tok; tok = tok->next())
+            {
+                if (tok->isName())
+                    ++names;
+                else if (tok->isNumber())
+                    ++numbers;
+                if (tok->link())
+                    ++links;
+                if (tok->varId())
+                    ++varids;
+            }
+        }
+        report("tokenLayout", "traverse and classify", stopwatch.elapsed());
+
+        ASSERT(names > 0);
+        ASSERT(numbers > 0);
+        ASSERT(links > 0);
+    }
+};
+
+REGISTER_TEST(BenchToken)
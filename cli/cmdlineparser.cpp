@@ -463,6 +463,21 @@ bool CmdLineParser::ParseFromArgs(int argc, const char* const argv[])
             }
         }
 
+        // How the files are checked with -j
+        else if (strncmp(argv[i], "--executor=", 11) == 0)
+        {
+            const std::string executor = argv[i] + 11;
+            if (executor == "processes")
+                _settings->_executor = Settings::EXECUTOR_PROCESSES;
+            else if (executor == "threads")
+                _settings->_executor = Settings::EXECUTOR_THREADS;
+            else
+            {
+                PrintMessage("cppcheck: argument to '--executor' must be 'processes' or 'threads'");
+                return false;
+            }
+        }
+
         // deprecated: auto deallocated classes..
         else if (strcmp(argv[i], "--auto-dealloc") == 0)
         {
@@ -513,6 +528,10 @@ bool CmdLineParser::ParseFromArgs(int argc, const char* const argv[])
                 _settings->_showtime = SHOWTIME_SUMMARY;
             else if (showtimeMode == "top5")
                 _settings->_showtime = SHOWTIME_TOP5;
+            else if (showtimeMode == "csv")
+                _settings->_showtime = SHOWTIME_CSV;
+            else if (showtimeMode == "json")
+                _settings->_showtime = SHOWTIME_JSON;
             else
                 _settings->_showtime = SHOWTIME_NONE;
         }
@@ -648,6 +667,12 @@ void CmdLineParser::PrintHelp()
               "                         provided. Note that your operating system can\n"
               "                         modify this value, e.g. 256 can become 0.\n"
               "    --errorlist          Print a list of all error messages in XML format.\n"
+              "    --executor=<type>    How the files are checked with -j. The types are:\n"
+              "                          * processes - a child process checks each file.\n"
+              "                                        This is the default.\n"
+              "                          * threads - worker threads check the files. They\n"
+              "                                      are used where fork() is not\n"
+              "                                      available.\n"
               "    --exitcode-suppressions=<file>\n"
               "                         Used when certain messages should be displayed but\n"
               "                         should not cause a non-zero exitcode.\n"
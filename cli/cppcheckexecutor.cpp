@@ -82,43 +82,47 @@ bool CppCheckExecutor::parseFromArgs(CppCheck *cppcheck, int argc, const char* c
     std::vector<std::string> pathnames = parser.GetPathNames();
     std::vector<std::string> filenames;
 
-    if (!pathnames.empty())
+    // With -j the files are checked while they are searched
+    if (_settings._jobs > 1 && ThreadExecutor::isEnabled())
     {
-        // Execute recursiveAddFiles() to each given file parameter
-        std::vector<std::string>::const_iterator iter;
-        for (iter = pathnames.begin(); iter != pathnames.end(); ++iter)
-            getFileLister()->recursiveAddFiles(filenames, Path::toNativeSeparators(iter->c_str()));
+        _searchPaths = pathnames;
+        _ignoredPaths = parser.GetIgnoredPaths();
+        return true;
     }
 
-    if (!filenames.empty())
-    {
-        PathMatch matcher(parser.GetIgnoredPaths());
-        std::vector<std::string>::iterator iterBegin = filenames.begin();
-        for (int i = (int)filenames.size() - 1; i >= 0; i--)
-        {
-            if (matcher.Match(filenames[(unsigned int)i]))
-                filenames.erase(iterBegin + i);
-        }
-    }
-    else
+    // The ignored paths are skipped when the files are searched
+    const PathMatch matcher(parser.GetIgnoredPaths());
+    std::vector<std::string>::const_iterator iter;
+    for (iter = pathnames.begin(); iter != pathnames.end(); ++iter)
+        getFileLister()->recursiveAddFiles(filenames, Path::toNativeSeparators(iter->c_str()), matcher);
+
+    if (filenames.empty())
     {
-        std::cout << "cppcheck: error: could not find or open any of the paths given." << std::endl;
+        reportNoFiles(pathnames, parser.GetIgnoredPaths());
         return false;
     }
 
-    if (!filenames.empty())
-    {
-        std::vector<std::string>::iterator iter;
-        for (iter = filenames.begin(); iter != filenames.end(); ++iter)
-            cppcheck->addFile(*iter);
+    for (iter = filenames.begin(); iter != filenames.end(); ++iter)
+        cppcheck->addFile(*iter);
 
-        return true;
+    return true;
+}
+
+void CppCheckExecutor::reportNoFiles(const std::vector<std::string> &pathnames, const std::vector<std::string> &ignoredPaths)
+{
+    // Were there any files before the ignored paths were skipped?
+    std::vector<std::string> found;
+    if (!ignoredPaths.empty())
+    {
+        std::vector<std::string>::const_iterator iter;
+        for (iter = pathnames.begin(); iter != pathnames.end() && found.empty(); ++iter)
+            getFileLister()->recursiveAddFiles(found, Path::toNativeSeparators(iter->c_str()));
     }
+
+    if (found.empty())
+        std::cout << "cppcheck: error: could not find or open any of the paths given." << std::endl;
     else
-    {
         std::cout << "cppcheck: error: no files to check - all paths ignored." << std::endl;
-        return false;
-    }
 }
 
 int CppCheckExecutor::check(int argc, const char* const argv[])
@@ -139,10 +143,14 @@ int CppCheckExecutor::check(int argc, const char* const argv[])
     }
 
     unsigned int returnValue = 0;
+    bool noFiles = false;
     if (_settings._jobs == 1)
     {
         // Single process
         returnValue = cppCheck.check();
+
+        if (_settings._showtime != SHOWTIME_NONE)
+            cppCheck.timerResults().ShowResults(std::cout, _settings._showtime);
     }
     else if (!ThreadExecutor::isEnabled())
     {
@@ -154,16 +162,33 @@ int CppCheckExecutor::check(int argc, const char* const argv[])
         const std::vector<std::string> &filenames = cppCheck.filenames();
         Settings &settings = cppCheck.settings();
         ThreadExecutor executor(filenames, settings, *this);
+        if (!_searchPaths.empty())
+            executor.searchFiles(_searchPaths, _ignoredPaths);
         returnValue = executor.check();
+
+        // The files are searched while they are checked, so it is known
+        // only now that there were none. The XML header is already written.
+        noFiles = executor.filenames().empty();
+
+        // The timer results of all the child processes
+        if (!noFiles && _settings._showtime != SHOWTIME_NONE)
+            executor.timerResults().ShowResults(std::cout, _settings._showtime);
     }
 
-    reportUnmatchedSuppressions(cppCheck.settings().nomsg.getUnmatchedGlobalSuppressions());
+    if (!noFiles)
+        reportUnmatchedSuppressions(cppCheck.settings().nomsg.getUnmatchedGlobalSuppressions());
 
     if (_settings._xml)
     {
         reportErr(ErrorLogger::ErrorMessage::getXMLFooter(_settings._xml_version));
     }
 
+    if (noFiles)
+    {
+        reportNoFiles(_searchPaths, _ignoredPaths);
+        return EXIT_FAILURE;
+    }
+
     if (returnValue)
         return _settings._exitCode;
     else
@@ -211,7 +236,12 @@ void CppCheckExecutor::reportProgress(const std::string &filename, const char st
 
 void CppCheckExecutor::reportStatus(unsigned int index, unsigned int max)
 {
-    if (max > 1 && !_settings._errorsOnly)
+    // The files are still being searched, the total is not known
+    if (max == 0 && !_settings._errorsOnly)
+    {
+        std::cout << index << " files checked" << std::endl;
+    }
+    else if (max > 1 && !_settings._errorsOnly)
     {
         std::ostringstream oss;
         oss << index << "/" << max
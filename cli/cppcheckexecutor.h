@@ -22,6 +22,8 @@
 #include "errorlogger.h"
 #include "settings.h"
 #include <ctime>
+#include <string>
+#include <vector>
 
 class CppCheck;
 
@@ -91,6 +93,13 @@ protected:
      */
     bool parseFromArgs(CppCheck *cppcheck, int argc, const char* const argv[]);
 
+    /**
+     * @brief Tell that no files were found, or that all were ignored
+     * @param pathnames the paths that were searched
+     * @param ignoredPaths the paths that were ignored
+     */
+    void reportNoFiles(const std::vector<std::string> &pathnames, const std::vector<std::string> &ignoredPaths);
+
     /**
      * check() will setup this in the beginning of check().
      */
@@ -107,6 +116,13 @@ private:
      * Has --errorlist been given?
      */
     bool errorlist;
+
+    /**
+     * The paths to search and the ignored paths, when the files are
+     * searched while they are checked with -j
+     */
+    std::vector<std::string> _searchPaths;
+    std::vector<std::string> _ignoredPaths;
 };
 
 #endif // CPPCHECKEXECUTOR_H
@@ -21,6 +21,7 @@
 #include <cctype>
 #include <algorithm>
 #include "filelister.h"
+#include "pathmatch.h"
 
 #if defined(_WIN32)
 #include "filelister_win32.h"
@@ -46,6 +47,25 @@ FileLister * getFileLister()
     return fileLister;
 }
 
+void FileLister::recursiveAddFiles(std::vector<std::string> &filenames, const std::string &path, const PathMatch &ignored)
+{
+    std::vector<std::string> found;
+    recursiveAddFiles(found, path);
+    for (std::vector<std::string>::const_iterator it = found.begin(); it != found.end(); ++it)
+    {
+        if (!ignored.Match(*it))
+            filenames.push_back(*it);
+    }
+}
+
+void FileLister::recursiveAddFiles(Receiver &receiver, const std::string &path, const PathMatch &ignored)
+{
+    std::vector<std::string> found;
+    recursiveAddFiles(found, path, ignored);
+    for (std::vector<std::string>::const_iterator it = found.begin(); it != found.end(); ++it)
+        receiver.fileFound(*it);
+}
+
 // This wrapper exists because Sun's CC does not allow a static_cast
 // from extern "C" int(*)(int) to int(*)(int).
 static int tolowerWrapper(int c)
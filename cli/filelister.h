@@ -22,6 +22,8 @@
 #include <vector>
 #include <string>
 
+class PathMatch;
+
 /// @addtogroup CLI
 /// @{
 
@@ -38,6 +40,19 @@ public:
      */
     virtual ~FileLister() {}
 
+    /**
+     * @brief Receives the files that are found, as soon as they are
+     * found. The files are received one at a time, but not necessarily
+     * in the thread that searches them.
+     */
+    class Receiver
+    {
+    public:
+        virtual ~Receiver() {}
+
+        virtual void fileFound(const std::string &filename) = 0;
+    };
+
     /**
      * @brief Recursively add source files to a vector.
      * Add source files from given directory and all subdirectries to the
@@ -49,6 +64,32 @@ public:
     virtual void recursiveAddFiles(std::vector<std::string> &filenames,
                                    const std::string &path) = 0;
 
+    /**
+     * @brief Recursively add the source files that are not ignored.
+     * Like recursiveAddFiles() but the files that match the ignored
+     * paths are not added. The default implementation filters the files
+     * afterwards, a filelister can skip the ignored directories instead.
+     * @param filenames output vector that filenames are written to
+     * @param path root path
+     * @param ignored the paths that are ignored
+     */
+    virtual void recursiveAddFiles(std::vector<std::string> &filenames,
+                                   const std::string &path,
+                                   const PathMatch &ignored);
+
+    /**
+     * @brief Recursively search the source files that are not ignored.
+     * The files are given to the receiver in the same order as
+     * recursiveAddFiles() adds them. The default implementation gives
+     * them when all have been found, a filelister can give them earlier.
+     * @param receiver receives the files
+     * @param path root path
+     * @param ignored the paths that are ignored
+     */
+    virtual void recursiveAddFiles(Receiver &receiver,
+                                   const std::string &path,
+                                   const PathMatch &ignored);
+
     /**
      * @brief Check if the file extension indicates that it's a source file.
      * Check if the file has source file extension: *.c;*.cpp;*.cxx;*.c++;*.cc;*.txx
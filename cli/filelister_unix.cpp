@@ -21,12 +21,19 @@
 #include <cstring>
 #include <string>
 #include <algorithm>
+#include <deque>
+#include <list>
+#include <set>
 
 #ifndef _WIN32 // POSIX-style system
 #include <glob.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #endif
 
 #ifndef _WIN32
@@ -34,76 +41,409 @@
 #include "path.h"
 #include "filelister.h"
 #include "filelister_unix.h"
+#include "pathmatch.h"
+#include "threading.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 ////// This code is POSIX-style systems ///////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+    struct Directory;
+
+    /** @brief A source file or a directory that has been found */
+    struct Entry
+    {
+        Entry() : directory(0), dev(0), ino(0)
+        { }
+
+        /** The file name that is added, or the path of the directory */
+        std::string path;
+
+        /** The directory, 0 if this is a file */
+        const Directory *directory;
+
+        /** Device and inode of the file, files that are found twice are added once */
+        dev_t dev;
+        ino_t ino;
+
+        /** Sort by name, like glob() does */
+        bool operator<(const Entry &other) const
+        {
+            return std::strcmp(path.c_str(), other.path.c_str()) < 0;
+        }
+    };
+
+    /** @brief A directory, it is read by one of the threads of DirectoryWalker */
+    struct Directory
+    {
+        Directory(const std::string &dirpath, const Directory *parentDirectory)
+            : path(dirpath), parent(parentDirectory), dev(0), ino(0), done(false)
+        { }
+
+        /** Path of the directory, it ends with a '/' */
+        std::string path;
+
+        /** The directory that this one was found in, 0 for a given path */
+        const Directory *parent;
+
+        /** Device and inode of the directory, to detect symbolic link loops */
+        dev_t dev;
+        ino_t ino;
+
+        /** The source files and directories in this directory, sorted by name */
+        std::vector<Entry> entries;
+
+        /** Has the directory been read? */
+        bool done;
+    };
+
+    /**
+     * @brief Reads directories with several threads. A thread that reads
+     * a directory queues the directories that it finds in it.
+     *
+     * The files are given to the receiver in a depth-first order. When a
+     * directory has been read, the files up to the first directory that
+     * is not read yet are given.
+     */
+    class DirectoryWalker
+    {
+    public:
+        DirectoryWalker(FileLister::Receiver &receiver, const PathMatch &ignored)
+            : _receiver(receiver), _ignored(ignored), _reading(0)
+        { }
+
+        /** Walk these entries, the given paths. The files in them are given first. */
+        void setRoots(const std::vector<Entry> &entries)
+        {
+            _roots = entries;
+            _position.push_back(std::make_pair(&_roots, (std::size_t)0));
+        }
+
+        /** Queue a directory to be read */
+        const Directory *add(const std::string &path, const Directory *parent)
+        {
+            MutexLock lock(_mutex);
+            _directories.push_back(Directory(path, parent));
+            Directory * const directory = &_directories.back();
+            _queue.push_back(directory);
+            _cond.signal();
+            return directory;
+        }
+
+        /** Read the queued directories and all directories in them */
+        void walk()
+        {
+            std::vector<Thread *> threads;
+            for (unsigned int i = 1; i < threadCount(); ++i)
+            {
+                Thread *thread = new Thread;
+                if (!thread->start(run, this))
+                {
+                    delete thread;
+                    break;
+                }
+                threads.push_back(thread);
+            }
+
+            // This thread reads directories too
+            work();
+
+            for (std::vector<Thread *>::const_iterator it = threads.begin(); it != threads.end(); ++it)
+            {
+                (*it)->join();
+                delete *it;
+            }
+
+            // When no directories were given
+            giveFiles();
+        }
+
+    private:
+        // Not implemented..
+        DirectoryWalker(const DirectoryWalker &);
+        DirectoryWalker &operator=(const DirectoryWalker &);
+
+        /** The directories are read by one thread for each processor */
+        static unsigned int threadCount()
+        {
+            const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+            return processors > 1 ? static_cast<unsigned int>(processors) : 1U;
+        }
+
+        static void run(void *walker)
+        {
+            static_cast<DirectoryWalker *>(walker)->work();
+        }
+
+        /** Read directories until all have been read */
+        void work()
+        {
+            MutexLock lock(_mutex);
+            while (true)
+            {
+                while (_queue.empty() && _reading > 0)
+                    _cond.wait(_mutex);
+                if (_queue.empty())
+                    break;
+
+                Directory * const directory = _queue.front();
+                _queue.pop_front();
+                ++_reading;
+                _mutex.unlock();
+
+                read(*directory);
+
+                _mutex.lock();
+                directory->done = true;
+                _mutex.unlock();
+
+                giveFiles();
+
+                _mutex.lock();
+                --_reading;
+                if (_queue.empty() && _reading == 0)
+                    _cond.broadcast();
+            }
+        }
+
+        /** Give the files that are before the first directory that is not read yet */
+        void giveFiles()
+        {
+            // The files are given in order, by one thread at a time
+            MutexLock receiverLock(_receiverMutex);
+
+            std::vector<const Entry *> files;
+            _mutex.lock();
+            while (!_position.empty())
+            {
+                std::pair<const std::vector<Entry> *, std::size_t> &position = _position.back();
+                if (position.second >= position.first->size())
+                {
+                    _position.pop_back();
+                    continue;
+                }
+
+                const Entry &entry = (*position.first)[position.second];
+                if (!entry.directory)
+                {
+                    files.push_back(&entry);
+                    ++position.second;
+                }
+                else if (entry.directory->done)
+                {
+                    ++position.second;
+                    _position.push_back(std::make_pair(&entry.directory->entries, (std::size_t)0));
+                }
+                else
+                {
+                    break;
+                }
+            }
+            _mutex.unlock();
+
+            // A file that is found several times is given once
+            for (std::vector<const Entry *>::const_iterator it = files.begin(); it != files.end(); ++it)
+            {
+                if (_given.insert(std::make_pair((*it)->dev, (*it)->ino)).second)
+                    _receiver.fileFound((*it)->path);
+            }
+        }
 
-void FileListerUnix::recursiveAddFiles2(std::vector<std::string> &relative,
-                                        std::vector<std::string> &absolute,
-                                        const std::string &path)
+        /** Read the entries of a directory and queue its directories */
+        void read(Directory &directory)
+        {
+            const int fd = open(directory.path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+
+            struct stat st;
+            if (fstat(fd, &st) != 0)
+            {
+                close(fd);
+                return;
+            }
+            directory.dev = st.st_dev;
+            directory.ino = st.st_ino;
+
+            // Don't loop forever in symbolic link loops
+            for (const Directory *parent = directory.parent; parent; parent = parent->parent)
+            {
+                if (parent->dev == directory.dev && parent->ino == directory.ino)
+                {
+                    close(fd);
+                    return;
+                }
+            }
+
+            DIR * const dir = fdopendir(fd);
+            if (!dir)
+            {
+                close(fd);
+                return;
+            }
+
+            std::vector<Entry> entries;
+            const struct dirent *dirent;
+            while ((dirent = readdir(dir)) != 0)
+            {
+                const char * const name = dirent->d_name;
+
+                // Hidden files and directories, "." and ".." are skipped
+                if (name[0] == '.')
+                    continue;
+
+                Entry entry;
+                entry.path = directory.path + name;
+
+                // The type is known without stat() on most file systems.
+                // Source files are stat()ed anyway to find them if they
+                // are found twice.
+                bool isDirectory = false;
+                bool statted = false;
+#ifdef DT_DIR
+                if (dirent->d_type == DT_DIR)
+                    isDirectory = true;
+                else if (dirent->d_type == DT_REG && !FileLister::acceptFile(entry.path))
+                    continue;
+                else if (dirent->d_type != DT_REG)
+#endif
+                {
+                    // A symbolic link, or the type is not known
+                    if (fstatat(dirfd(dir), name, &st, 0) != 0)
+                        continue;
+                    isDirectory = S_ISDIR(st.st_mode);
+                    statted = true;
+                }
+
+                if (isDirectory)
+                {
+                    entry.path += '/';
+                    if (_ignored.Match(entry.path))
+                        continue;
+                    entry.directory = add(entry.path, &directory);
+                }
+                else
+                {
+                    if (!FileLister::acceptFile(entry.path) || _ignored.Match(entry.path))
+                        continue;
+                    if (!statted && fstatat(dirfd(dir), name, &st, 0) != 0)
+                        continue;
+                    entry.dev = st.st_dev;
+                    entry.ino = st.st_ino;
+                }
+                entries.push_back(entry);
+            }
+            closedir(dir);
+
+            std::sort(entries.begin(), entries.end());
+            directory.entries.swap(entries);
+        }
+
+        FileLister::Receiver &_receiver;
+        const PathMatch &_ignored;
+
+        /** The given paths */
+        std::vector<Entry> _roots;
+
+        /** The entries that the next file is searched from, a stack with the deepest directory last */
+        std::vector<std::pair<const std::vector<Entry> *, std::size_t> > _position;
+
+        /** Device and inode of the files that have been given */
+        std::set<std::pair<dev_t, ino_t> > _given;
+
+        /** All directories that have been found, they are not moved in a deque */
+        std::deque<Directory> _directories;
+
+        /** The directories that are not read yet */
+        std::list<Directory *> _queue;
+
+        /** Number of directories that are being read */
+        unsigned int _reading;
+
+        Mutex _mutex;
+
+        /** Locked while files are given to the receiver */
+        Mutex _receiverMutex;
+
+        ConditionVariable _cond;
+    };
+
+    /** @brief Adds the files that are found to a vector */
+    class FileAdder : public FileLister::Receiver
+    {
+    public:
+        explicit FileAdder(std::vector<std::string> &filenames) : _filenames(filenames)
+        { }
+
+        virtual void fileFound(const std::string &filename)
+        {
+            _filenames.push_back(filename);
+        }
+
+    private:
+        std::vector<std::string> &_filenames;
+    };
+}
+
+void FileListerUnix::recursiveAddFiles(std::vector<std::string> &filenames, const std::string &path)
+{
+    const PathMatch nothingIgnored((std::vector<std::string>()));
+    recursiveAddFiles(filenames, path, nothingIgnored);
+}
+
+void FileListerUnix::recursiveAddFiles(std::vector<std::string> &filenames, const std::string &path, const PathMatch &ignored)
+{
+    FileAdder adder(filenames);
+    recursiveAddFiles(adder, path, ignored);
+}
+
+void FileListerUnix::recursiveAddFiles(Receiver &receiver, const std::string &path, const PathMatch &ignored)
 {
     std::ostringstream oss;
     oss << path;
     if (path.length() > 0 && path[path.length()-1] == '/')
         oss << "*";
 
+    // The given path can be a pattern
+    DirectoryWalker walker(receiver, ignored);
+    std::vector<Entry> entries;
     glob_t glob_results;
     glob(oss.str().c_str(), GLOB_MARK, 0, &glob_results);
     for (unsigned int i = 0; i < glob_results.gl_pathc; i++)
     {
-        const std::string filename = glob_results.gl_pathv[i];
-        if (filename == "." || filename == ".." || filename.length() == 0)
+        Entry entry;
+        entry.path = glob_results.gl_pathv[i];
+        if (entry.path == "." || entry.path == ".." || entry.path.length() == 0)
+            continue;
+        if (ignored.Match(entry.path))
             continue;
 
-        if (filename[filename.length()-1] != '/')
+        if (entry.path[entry.path.length()-1] != '/')
         {
-            // File
-#ifdef PATH_MAX
-            char fname[PATH_MAX];
-            if (realpath(filename.c_str(), fname) == NULL)
-#else
-            char *fname;
-            if ((fname = realpath(filename.c_str(), NULL)) == NULL)
-#endif
-            {
+            // File, it is checked even if it does not look like a source
+            // file when it is given
+            if (!Path::sameFileName(path, entry.path) && !FileLister::acceptFile(entry.path))
                 continue;
-            }
 
-            // Does absolute path exist? then bail out
-            if (std::find(absolute.begin(), absolute.end(), std::string(fname)) != absolute.end())
-            {
-#ifndef PATH_MAX
-                free(fname);
-#endif
+            struct stat st;
+            if (stat(entry.path.c_str(), &st) != 0)
                 continue;
-            }
-
-            if (Path::sameFileName(path,filename) || FileLister::acceptFile(filename))
-            {
-                relative.push_back(filename);
-                absolute.push_back(fname);
-            }
-
-#ifndef PATH_MAX
-            free(fname);
-#endif
+            entry.dev = st.st_dev;
+            entry.ino = st.st_ino;
         }
         else
         {
             // Directory
-            recursiveAddFiles2(relative, absolute, filename);
+            entry.directory = walker.add(entry.path, 0);
         }
+        entries.push_back(entry);
     }
     globfree(&glob_results);
-}
 
-
-void FileListerUnix::recursiveAddFiles(std::vector<std::string> &filenames, const std::string &path)
-{
-    std::vector<std::string> abs;
-    recursiveAddFiles2(filenames, abs, path);
+    walker.setRoots(entries);
+    walker.walk();
 }
 
 bool FileListerUnix::isDirectory(const std::string &path)
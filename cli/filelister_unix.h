@@ -27,17 +27,34 @@
 /// @{
 
 
+/**
+ * @brief Filelister for POSIX-style systems.
+ *
+ * The directories are read by several threads at the same time. The
+ * files are still added in the order of a depth-first search with the
+ * entries of each directory sorted by name, the same order that glob()
+ * gives. Hidden files and directories are skipped like glob() skips them.
+ */
 class FileListerUnix : public FileLister
 {
 public:
     virtual void recursiveAddFiles(std::vector<std::string> &filenames, const std::string &path);
+
+    /**
+     * @brief Recursively add the source files that are not ignored.
+     * The ignored directories are not read at all. A file that is found
+     * several times, for example through symbolic links, is added once.
+     */
+    virtual void recursiveAddFiles(std::vector<std::string> &filenames, const std::string &path, const PathMatch &ignored);
+
+    /**
+     * @brief Recursively search the source files that are not ignored.
+     * The files are given as soon as all the directories before them
+     * have been read.
+     */
+    virtual void recursiveAddFiles(Receiver &receiver, const std::string &path, const PathMatch &ignored);
+
     virtual bool isDirectory(const std::string &path);
-private:
-#ifndef _WIN32
-    void recursiveAddFiles2(std::vector<std::string> &relative,
-                            std::vector<std::string> &absolute,
-                            const std::string &path);
-#endif
 };
 
 /// @}
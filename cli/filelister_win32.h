@@ -31,6 +31,7 @@ class FileListerWin32 : public FileLister
 {
 public:
     virtual void recursiveAddFiles(std::vector<std::string> &filenames, const std::string &path);
+    using FileLister::recursiveAddFiles;
     virtual bool isDirectory(const std::string &path);
 private:
 
@@ -23,7 +23,7 @@ PathMatch::PathMatch(const std::vector<std::string> &masks)
 {
 }
 
-bool PathMatch::Match(const std::string &path)
+bool PathMatch::Match(const std::string &path) const
 {
     if (path.empty())
         return false;
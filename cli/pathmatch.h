@@ -40,10 +40,13 @@ public:
 
     /**
      * @brief Match path against list of masks.
+     *
+     * A directory is given with a '/' at the end. If it matches, all the
+     * files in it match too.
      * @param path Path to match.
      * @return true if any of the masks match the path, false otherwise.
      */
-    bool Match(const std::string &path);
+    bool Match(const std::string &path) const;
 
 protected:
 
@@ -52,7 +55,7 @@ protected:
      * @param path Path to edit.
      * @return path without filename part.
      */
-    std::string RemoveFilename(const std::string &path);
+    static std::string RemoveFilename(const std::string &path);
 
 private:
     std::vector<std::string> _masks;
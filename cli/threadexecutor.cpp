@@ -18,24 +18,36 @@
 
 #include "threadexecutor.h"
 #include "cppcheck.h"
+#include "filelister.h"
+#include "pathmatch.h"
+#include "path.h"
+#include "threading.h"
 #include <iostream>
 #include <algorithm>
+#include <cstdlib>
+#include <sys/stat.h>
 #ifdef THREADING_MODEL_FORK
 #include <sys/wait.h>
 #include <unistd.h>
 #include <fcntl.h>
-#include <cstdlib>
 #include <cstring>
 #include <cstdio>
 #include <errno.h>
 #include <time.h>
+#include <signal.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
 #endif
 
 ThreadExecutor::ThreadExecutor(const std::vector<std::string> &filenames, Settings &settings, ErrorLogger &errorLogger)
-    : _filenames(filenames), _settings(settings), _errorLogger(errorLogger), _fileCount(0)
+    : _filenames(filenames), _givenFiles(filenames.size()), _settings(settings), _errorLogger(errorLogger), _fileCount(0), _nextOutput(0), _searching(false)
 {
 #ifdef THREADING_MODEL_FORK
     _wpipe = 0;
+    _searchPipe[0] = _searchPipe[1] = -1;
 #endif
 }
 
@@ -49,51 +61,363 @@ void ThreadExecutor::addFileContent(const std::string &path, const std::string &
     _fileContents[ path ] = content;
 }
 
+void ThreadExecutor::searchFiles(const std::vector<std::string> &paths, const std::vector<std::string> &ignoredPaths)
+{
+    _searchPaths = paths;
+    _ignoredPaths = ignoredPaths;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
-////// This code is for platforms that support fork() only ////////////////////
+////// The worker processes are for platforms that support fork() only ////////
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifdef THREADING_MODEL_FORK
-
-int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
+namespace
 {
-    char type = 0;
-    if (read(rpipe, &type, 1) <= 0)
+    /** Read a block of data from a blocking pipe */
+    bool readAll(int fd, void *data, std::size_t len)
     {
-        if (errno == EAGAIN)
-            return 0;
+        char *p = static_cast<char *>(data);
+        while (len > 0)
+        {
+            const ssize_t bytes = read(fd, p, len);
+            if (bytes <= 0)
+                return false;
+            p += bytes;
+            len -= (std::size_t)bytes;
+        }
+        return true;
+    }
 
-        return -1;
+    bool readString(int fd, std::string &str)
+    {
+        unsigned int len = 0;
+        if (!readAll(fd, &len, sizeof(len)))
+            return false;
+        str.resize(len);
+        return len == 0 || readAll(fd, &str[0], len);
     }
 
-    if (type != '1' && type != '2' && type != '3')
+    /** Write a block of data to a blocking pipe */
+    bool writeAll(int fd, const void *data, std::size_t len)
     {
-        std::cerr << "#### You found a bug from cppcheck.\nThreadExecutor::handleRead error, type was:" << type << std::endl;
-        exit(0);
+        const char *p = static_cast<const char *>(data);
+        while (len > 0)
+        {
+            const ssize_t bytes = write(fd, p, len);
+            if (bytes <= 0)
+                return false;
+            p += bytes;
+            len -= (std::size_t)bytes;
+        }
+        return true;
     }
 
-    unsigned int len = 0;
-    if (read(rpipe, &len, sizeof(len)) <= 0)
+    bool writeString(int fd, const std::string &str)
     {
-        std::cerr << "#### You found a bug from cppcheck.\nThreadExecutor::handleRead error, type was:" << type << std::endl;
-        exit(0);
+        const unsigned int len = str.size();
+        return writeAll(fd, &len, sizeof(len)) && writeAll(fd, str.data(), len);
     }
+}
+#endif
 
-    char *buf = new char[len];
-    if (read(rpipe, buf, len) <= 0)
+namespace
+{
+    /**
+     * @brief Searches files with the FileLister in its own thread, see
+     * ThreadExecutor::searchFiles()
+     */
+    class FileSearch : public FileLister::Receiver
     {
-        std::cerr << "#### You found a bug from cppcheck.\nThreadExecutor::handleRead error, type was:" << type << std::endl;
-        exit(0);
+    public:
+        FileSearch(const std::vector<std::string> &paths, const std::vector<std::string> &ignoredPaths)
+            : _paths(paths), _ignored(ignoredPaths)
+        { }
+
+        virtual ~FileSearch()
+        { }
+
+        void run()
+        {
+            for (std::vector<std::string>::const_iterator it = _paths.begin(); it != _paths.end(); ++it)
+                getFileLister()->recursiveAddFiles(*this, Path::toNativeSeparators(*it), _ignored);
+            finished();
+        }
+
+        virtual void fileFound(const std::string &filename)
+        {
+            struct stat st;
+            const unsigned long size = (stat(filename.c_str(), &st) == 0) ? (unsigned long)st.st_size : 0;
+            found(Path::fromNativeSeparators(filename), size);
+        }
+
+    protected:
+        /** A file has been found, its size is the estimate of its cost */
+        virtual void found(const std::string &filename, unsigned long size) = 0;
+
+        /** All files have been found */
+        virtual void finished() = 0;
+
+    private:
+        // Not implemented..
+        FileSearch(const FileSearch &);
+        FileSearch &operator=(const FileSearch &);
+
+        const std::vector<std::string> &_paths;
+        const PathMatch _ignored;
+    };
+
+#ifdef THREADING_MODEL_FORK
+    /**
+     * @brief Writes the files that are found to a pipe that the parent
+     * process reads, see ThreadExecutor::readFoundFiles(). A file is the
+     * size, the length of the name and the name. The end is a length of
+     * ~0U.
+     */
+    class PipeSearch : public FileSearch
+    {
+    public:
+        PipeSearch(const std::vector<std::string> &paths, const std::vector<std::string> &ignoredPaths, int wpipe)
+            : FileSearch(paths, ignoredPaths), _wpipe(wpipe)
+        { }
+
+    protected:
+        virtual void found(const std::string &filename, unsigned long size)
+        {
+            std::string data;
+            const unsigned int len = filename.size();
+            data.append(reinterpret_cast<const char *>(&size), sizeof(size));
+            data.append(reinterpret_cast<const char *>(&len), sizeof(len));
+            data.append(filename);
+            writeAll(_wpipe, data.data(), data.size());
+        }
+
+        virtual void finished()
+        {
+            const unsigned long size = 0;
+            const unsigned int len = ~0U;
+            writeAll(_wpipe, &size, sizeof(size));
+            writeAll(_wpipe, &len, sizeof(len));
+        }
+
+    private:
+        const int _wpipe;
+    };
+#endif
+
+    void runSearch(void *search)
+    {
+        static_cast<FileSearch *>(search)->run();
+    }
+}
+
+#ifdef THREADING_MODEL_FORK
+namespace
+{
+    /**
+     * Waits until the pipes of the worker processes can be read. It uses
+     * epoll on Linux and poll() elsewhere, neither of them has the
+     * FD_SETSIZE limit of select() so -j can be large.
+     */
+    class PipePoller
+    {
+    public:
+        PipePoller()
+        {
+#ifdef __linux__
+            _epollfd = epoll_create(1);
+            if (_epollfd < 0)
+            {
+                perror("epoll_create");
+                exit(1);
+            }
+#endif
+        }
+
+        ~PipePoller()
+        {
+#ifdef __linux__
+            close(_epollfd);
+#endif
+        }
+
+        /** Wait for the pipe, id is returned by wait() when it can be read */
+        void add(int fd, unsigned int id)
+        {
+#ifdef __linux__
+            epoll_event event;
+            std::memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.u32 = id;
+            if (epoll_ctl(_epollfd, EPOLL_CTL_ADD, fd, &event) < 0)
+            {
+                perror("epoll_ctl");
+                exit(1);
+            }
+            _events.resize(_events.size() + 1);
+#else
+            pollfd p;
+            p.fd = fd;
+            p.events = POLLIN;
+            p.revents = 0;
+            _fds.push_back(p);
+            _ids.push_back(id);
+#endif
+        }
+
+        /** Stop waiting for the pipe, before it is closed */
+        void remove(int fd)
+        {
+#ifdef __linux__
+            epoll_event event;
+            std::memset(&event, 0, sizeof(event));
+            epoll_ctl(_epollfd, EPOLL_CTL_DEL, fd, &event);
+            _events.resize(_events.size() - 1);
+#else
+            for (std::size_t i = 0; i < _fds.size(); ++i)
+            {
+                if (_fds[i].fd == fd)
+                {
+                    _fds.erase(_fds.begin() + i);
+                    _ids.erase(_ids.begin() + i);
+                    break;
+                }
+            }
+#endif
+        }
+
+        bool empty() const
+        {
+#ifdef __linux__
+            return _events.empty();
+#else
+            return _fds.empty();
+#endif
+        }
+
+        /** Wait until pipes can be read, or have been closed. Their ids are put in ready. */
+        void wait(std::vector<unsigned int> &ready)
+        {
+            ready.clear();
+#ifdef __linux__
+            const int count = epoll_wait(_epollfd, &_events[0], (int)_events.size(), -1);
+            for (int i = 0; i < count; ++i)
+                ready.push_back(_events[i].data.u32);
+#else
+            if (poll(&_fds[0], _fds.size(), -1) <= 0)
+                return;
+            for (std::size_t i = 0; i < _fds.size(); ++i)
+            {
+                if (_fds[i].revents)
+                    ready.push_back(_ids[i]);
+            }
+#endif
+            // Handle the workers in the same order as with select()
+            std::sort(ready.begin(), ready.end());
+        }
+
+    private:
+        // Not implemented..
+        PipePoller(const PipePoller &);
+        PipePoller &operator=(const PipePoller &);
+
+#ifdef __linux__
+        int _epollfd;
+
+        /** One for each pipe that is waited for */
+        std::vector<epoll_event> _events;
+#else
+        std::vector<pollfd> _fds;
+        std::vector<unsigned int> _ids;
+#endif
+    };
+}
+
+int ThreadExecutor::handleRead(Child &child, unsigned int &result)
+{
+    // Read everything that is in the pipe, the child writes many
+    // messages at once
+    const std::size_t chunk = 65536;
+    int ret = 0;
+    while (true)
+    {
+        const std::size_t old = child.input.size();
+        child.input.resize(old + chunk);
+        const ssize_t bytes = read(child.rpipe, &child.input[old], chunk);
+        if (bytes <= 0)
+        {
+            child.input.resize(old);
+            if (bytes < 0 && errno == EINTR)
+                continue;
+            if (bytes < 0 && errno == EAGAIN)
+                return ret;
+
+            // The child has exited or crashed
+            return -1;
+        }
+        child.input.resize(old + (std::size_t)bytes);
+        if (ret == 0)
+            ret = 1;
+
+        // Handle the messages that have been read completely. They are
+        // parsed where they are in the buffer.
+        const std::size_t header = 1 + sizeof(unsigned int);
+        std::size_t pos = 0;
+        while (child.input.size() - pos >= header)
+        {
+            const char type = child.input[pos];
+            unsigned int len = 0;
+            std::memcpy(&len, child.input.data() + pos + 1, sizeof(len));
+            if (child.input.size() - pos - header < len)
+                break;
+
+            if (type != '1' && type != '2' && type != '3' && type != '4' && type != '5')
+            {
+                std::cerr << "#### You found a bug from cppcheck.\nThreadExecutor::handleRead error, type was:" << type << std::endl;
+                exit(0);
+            }
+
+            const char *data = child.input.data() + pos + header;
+            if (type == '5')
+            {
+                // The child keeps the code for the configurations
+                queueUnits(child.unit.file, std::string(data, len));
+                child.codeFile = child.unit.file;
+            }
+            else
+                bufferMessage(child.unit.file, child.unit.index, type, data, len, result);
+
+            if (type == '3')
+            {
+                child.busy = false;
+                ret = 2;
+            }
+            pos += header + len;
+        }
+
+        // Only an incomplete message is left, usually nothing
+        if (pos == child.input.size())
+            child.input.clear();
+        else
+            child.input.erase(0, pos);
     }
+}
+#endif
 
+void ThreadExecutor::handleMessage(char type, const char data[], std::size_t len)
+{
     if (type == '1')
     {
-        _errorLogger.reportOut(buf);
+        _errorLogger.reportOut(std::string(data, len));
     }
     else if (type == '2')
     {
         ErrorLogger::ErrorMessage msg;
-        msg.deserialize(buf);
+        if (!msg.deserialize(data, len))
+        {
+            std::cerr << "#### You found a bug from cppcheck.\nThreadExecutor::handleMessage error, invalid error message" << std::endl;
+            return;
+        }
 
         std::string file;
         unsigned int line(0);
@@ -106,186 +430,1071 @@ int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
         if (!_settings.nomsg.isSuppressed(msg._id, file, line))
         {
             // Alert only about unique errors
-            std::string errmsg = msg.toString(_settings._verbose);
-            if (std::find(_errorList.begin(), _errorList.end(), errmsg) == _errorList.end())
-            {
-                _errorList.push_back(errmsg);
+            if (_errorList.insert(msg, _settings._verbose))
                 _errorLogger.reportErr(msg);
-            }
         }
     }
-    else if (type == '3')
+    else if (type == '4')
+    {
+        _timerResults.deserialize(std::string(data, len));
+    }
+}
+
+void ThreadExecutor::bufferMessage(unsigned int file, unsigned int unit, char type, const char data[], std::size_t len, unsigned int &result)
+{
+    if (type == '3')
+    {
+        std::istringstream iss(std::string(data, len));
+        unsigned int unitResult = 0;
+        iss >> unitResult;
+        unitChecked(file, unitResult, result);
+        return;
+    }
+
+    // Nothing is reported before the first unit of the next file
+    Messages *messages = 0;
+    if (file == _nextOutput && unit == 0)
+    {
+        const std::map<unsigned int, Messages>::iterator it = _pending[file].find(0);
+        if (it != _pending[file].end() && !it->second.empty())
+            messages = &it->second;
+    }
+    else
     {
+        messages = &_pending[file][unit];
+    }
+
+    if (messages)
+        messages->push_back(std::make_pair(type, std::string(data, len)));
+    else
+        handleMessage(type, data, len);
+}
+
+void ThreadExecutor::addUnits(unsigned int file, unsigned int count)
+{
+    _unitsLeft[file] += count;
+}
+
+void ThreadExecutor::unitChecked(unsigned int file, unsigned int unitResult, unsigned int &result)
+{
+    if (unitResult > _fileResults[file])
+        _fileResults[file] = unitResult;
+    --_unitsLeft[file];
+
+    // Report the files in the order they were given
+    while (_nextOutput < _filenames.size() && _unitsLeft[_nextOutput] == 0)
+    {
+        std::map<unsigned int, Messages> &units = _pending[_nextOutput];
+        for (std::map<unsigned int, Messages>::const_iterator u = units.begin(); u != units.end(); ++u)
+        {
+            for (Messages::const_iterator it = u->second.begin(); it != u->second.end(); ++it)
+                handleMessage(it->first, it->second.data(), it->second.size());
+        }
+        units.clear();
+
         _fileCount++;
-        std::istringstream iss(buf);
-        unsigned int fileResult = 0;
-        iss >> fileResult;
-        result += fileResult;
-        _errorLogger.reportStatus(_fileCount, _filenames.size());
-        delete [] buf;
-        return -1;
+        result += _fileResults[_nextOutput];
+        _errorLogger.reportStatus(_fileCount, _searching ? 0 : _filenames.size());
+        ++_nextOutput;
     }
+}
+
+namespace
+{
+    /** Orders file indexes by decreasing cost, equal costs by index */
+    class LargerCost
+    {
+    public:
+        explicit LargerCost(const std::vector<unsigned long> &cost) : _cost(cost)
+        { }
 
-    delete [] buf;
-    return 1;
+        bool operator()(unsigned int a, unsigned int b) const
+        {
+            if (_cost[a] != _cost[b])
+                return _cost[a] > _cost[b];
+            return a < b;
+        }
+
+    private:
+        const std::vector<unsigned long> &_cost;
+    };
+}
+
+void ThreadExecutor::schedule()
+{
+    // The size of a file is used as the estimate of how long it takes
+    // to check it. The largest files are started first so that a big
+    // file does not start last and leave the other workers idle.
+    _cost.assign(_filenames.size(), 0);
+    for (unsigned int i = 0; i < _filenames.size(); ++i)
+    {
+        const std::map<std::string, std::string>::const_iterator content = _fileContents.find(_filenames[i]);
+        struct stat st;
+        if (content != _fileContents.end())
+            _cost[i] = content->second.size();
+        else if (stat(_filenames[i].c_str(), &st) == 0)
+            _cost[i] = st.st_size;
+    }
+
+    _schedule.resize(_filenames.size());
+    for (unsigned int i = 0; i < _schedule.size(); ++i)
+        _schedule[i] = i;
+    sortSchedule(0);
+}
+
+void ThreadExecutor::sortSchedule(unsigned int first)
+{
+    if (first < _schedule.size())
+        std::sort(_schedule.begin() + first, _schedule.end(), LargerCost(_cost));
+}
+
+void ThreadExecutor::addFile(const std::string &filename, unsigned long size)
+{
+    // The found files are checked in the order they are found, until
+    // the search has finished and the rest can be sorted
+    _schedule.push_back(_filenames.size());
+    _filenames.push_back(filename);
+    _cost.push_back(size);
+    _pending.push_back(std::map<unsigned int, Messages>());
+    _unitsLeft.push_back(1);
+    _fileResults.push_back(0);
 }
 
 unsigned int ThreadExecutor::check()
 {
+    _filenames.resize(_givenFiles);
     _fileCount = 0;
+    _nextOutput = 0;
+    _pending.assign(_filenames.size(), std::map<unsigned int, Messages>());
+    _unitsLeft.assign(_filenames.size(), 1);
+    _fileResults.assign(_filenames.size(), 0);
+    schedule();
+
+#ifdef THREADING_MODEL_FORK
+    _units.clear();
+    _preprocessed.clear();
+    if (_settings._executor == Settings::EXECUTOR_PROCESSES)
+        return checkProcesses();
+#endif
+
+    // Without fork() the files are always checked with threads
+    return checkThreads();
+}
+
+#ifdef THREADING_MODEL_FORK
+
+unsigned int ThreadExecutor::checkProcesses()
+{
     unsigned int result = 0;
 
-    std::list<int> rpipes;
-    std::map<pid_t, std::string> childFile;
-    unsigned int i = 0;
-    while (true)
+    // The parent writes to a worker that may have crashed
+    void (*oldSigpipe)(int) = signal(SIGPIPE, SIG_IGN);
+
+    _searching = !_searchPaths.empty();
+    if (_searching)
     {
-        // Start a new child
-        if (i < _filenames.size() && rpipes.size() < _settings._jobs)
+        if (pipe(_searchPipe) == -1)
         {
-            int pipes[2];
-            if (pipe(pipes) == -1)
-            {
-                perror("pipe");
-                exit(1);
-            }
+            perror("pipe");
+            exit(1);
+        }
+        const int flags = fcntl(_searchPipe[0], F_GETFL, 0);
+        if (flags < 0 || fcntl(_searchPipe[0], F_SETFL, flags | O_NONBLOCK) < 0)
+        {
+            perror("fcntl");
+            exit(1);
+        }
+        _searchInput.clear();
+    }
 
-            int flags = 0;
-            if ((flags = fcntl(pipes[0], F_GETFL, 0)) < 0)
-            {
-                perror("fcntl");
-                exit(1);
-            }
+    // There can be more workers than files, they check the configurations.
+    // They are forked before the search thread is started.
+    std::vector<Child> children;
+    const unsigned int workers = (_filenames.empty() && !_searching) ? 0 : _settings._jobs;
+    for (unsigned int i = 0; i < workers; ++i)
+    {
+        Child child;
+        startChild(child, children);
+        children.push_back(child);
+    }
+
+    PipePoller poller;
+    for (unsigned int i = 0; i < children.size(); ++i)
+        poller.add(children[i].rpipe, i);
 
-            if (fcntl(pipes[0], F_SETFL, flags | O_NONBLOCK) < 0)
+    // The files are checked while more are searched
+    PipeSearch search(_searchPaths, _ignoredPaths, _searchPipe[1]);
+    Thread searchThread;
+    if (_searching)
+    {
+        if (!searchThread.start(runSearch, &search))
+        {
+            std::cerr << "Failed to create thread" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        poller.add(_searchPipe[0], children.size());
+    }
+
+    unsigned int nextFile = 0;
+    dispatch(children, nextFile);
+
+    std::vector<unsigned int> ready;
+    while (!poller.empty())
+    {
+        poller.wait(ready);
+
+        for (std::vector<unsigned int>::const_iterator it = ready.begin(); it != ready.end(); ++it)
+        {
+            if (*it == children.size())
             {
-                perror("fcntl");
-                exit(1);
+                if (readFoundFiles())
+                    continue;
+
+                // The search has finished. The files that are not
+                // started yet are started in the order of their size.
+                searchThread.join();
+                poller.remove(_searchPipe[0]);
+                close(_searchPipe[0]);
+                close(_searchPipe[1]);
+                _searchPipe[0] = _searchPipe[1] = -1;
+                _searching = false;
+                sortSchedule(nextFile);
+
+                // The workers that died during the search are replaced now
+                // that the parent has no other threads
+                for (unsigned int i = 0; i < children.size(); ++i)
+                {
+                    if (children[i].rpipe < 0 && (nextFile < _filenames.size() || !_units.empty()))
+                    {
+                        startChild(children[i], children);
+                        poller.add(children[i].rpipe, i);
+                    }
+                }
+                continue;
             }
 
-            pid_t pid = fork();
-            if (pid < 0)
+            Child &child = children[*it];
+            if (handleRead(child, result) != -1)
+                continue;
+
+            poller.remove(child.rpipe);
+            close(child.rpipe);
+            child.rpipe = -1;
+            if (child.wpipe >= 0)
             {
-                // Error
-                std::cerr << "Failed to create child process" << std::endl;
-                exit(EXIT_FAILURE);
+                close(child.wpipe);
+                child.wpipe = -1;
             }
-            else if (pid == 0)
-            {
-                close(pipes[0]);
-                _wpipe = pipes[1];
 
-                CppCheck fileChecker(*this, false);
-                fileChecker.settings(_settings);
+            int stat = 0;
+            waitpid(child.pid, &stat, 0);
 
-                if (_fileContents.size() > 0 && _fileContents.find(_filenames[i]) != _fileContents.end())
+            if (WIFSIGNALED(stat) || child.busy)
+            {
+                std::ostringstream oss;
+                if (WIFSIGNALED(stat))
+                    oss << "Internal error: Child process crashed with signal " << WTERMSIG(stat);
+                else
+                    oss << "Internal error: Child process exited with status " << WEXITSTATUS(stat);
+
+                std::list<ErrorLogger::ErrorMessage::FileLocation> locations;
+                locations.push_back(ErrorLogger::ErrorMessage::FileLocation(child.busy ? _filenames[child.unit.file] : std::string(), 0));
+                const ErrorLogger::ErrorMessage errmsg(locations,
+                                                       Severity::error,
+                                                       oss.str(),
+                                                       "cppcheckError");
+                if (child.busy)
                 {
-                    // File content was given as a string
-                    fileChecker.addFile(_filenames[i], _fileContents[ _filenames[i] ]);
+                    // The unit will not send its result
+                    const std::string data(errmsg.serialize());
+                    bufferMessage(child.unit.file, child.unit.index, '2', data.data(), data.size(), result);
+                    unitChecked(child.unit.file, 0, result);
+                    child.busy = false;
                 }
                 else
                 {
-                    // Read file from a file
-                    fileChecker.addFile(_filenames[i]);
+                    _errorLogger.reportErr(errmsg);
                 }
+            }
+
+            // Replace a worker that died before all work was done. A
+            // process with threads must not fork, so while the search
+            // thread runs the worker is replaced when the search has
+            // finished. Its unit has already been reported as failed.
+            if (!_searching && (nextFile < _filenames.size() || !_units.empty()))
+            {
+                startChild(child, children);
+                poller.add(child.rpipe, *it);
+            }
+        }
+
+        dispatch(children, nextFile);
+    }
+
+    signal(SIGPIPE, oldSigpipe);
+
+    return result;
+}
+
+bool ThreadExecutor::readFoundFiles()
+{
+    bool more = true;
+    char buffer[65536];
+    ssize_t bytes;
+    while ((bytes = read(_searchPipe[0], buffer, sizeof(buffer))) > 0)
+        _searchInput.append(buffer, (std::size_t)bytes);
+
+    const std::size_t header = sizeof(unsigned long) + sizeof(unsigned int);
+    std::size_t pos = 0;
+    while (_searchInput.size() - pos >= header)
+    {
+        unsigned long size = 0;
+        unsigned int len = 0;
+        std::memcpy(&size, _searchInput.data() + pos, sizeof(size));
+        std::memcpy(&len, _searchInput.data() + pos + sizeof(size), sizeof(len));
+        if (len == ~0U)
+        {
+            more = false;
+            pos += header;
+            break;
+        }
+        if (_searchInput.size() - pos - header < len)
+            break;
+
+        addFile(_searchInput.substr(pos + header, len), size);
+        pos += header + len;
+    }
+    _searchInput.erase(0, pos);
+
+    return more;
+}
+
+void ThreadExecutor::startChild(Child &child, const std::vector<Child> &children)
+{
+    int resultPipes[2];
+    int unitPipes[2];
+    if (pipe(resultPipes) == -1 || pipe(unitPipes) == -1)
+    {
+        perror("pipe");
+        exit(1);
+    }
+
+    int flags = 0;
+    if ((flags = fcntl(resultPipes[0], F_GETFL, 0)) < 0)
+    {
+        perror("fcntl");
+        exit(1);
+    }
+
+    if (fcntl(resultPipes[0], F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+        perror("fcntl");
+        exit(1);
+    }
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        // Error
+        std::cerr << "Failed to create child process" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    else if (pid == 0)
+    {
+        // The child must not keep the pipes of the other workers open
+        for (std::vector<Child>::const_iterator c = children.begin(); c != children.end(); ++c)
+        {
+            if (c->rpipe >= 0)
+                close(c->rpipe);
+            if (c->wpipe >= 0)
+                close(c->wpipe);
+        }
+
+        if (_searchPipe[0] >= 0)
+        {
+            close(_searchPipe[0]);
+            close(_searchPipe[1]);
+        }
+
+        close(resultPipes[0]);
+        close(unitPipes[1]);
+        _wpipe = resultPipes[1];
+        runChild(unitPipes[0]);
+    }
+
+    close(resultPipes[1]);
+    close(unitPipes[0]);
+    child.pid = pid;
+    child.rpipe = resultPipes[0];
+    child.wpipe = unitPipes[1];
+    child.busy = false;
+    child.codeFile = ~0U;
+    child.input.clear();
+}
+
+void ThreadExecutor::runChild(int unitPipe)
+{
+    // Preprocessed code of the file whose configurations are checked. It
+    // is sent by the parent only when the configurations of another file
+    // are given to this worker.
+    std::string code;
 
-                unsigned int resultOfCheck = fileChecker.check();
+    unsigned int header[3];
+    while (readAll(unitPipe, header, sizeof(header)))
+    {
+        const unsigned int index = header[0];
+        const bool interrupted = header[1] != 0;
+        const bool newCode = header[2] != 0;
+
+        // The file may have been found after the worker was forked
+        std::string filename;
+        if (!readString(unitPipe, filename))
+            break;
+
+        CppCheck fileChecker(*this, false);
+        fileChecker.settings(_settings);
+
+        unsigned int resultOfCheck = 0;
+        if (index == 0)
+        {
+            fileChecker.splitConfigurations(true);
+
+            if (_fileContents.size() > 0 && _fileContents.find(filename) != _fileContents.end())
+            {
+                // File content was given as a string
+                fileChecker.addFile(filename, _fileContents[ filename ]);
+            }
+            else
+            {
+                // Read file from a file
+                fileChecker.addFile(filename);
+            }
+
+            resultOfCheck = fileChecker.check();
+
+            // The remaining configurations are checked by any worker
+            const std::list<std::string> &configurations = fileChecker.remainingConfigurations();
+            if (!configurations.empty())
+            {
                 std::ostringstream oss;
-                oss << resultOfCheck;
-                writeToPipe('3', oss.str());
-                exit(0);
+                oss << configurations.size() << ' ' << (fileChecker.tooManyConfigurations() ? 1 : 0);
+                for (std::list<std::string>::const_iterator it = configurations.begin(); it != configurations.end(); ++it)
+                    oss << ' ' << it->size() << ' ' << *it;
+                code = fileChecker.preprocessedCode();
+                oss << ' ' << code;
+                writeToPipe('5', oss.str());
             }
+        }
+        else
+        {
+            std::string configuration;
+            if (!readString(unitPipe, configuration) || (newCode && !readString(unitPipe, code)))
+                break;
+            resultOfCheck = fileChecker.checkConfiguration(filename, code, configuration, interrupted);
+        }
+
+        if (_settings._showtime != SHOWTIME_NONE)
+            writeToPipe('4', fileChecker.timerResults().serialize());
+
+        std::ostringstream oss;
+        oss << resultOfCheck;
+        writeToPipe('3', oss.str());
+    }
+
+    // The parent has closed the pipe, there is no more work
+    exit(0);
+}
+
+void ThreadExecutor::queueUnits(unsigned int file, const std::string &data)
+{
+    std::istringstream iss(data);
+    unsigned int count = 0, interrupted = 0;
+    iss >> count >> interrupted;
+
+    for (unsigned int i = 1; i <= count; ++i)
+    {
+        std::string::size_type len = 0;
+        iss >> len;
+        iss.get();
+        Unit unit;
+        unit.file = file;
+        unit.index = i;
+        unit.configuration.resize(len);
+        if (len > 0)
+            iss.read(&unit.configuration[0], len);
+        unit.interrupted = (i == count && interrupted);
+        _units.push_back(unit);
+    }
 
-            close(pipes[1]);
-            rpipes.push_back(pipes[0]);
-            childFile[pid] = _filenames[i];
+    // The rest is the preprocessed code
+    iss.get();
+    const std::string::size_type codeStart = iss.tellg();
+    _preprocessed[file] = data.substr(std::min(codeStart, data.size()));
 
-            ++i;
+    addUnits(file, count);
+}
+
+bool ThreadExecutor::sendUnit(Child &child, const Unit &unit)
+{
+    // The preprocessed code is sent once to each worker that checks
+    // configurations of the file, the worker that preprocessed it has it
+    const bool sendCode = unit.index > 0 && child.codeFile != unit.file;
+    const unsigned int header[3] = { unit.index, unit.interrupted ? 1U : 0U, sendCode ? 1U : 0U };
+    bool written = writeAll(child.wpipe, header, sizeof(header)) && writeString(child.wpipe, _filenames[unit.file]);
+    if (written && unit.index > 0)
+        written = writeString(child.wpipe, unit.configuration) && (!sendCode || writeString(child.wpipe, _preprocessed[unit.file]));
+
+    if (!written)
+    {
+        // The worker has died, the unit is given to its replacement
+        close(child.wpipe);
+        child.wpipe = -1;
+        return false;
+    }
+
+    if (sendCode)
+        child.codeFile = unit.file;
+    child.unit = unit;
+    child.busy = true;
+    return true;
+}
+
+void ThreadExecutor::dispatch(std::vector<Child> &children, unsigned int &nextFile)
+{
+    // A worker that checks the first configuration of a file may find
+    // more configurations to check
+    bool checkingFile = false;
+    for (std::vector<Child>::const_iterator c = children.begin(); c != children.end(); ++c)
+    {
+        if (c->busy && c->unit.index == 0)
+            checkingFile = true;
+    }
+
+    for (std::vector<Child>::iterator child = children.begin(); child != children.end(); ++child)
+    {
+        if (child->wpipe < 0 || child->busy)
+            continue;
+
+        if (!_units.empty())
+        {
+            // The configurations of started files go first
+            const Unit unit = _units.front();
+            if (sendUnit(*child, unit))
+            {
+                _units.pop_front();
+                if (_units.empty() || _units.front().file != unit.file)
+                    _preprocessed.erase(unit.file);
+            }
+        }
+        else if (nextFile < _filenames.size())
+        {
+            Unit unit;
+            unit.file = _schedule[nextFile];
+            unit.index = 0;
+            unit.interrupted = false;
+            if (sendUnit(*child, unit))
+            {
+                ++nextFile;
+                checkingFile = true;
+            }
+        }
+        else if (!checkingFile && !_searching)
+        {
+            // The worker exits when its pipe is closed
+            close(child->wpipe);
+            child->wpipe = -1;
+        }
+    }
+}
+#endif
+
+namespace
+{
+    /** @brief A message of a worker thread about a unit */
+    struct Message
+    {
+        unsigned int file;
+        unsigned int unit;
+        char type;
+        std::string data;
+    };
+
+    /**
+     * @brief The messages of the worker threads.
+     *
+     * The workers push their messages and the thread that reports them
+     * takes all of the queued messages at once.
+     */
+    class MessageQueue
+    {
+    public:
+        MessageQueue()
+        { }
+
+        void push(unsigned int file, unsigned int unit, char type, const std::string &data)
+        {
+            Message message;
+            message.file = file;
+            message.unit = unit;
+            message.type = type;
+            message.data = data;
+
+            MutexLock lock(_mutex);
+            _messages.push_back(message);
+            _cond.signal();
         }
-        else if (!rpipes.empty())
+
+        /** Wait until there are messages and take all of them */
+        void take(std::list<Message> &messages)
         {
-            fd_set rfds;
-            FD_ZERO(&rfds);
-            for (std::list<int>::const_iterator rp = rpipes.begin(); rp != rpipes.end(); ++rp)
-                FD_SET(*rp, &rfds);
+            MutexLock lock(_mutex);
+            while (_messages.empty())
+                _cond.wait(_mutex);
+            messages.swap(_messages);
+        }
+
+    private:
+        // Not implemented..
+        MessageQueue(const MessageQueue &);
+        MessageQueue &operator=(const MessageQueue &);
+
+        Mutex _mutex;
+        ConditionVariable _cond;
+        std::list<Message> _messages;
+    };
+
+    /** @brief A unit of work of a worker thread */
+    struct Work
+    {
+        /** Index of the file */
+        unsigned int file;
+
+        /** 0 for the file, 1.. for its remaining configurations */
+        unsigned int index;
+
+        std::string configuration;
 
-            int r = select(*std::max_element(rpipes.begin(), rpipes.end()) + 1, &rfds, NULL, NULL, NULL);
+        /** Report that the file had too many configurations after this one */
+        bool interrupted;
 
-            if (r > 0)
+        /** Preprocessed code of the file, for the remaining configurations */
+        const std::string *code;
+
+        /** Name of the file, the reporting thread may be adding files */
+        std::string filename;
+    };
+
+    /**
+     * @brief The work of the worker threads: the files, and the remaining
+     * configurations of the files whose first configuration is checked.
+     * The configurations of a file share its preprocessed code.
+     */
+    class WorkQueue
+    {
+    public:
+        /**
+         * @param schedule indexes of the files in the order they are checked
+         * @param filenames names of the files
+         * @param cost sizes of the files
+         * @param searching are more files being searched?
+         */
+        WorkQueue(const std::vector<unsigned int> &schedule,
+                  const std::vector<std::string> &filenames,
+                  const std::vector<unsigned long> &cost,
+                  bool searching)
+            : _nextFile(0), _checkingFiles(0), _searching(searching)
+        {
+            for (std::vector<unsigned int>::const_iterator it = schedule.begin(); it != schedule.end(); ++it)
+                _files.push_back(File(*it, filenames[*it], cost[*it]));
+        }
+
+        /**
+         * Wait for the next unit of work
+         * @return false if all work is done
+         */
+        bool next(Work &work)
+        {
+            MutexLock lock(_mutex);
+            bool more = true;
+            while (true)
             {
-                std::list<int>::iterator rp = rpipes.begin();
-                while (rp != rpipes.end())
+                if (!_work.empty())
                 {
-                    if (FD_ISSET(*rp, &rfds))
-                    {
-                        int readRes = handleRead(*rp, result);
-                        if (readRes == -1)
-                        {
-                            close(*rp);
-                            rp = rpipes.erase(rp);
-                        }
-                        else
-                            ++rp;
-                    }
-                    else
-                        ++rp;
+                    // The configurations of started files go first
+                    work = _work.front();
+                    _work.pop_front();
+                    break;
+                }
+                if (_nextFile < _files.size())
+                {
+                    const File &file = _files[_nextFile++];
+                    work.file = file.index;
+                    work.index = 0;
+                    work.configuration.clear();
+                    work.interrupted = false;
+                    work.code = 0;
+                    work.filename = file.name;
+                    ++_checkingFiles;
+                    break;
+                }
+                if (_checkingFiles == 0 && !_searching)
+                {
+                    // No more configurations can be found
+                    more = false;
+                    break;
                 }
+                _cond.wait(_mutex);
             }
+            return more;
+        }
 
-            int stat = 0;
-            pid_t child = waitpid(0, &stat, WNOHANG);
-            if (child > 0)
+        /** A file has been found, it is checked after the files that are queued */
+        void addFile(unsigned int index, const std::string &filename, unsigned long cost)
+        {
+            MutexLock lock(_mutex);
+            _files.push_back(File(index, filename, cost));
+            _cond.signal();
+        }
+
+        /** All files have been found, the files that are not started are sorted by size */
+        void searchFinished()
+        {
+            MutexLock lock(_mutex);
+            _searching = false;
+            std::sort(_files.begin() + _nextFile, _files.end());
+            _cond.broadcast();
+        }
+
+        /** The first configuration of a file is checked, queue the remaining ones */
+        void fileChecked(const Work &checked, const CppCheck &checker)
+        {
+            const unsigned int file = checked.file;
+            MutexLock lock(_mutex);
+            --_checkingFiles;
+            const std::list<std::string> &remaining = checker.remainingConfigurations();
+            if (!remaining.empty())
             {
-                std::string childname;
-                std::map<pid_t, std::string>::iterator c = childFile.find(child);
-                if (c != childFile.end())
+                Code &code = _code[file];
+                code.data = checker.preprocessedCode();
+                code.left = remaining.size();
+
+                unsigned int index = 0;
+                for (std::list<std::string>::const_iterator it = remaining.begin(); it != remaining.end(); ++it)
                 {
-                    childname = c->second;
-                    childFile.erase(c);
+                    Work work;
+                    work.file = file;
+                    work.index = ++index;
+                    work.configuration = *it;
+                    work.interrupted = checker.tooManyConfigurations() && index == remaining.size();
+                    work.code = &code.data;
+                    work.filename = checked.filename;
+                    _work.push_back(work);
                 }
+            }
+            _cond.broadcast();
+        }
 
-                if (WIFSIGNALED(stat))
+        /** A remaining configuration of a file is checked */
+        void configurationChecked(unsigned int file)
+        {
+            MutexLock lock(_mutex);
+            if (--_code[file].left == 0)
+                _code.erase(file);
+        }
+
+    private:
+        // Not implemented..
+        WorkQueue(const WorkQueue &);
+        WorkQueue &operator=(const WorkQueue &);
+
+        Mutex _mutex;
+        ConditionVariable _cond;
+
+        unsigned int _nextFile;
+
+        /** @brief A file to check, the files are sorted by decreasing size */
+        struct File
+        {
+            File(unsigned int i, const std::string &filename, unsigned long size)
+                : index(i), name(filename), cost(size)
+            { }
+
+            bool operator<(const File &other) const
+            {
+                if (cost != other.cost)
+                    return cost > other.cost;
+                return index < other.index;
+            }
+
+            unsigned int index;
+            std::string name;
+            unsigned long cost;
+        };
+
+        /** The files in the order they are checked */
+        std::vector<File> _files;
+
+        /** Number of files whose first configuration is being checked */
+        unsigned int _checkingFiles;
+
+        /** Are more files being searched? */
+        bool _searching;
+
+        /** Preprocessed code of a file, and how many of its configurations are not checked */
+        struct Code
+        {
+            std::string data;
+            unsigned int left;
+        };
+        std::map<unsigned int, Code> _code;
+
+        std::list<Work> _work;
+    };
+
+    /**
+     * @brief A worker thread. It checks files and configurations with its
+     * own CppCheck instance until there is no more work.
+     */
+    class Worker : public ErrorLogger
+    {
+    public:
+        Worker(WorkQueue &work,
+               MessageQueue &messages,
+               const std::map<std::string, std::string> &fileContents,
+               const Settings &settings)
+            : _work(work), _messages(messages), _fileContents(fileContents),
+              _checker(*this, false), _file(0), _index(0)
+        {
+            _checker.settings(settings);
+            _checker.splitConfigurations(true);
+        }
+
+        void run()
+        {
+            Work work;
+            while (_work.next(work))
+            {
+                _file = work.file;
+                _index = work.index;
+
+                unsigned int result = 0;
+                if (work.index == 0)
                 {
-                    std::ostringstream oss;
-                    oss << "Internal error: Child process crashed with signal " << WTERMSIG(stat);
+                    _checker.clearFiles();
 
-                    std::list<ErrorLogger::ErrorMessage::FileLocation> locations;
-                    locations.push_back(ErrorLogger::ErrorMessage::FileLocation(childname, 0));
-                    const ErrorLogger::ErrorMessage errmsg(locations,
-                                                           Severity::error,
-                                                           oss.str(),
-                                                           "cppcheckError");
-                    _errorLogger.reportErr(errmsg);
+                    const std::map<std::string, std::string>::const_iterator content = _fileContents.find(work.filename);
+                    if (content != _fileContents.end())
+                    {
+                        // File content was given as a string
+                        _checker.addFile(work.filename, content->second);
+                    }
+                    else
+                    {
+                        // Read file from a file
+                        _checker.addFile(work.filename);
+                    }
+
+                    result = _checker.check();
+
+                    // The reporting thread must know about the configurations
+                    // before any of them is checked
+                    const unsigned int configurations = _checker.remainingConfigurations().size();
+                    if (configurations > 0)
+                    {
+                        std::ostringstream oss;
+                        oss << configurations;
+                        _messages.push(_file, _index, '5', oss.str());
+                    }
+                    _work.fileChecked(work, _checker);
+                }
+                else
+                {
+                    result = _checker.checkConfiguration(work.filename, *work.code, work.configuration, work.interrupted);
+                    _work.configurationChecked(_file);
                 }
+
+                std::ostringstream oss;
+                oss << result;
+                _messages.push(_file, _index, '3', oss.str());
             }
         }
-        else
+
+        const TimerResults &timerResults() const
         {
-            // All done
-            break;
+            return _checker.timerResults();
         }
+
+        virtual void reportOut(const std::string &outmsg)
+        {
+            _messages.push(_file, _index, '1', outmsg);
+        }
+
+        virtual void reportErr(const ErrorLogger::ErrorMessage &msg)
+        {
+            _messages.push(_file, _index, '2', msg.serialize());
+        }
+
+        virtual void reportStatus(unsigned int /*index*/, unsigned int /*max*/)
+        {
+            // Not used
+        }
+
+        Thread thread;
+
+    private:
+        // Not implemented..
+        Worker(const Worker &);
+        Worker &operator=(const Worker &);
+
+        WorkQueue &_work;
+        MessageQueue &_messages;
+        const std::map<std::string, std::string> &_fileContents;
+        CppCheck _checker;
+
+        /** The unit that is checked */
+        unsigned int _file;
+        unsigned int _index;
+    };
+}
+
+namespace
+{
+    /**
+     * @brief Gives the files that are found to the worker threads, and
+     * tells the reporting thread about them first
+     */
+    class QueueSearch : public FileSearch
+    {
+    public:
+        QueueSearch(const std::vector<std::string> &paths,
+                    const std::vector<std::string> &ignoredPaths,
+                    WorkQueue &work,
+                    MessageQueue &messages,
+                    unsigned int firstIndex)
+            : FileSearch(paths, ignoredPaths), _work(work), _messages(messages), _index(firstIndex)
+        { }
+
+    protected:
+        virtual void found(const std::string &filename, unsigned long size)
+        {
+            std::ostringstream oss;
+            oss << size << ' ' << filename;
+            _messages.push(_index, 0, 'f', oss.str());
+            _work.addFile(_index, filename, size);
+            ++_index;
+        }
+
+        virtual void finished()
+        {
+            _messages.push(0, 0, 'e', "");
+            _work.searchFinished();
+        }
+
+    private:
+        WorkQueue &_work;
+        MessageQueue &_messages;
+
+        /** Index of the next file that is found */
+        unsigned int _index;
+    };
+
+    void runWorker(void *worker)
+    {
+        static_cast<Worker *>(worker)->run();
+    }
+}
+
+unsigned int ThreadExecutor::checkThreads()
+{
+    unsigned int result = 0;
+
+    _searching = !_searchPaths.empty();
+    WorkQueue work(_schedule, _filenames, _cost, _searching);
+    MessageQueue messageQueue;
+    std::vector<Worker *> workers;
+    const unsigned int threads = (_filenames.empty() && !_searching) ? 0 : _settings._jobs;
+    for (unsigned int i = 0; i < threads; ++i)
+    {
+        Worker *worker = new Worker(work, messageQueue, _fileContents, _settings);
+        if (!worker->thread.start(runWorker, worker))
+        {
+            std::cerr << "Failed to create thread" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        workers.push_back(worker);
+    }
+
+    // The files are checked while more are searched
+    QueueSearch search(_searchPaths, _ignoredPaths, work, messageQueue, _filenames.size());
+    Thread searchThread;
+    if (_searching && !searchThread.start(runSearch, &search))
+    {
+        std::cerr << "Failed to create thread" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // The messages are reported in this thread. A unit is done when the
+    // worker has pushed its result, its messages were pushed before it.
+    // A file that is found is pushed before it can be checked.
+    std::list<Message> messages;
+    const bool searched = _searching;
+    while (_nextOutput < _filenames.size() || _searching)
+    {
+        messageQueue.take(messages);
+        for (std::list<Message>::const_iterator it = messages.begin(); it != messages.end(); ++it)
+        {
+            if (it->type == 'f')
+            {
+                std::istringstream iss(it->data);
+                unsigned long size = 0;
+                iss >> size;
+                addFile(it->data.substr((std::size_t)iss.tellg() + 1), size);
+            }
+            else if (it->type == 'e')
+                _searching = false;
+            else if (it->type == '5')
+                addUnits(it->file, std::atoi(it->data.c_str()));
+            else
+                bufferMessage(it->file, it->unit, it->type, it->data.data(), it->data.size(), result);
+        }
+        messages.clear();
     }
 
+    if (searched)
+        searchThread.join();
+
+    for (unsigned int i = 0; i < workers.size(); ++i)
+    {
+        workers[i]->thread.join();
+        if (_settings._showtime != SHOWTIME_NONE)
+            _timerResults.Merge(workers[i]->timerResults());
+        delete workers[i];
+    }
 
     return result;
 }
 
+#ifdef THREADING_MODEL_FORK
 void ThreadExecutor::writeToPipe(char type, const std::string &data)
 {
-    unsigned int len = data.length() + 1;
-    char *out = new char[ len + 1 + sizeof(len)];
-    out[0] = type;
-    std::memcpy(&(out[1]), &len, sizeof(len));
-    std::memcpy(&(out[1+sizeof(len)]), data.c_str(), len);
-    if (write(_wpipe, out, len + 1 + sizeof(len)) <= 0)
+    const unsigned int len = data.length();
+    _writeBuffer.append(1, type);
+    _writeBuffer.append(reinterpret_cast<const char *>(&len), sizeof(len));
+    _writeBuffer.append(data);
+
+    // The parent waits for the result of the unit
+    if (type == '3' || _writeBuffer.size() >= 65536)
+        flushPipe();
+}
+
+void ThreadExecutor::flushPipe()
+{
+    if (!writeAll(_wpipe, _writeBuffer.data(), _writeBuffer.size()))
     {
-        delete [] out;
-        out = 0;
         std::cerr << "#### ThreadExecutor::writeToPipe, Failed to write to pipe" << std::endl;
         exit(0);
     }
-
-    delete [] out;
+    _writeBuffer.clear();
 }
 
 void ThreadExecutor::reportOut(const std::string &outmsg)
@@ -304,15 +1513,11 @@ void ThreadExecutor::reportStatus(unsigned int /*index*/, unsigned int /*max*/)
 }
 
 #else
-unsigned int ThreadExecutor::check()
-{
-    return 0;
-}
-
 void ThreadExecutor::reportOut(const std::string &/*outmsg*/)
 {
 
 }
+
 void ThreadExecutor::reportErr(const ErrorLogger::ErrorMessage &/*msg*/)
 {
 
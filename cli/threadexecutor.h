@@ -24,9 +24,11 @@
 #include <list>
 #include "settings.h"
 #include "errorlogger.h"
+#include "timer.h"
 
 #if (defined(__GNUC__) || defined(__sun)) && !defined(__MINGW32__)
 #define THREADING_MODEL_FORK
+#include <sys/types.h>
 #endif
 
 /// @addtogroup CLI
@@ -34,7 +36,8 @@
 
 /**
  * This class will take a list of filenames and settings and check then
- * all files using threads.
+ * all files using child processes or worker threads, see
+ * Settings::_executor.
  */
 class ThreadExecutor : public ErrorLogger
 {
@@ -54,49 +57,281 @@ public:
      */
     void addFileContent(const std::string &path, const std::string &content);
 
+    /**
+     * @brief Search for more files to check while the files that have
+     * been found are checked.
+     *
+     * The files are searched with the FileLister in another thread. They
+     * are checked after the files that were given to the constructor and
+     * their messages are reported in the order that they are found.
+     * @param paths the paths to search
+     * @param ignoredPaths the paths that are ignored, see PathMatch
+     */
+    void searchFiles(const std::vector<std::string> &paths, const std::vector<std::string> &ignoredPaths);
+
+    /** @brief The files that are checked, the given files and the found files */
+    const std::vector<std::string> &filenames() const
+    {
+        return _filenames;
+    }
+
+    /**
+     * @brief Results of the timers of all the child processes or worker
+     * threads, when --showtime is used
+     */
+    const TimerResults &timerResults() const
+    {
+        return _timerResults;
+    }
+
 private:
-    const std::vector<std::string> &_filenames;
+    std::vector<std::string> _filenames;
+
+    /** @brief Number of files that were given, the rest have been found */
+    const std::size_t _givenFiles;
+
     Settings &_settings;
     ErrorLogger &_errorLogger;
     unsigned int _fileCount;
 
+    /** @brief See searchFiles() */
+    std::vector<std::string> _searchPaths;
+    std::vector<std::string> _ignoredPaths;
+
+    /** @brief The timer results of the child processes and threads are merged here */
+    TimerResults _timerResults;
+
     /** @brief Key is file name, and value is the content of the file */
     std::map<std::string, std::string> _fileContents;
 
+    /** @brief Messages of a unit, type and data */
+    typedef std::list<std::pair<char, std::string> > Messages;
+
+    /**
+     * @brief Keep a message until the messages of the files before it
+     * have been reported.
+     *
+     * The files are not checked in the order they were given, but their
+     * messages are reported in that order, and the messages of a file in
+     * the order of its configurations, so that the output does not
+     * depend on the scheduling.
+     * @param file index of the file that the message is about
+     * @param unit index of the unit of the file
+     * @param type type of the message, see handleMessage(). '3' is the
+     * result of the unit.
+     * @param data the message
+     * @param len length of the message
+     * @param result the results of the files are added to this
+     */
+    void bufferMessage(unsigned int file, unsigned int unit, char type, const char data[], std::size_t len, unsigned int &result);
+
+    /**
+     * @brief A unit of a file has been checked. When all units of the
+     * file are checked, the files that are next in order are reported.
+     */
+    void unitChecked(unsigned int file, unsigned int unitResult, unsigned int &result);
+
+    /** @brief The first unit of a file found more configurations to check */
+    void addUnits(unsigned int file, unsigned int count);
+
+    /** @brief Messages of the units of the files that can not be reported yet */
+    std::vector<std::map<unsigned int, Messages> > _pending;
+
+    /** @brief Number of units of each file that are not checked yet */
+    std::vector<unsigned int> _unitsLeft;
+
+    /** @brief Result of each file, it has errors if any of its units has */
+    std::vector<unsigned int> _fileResults;
+
+    /** @brief Index of the next file to report */
+    unsigned int _nextOutput;
+
+    /**
+     * @brief Indexes of the files in the order they are checked, the
+     * largest files first. See schedule().
+     */
+    std::vector<unsigned int> _schedule;
+
+    /** @brief Order the files by their size, the largest first */
+    void schedule();
+
+    /** @brief Order the files from _schedule[first] by their size, the largest first */
+    void sortSchedule(unsigned int first);
+
+    /** @brief Size of each file, it is an estimate of how long it takes to check it */
+    std::vector<unsigned long> _cost;
+
+    /** @brief A file has been found, see searchFiles() */
+    void addFile(const std::string &filename, unsigned long size);
+
+    /**
+     * @brief Are files being searched? Then the number of files is not
+     * known yet, and the status is reported without it.
+     */
+    bool _searching;
+
+    /**
+     * @brief Handle a message from a child process or a worker thread
+     * @param type '1' output, '2' error message, '4' timer results
+     * @param data the message
+     * @param len length of the message
+     */
+    void handleMessage(char type, const char data[], std::size_t len);
+
+    /** @brief Check the files with a pool of worker threads */
+    unsigned int checkThreads();
+
+    /** @brief The messages that have been reported, in all files */
+    ErrorMessageSet _errorList;
+
 #ifdef THREADING_MODEL_FORK
-private:
+    // The worker processes, see checkProcesses(). Without fork() the
+    // files are checked with worker threads.
+
+    /**
+     * @brief A unit of work for a worker: a file, or one of the
+     * remaining configurations of a file whose first configuration has
+     * been checked. See CppCheck::splitConfigurations().
+     */
+    struct Unit
+    {
+        /** Index of the file */
+        unsigned int file;
+
+        /** 0 for the file, 1.. for its remaining configurations */
+        unsigned int index;
+
+        std::string configuration;
+
+        /** Report that the file had too many configurations after this one */
+        bool interrupted;
+    };
+
     /**
-     * Read from the pipe, parse and handle what ever is in there.
-     *@return -1 in case of error
+     * @brief A worker process. It is forked once and checks the units
+     * that the parent sends to it, one at a time.
+     */
+    struct Child
+    {
+        pid_t pid;
+
+        /** Read end of the pipe for the messages of the child */
+        int rpipe;
+
+        /** Write end of the pipe for the units, -1 when closed */
+        int wpipe;
+
+        /** The unit that the child is checking */
+        Unit unit;
+
+        /** Is the child checking a unit? */
+        bool busy;
+
+        /**
+         * Index of the file whose preprocessed code the child has, ~0U
+         * if none. The code is sent to each child once, see sendUnit().
+         */
+        unsigned int codeFile;
+
+        /** Data that is read from the pipe but is not a whole message yet */
+        std::string input;
+    };
+
+    /**
+     * Read everything that is in the pipe of a child, and handle the
+     * messages that have been read completely.
+     *@return -1 in case of error or if the child has closed the pipe
      *         0 if there is nothing in the pipe to be read
      *         1 if we did read something
+     *         2 if the child has checked its unit, it is not busy anymore
+     */
+    int handleRead(Child &child, unsigned int &result);
+
+    /** @brief Check the files with worker processes */
+    unsigned int checkProcesses();
+
+    /**
+     * @brief Read the files that the search thread has found
+     * @return false when the search has finished
+     */
+    bool readFoundFiles();
+
+    /** @brief The pipe of the search thread, -1 when there is no search */
+    int _searchPipe[2];
+
+    /** @brief Data that is read from _searchPipe but is not a whole file yet */
+    std::string _searchInput;
+
+    /**
+     * @brief Fork a worker process
+     * @param child the new worker
+     * @param children the other workers, their pipes are closed in the child
+     */
+    void startChild(Child &child, const std::vector<Child> &children);
+
+    /**
+     * @brief The loop of a worker process. It checks the units that are
+     * read from the pipe until the parent closes it, and then exits.
+     */
+    void runChild(int unitPipe);
+
+    /**
+     * @brief Give work to the idle workers, and close the pipes of the
+     * idle workers when there is no more work and no more files can be
+     * found.
+     */
+    void dispatch(std::vector<Child> &children, unsigned int &nextFile);
+
+    /**
+     * @brief Send a unit to a worker
+     * @return false if the worker has died
+     */
+    bool sendUnit(Child &child, const Unit &unit);
+
+    /**
+     * @brief Queue the remaining configurations of a file that a worker
+     * has sent, for the worker processes
+     */
+    void queueUnits(unsigned int file, const std::string &data);
+
+    /** @brief Remaining configurations that are not given to a worker process yet */
+    std::list<Unit> _units;
+
+    /** @brief Preprocessed code of the files that have units in _units */
+    std::map<unsigned int, std::string> _preprocessed;
+
+    /**
+     * @brief Add a message to the messages that the child writes to the
+     * parent. The messages are written when the child has checked its
+     * unit, or when there are many of them.
+     *
+     * A message is the type (one char), the length of the data
+     * (unsigned int) and the data.
      */
-    int handleRead(int rpipe, unsigned int &result);
     void writeToPipe(char type, const std::string &data);
+
+    /** @brief Write the messages of writeToPipe() */
+    void flushPipe();
+
+    /** @brief Messages that the child has not written yet */
+    std::string _writeBuffer;
+
     /**
      * Write end of status pipe, different for each child.
      * Not used in master process.
      */
     int _wpipe;
-    std::list<std::string> _errorList;
+#endif
+
 public:
     /**
-     * @return true if support for threads exist.
+     * @return true if support for threads exist. The worker threads
+     * are available on all platforms, see threading.h.
      */
     static bool isEnabled()
     {
         return true;
     }
-#else
-public:
-    /**
-     * @return true if support for threads exist.
-     */
-    static bool isEnabled()
-    {
-        return false;
-    }
-#endif
 
 private:
     /** disabled copy constructor */
@@ -53,7 +53,10 @@ public:
 #endif
     }
 
-    /** List of registered check classes. This is used by Cppcheck to run checks and generate documentation */
+    /**
+     * List of registered check classes. This is used by Cppcheck to run checks and generate documentation.
+     * The list is only changed before main() and after it, so several threads can read it at the same time.
+     */
     static std::list<Check *> &instances()
     {
         static std::list<Check *> _instances;
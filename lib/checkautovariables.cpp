@@ -170,9 +170,9 @@ void CheckAutoVariables::autoVariables()
         for (tok = scope->classDef->next()->link(); tok; tok = tok->next())
         {
             // indentlevel..
-            if (tok->str() == "{")
+            if (tok->kind() == Token::eOpenBrace)
                 ++indentlevel;
-            else if (tok->str() == "}")
+            else if (tok->kind() == Token::eCloseBrace)
             {
                 if (indentlevel <= 1)
                     break;
@@ -269,9 +269,9 @@ void CheckAutoVariables::returnPointerToLocalArray()
             for (; tok2; tok2 = tok2->next())
             {
                 // indentlevel..
-                if (tok2->str() == "{")
+                if (tok2->kind() == Token::eOpenBrace)
                     ++indentlevel;
-                else if (tok2->str() == "}")
+                else if (tok2->kind() == Token::eCloseBrace)
                 {
                     if (indentlevel <= 1)
                         break;
@@ -355,9 +355,9 @@ void CheckAutoVariables::returnReference()
             for (; tok2; tok2 = tok2->next())
             {
                 // indentlevel..
-                if (tok2->str() == "{")
+                if (tok2->kind() == Token::eOpenBrace)
                     ++indentlevel;
-                else if (tok2->str() == "}")
+                else if (tok2->kind() == Token::eCloseBrace)
                 {
                     if (indentlevel <= 1)
                         break;
@@ -436,9 +436,9 @@ void CheckAutoVariables::returncstr()
             for (; tok2; tok2 = tok2->next())
             {
                 // indentlevel..
-                if (tok2->str() == "{")
+                if (tok2->kind() == Token::eOpenBrace)
                     ++indentlevel;
-                else if (tok2->str() == "}")
+                else if (tok2->kind() == Token::eCloseBrace)
                 {
                     if (indentlevel <= 1)
                         break;
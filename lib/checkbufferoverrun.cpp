@@ -205,9 +205,9 @@ static bool bailoutIfSwitch(const Token *tok, const unsigned int varid)
     unsigned int indentlevel = 0;
     for (; tok; tok = tok->next())
     {
-        if (tok->str() == "{")
+        if (tok->kind() == Token::eOpenBrace)
             indentlevel++;
-        else if (tok->str() == "}")
+        else if (tok->kind() == Token::eCloseBrace)
         {
             // scan the else-block
             if (indentlevel == 1 && Token::simpleMatch(tok, "} else {"))
@@ -454,10 +454,10 @@ void CheckBufferOverrun::parse_for_body(const Token *tok2, const ArrayInfo &arra
         if (tok2->str() == ";" && indentlevel2 == 0)
             break;
 
-        if (tok2->str() == "{")
+        if (tok2->kind() == Token::eOpenBrace)
             ++indentlevel2;
 
-        if (tok2->str() == "}")
+        if (tok2->kind() == Token::eCloseBrace)
         {
             --indentlevel2;
             if (indentlevel2 <= 0)
@@ -695,7 +695,7 @@ void CheckBufferOverrun::checkFunctionParameter(const Token &tok, unsigned int p
                     }
                 }
 
-                if (ftok->str() == "}")
+                if (ftok->kind() == Token::eCloseBrace)
                     break;
 
                 if (ftok->varId() == parameterVarId)
@@ -865,12 +865,12 @@ void CheckBufferOverrun::checkScope(const Token *tok, const std::vector<std::str
     int indentlevel = 0;
     for (; tok; tok = tok->next())
     {
-        if (tok->str() == "{")
+        if (tok->kind() == Token::eOpenBrace)
         {
             ++indentlevel;
         }
 
-        else if (tok->str() == "}")
+        else if (tok->kind() == Token::eCloseBrace)
         {
             --indentlevel;
             if (indentlevel < 0)
@@ -1028,12 +1028,12 @@ void CheckBufferOverrun::checkScope(const Token *tok, const ArrayInfo &arrayInfo
     unsigned int indentlevel = 0;
     for (; tok; tok = tok->next())
     {
-        if (tok->str() == "{")
+        if (tok->kind() == Token::eOpenBrace)
         {
             ++indentlevel;
         }
 
-        else if (tok->str() == "}")
+        else if (tok->kind() == Token::eCloseBrace)
         {
             if (indentlevel == 0)
                 return;
@@ -1216,10 +1216,10 @@ void CheckBufferOverrun::checkGlobalAndLocalVariable()
     int indentlevel = 0;
     for (const Token *tok = _tokenizer->tokens(); tok; tok = tok->next())
     {
-        if (tok->str() == "{")
+        if (tok->kind() == Token::eOpenBrace)
             ++indentlevel;
 
-        else if (tok->str() == "}")
+        else if (tok->kind() == Token::eCloseBrace)
             --indentlevel;
 
         // size : Max array index
@@ -1394,7 +1394,7 @@ void CheckBufferOverrun::checkStructVariable()
 {
     for (const Token *tok = _tokenizer->tokens(); tok; tok = tok->next())
     {
-        if (tok->str() == "{")
+        if (tok->kind() == Token::eOpenBrace)
         {
             tok = tok->link();
         }
@@ -1405,20 +1405,20 @@ void CheckBufferOverrun::checkStructVariable()
         const std::string &structname = tok->next()->str();
         const Token *tok2 = tok;
 
-        while (tok2 && tok2->str() != "{")
+        while (tok2 && tok2->kind() != Token::eOpenBrace)
             tok2 = tok2->next();
 
         // Found a struct declaration. Search for arrays..
         for (; tok2; tok2 = tok2->next())
         {
             // skip inner scopes..
-            if (tok2->next() && tok2->next()->str() == "{")
+            if (tok2->next() && tok2->next()->kind() == Token::eOpenBrace)
             {
                 tok2 = tok2->next()->link();
                 continue;
             }
 
-            if (tok2->str() == "}")
+            if (tok2->kind() == Token::eCloseBrace)
                 break;
 
             ArrayInfo arrayInfo;
@@ -1755,12 +1755,12 @@ void CheckBufferOverrun::checkBufferAllocatedWithStrlen()
         {
             // To avoid false positives and added complexity, we will only look for
             // improper usage of the buffer within the block that it was allocated
-            if (tok->str() == "{")
+            if (tok->kind() == Token::eOpenBrace)
             {
                 ++indentlevel;
             }
 
-            else if (tok->str() == "}")
+            else if (tok->kind() == Token::eCloseBrace)
             {
                 --indentlevel;
                 if (indentlevel < 0)
@@ -1828,12 +1828,12 @@ void CheckBufferOverrun::checkInsecureCmdLineArgs()
         int indentlevel = -1;
         for (; tok; tok = tok->next())
         {
-            if (tok->str() == "{")
+            if (tok->kind() == Token::eOpenBrace)
             {
                 ++indentlevel;
             }
 
-            else if (tok->str() == "}")
+            else if (tok->kind() == Token::eCloseBrace)
             {
                 --indentlevel;
                 if (indentlevel < 0)
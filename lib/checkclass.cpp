@@ -280,13 +280,13 @@ void CheckClass::initializeVarList(const Function &func, std::list<std::string>
         }
 
 
-        if (ftok->str() == "{")
+        if (ftok->kind() == Token::eOpenBrace)
         {
             ++indentlevel;
             Assign = false;
         }
 
-        else if (ftok->str() == "}")
+        else if (ftok->kind() == Token::eCloseBrace)
         {
             if (indentlevel <= 1)
                 break;
@@ -737,7 +737,7 @@ void CheckClass::noMemset()
 
         for (; tstruct; tstruct = tstruct->next())
         {
-            if (tstruct->str() == "}")
+            if (tstruct->kind() == Token::eCloseBrace)
                 break;
 
             // struct with function? skip function body..
@@ -991,7 +991,7 @@ void CheckClass::operatorEqToSelf()
                         const Token *tok = it->token->next()->link();
                         const Token *tok1 = tok;
 
-                        if (tok1 && tok1->tokAt(1) && tok1->tokAt(1)->str() == "{" && tok1->tokAt(1)->link())
+                        if (tok1 && tok1->tokAt(1) && tok1->tokAt(1)->kind() == Token::eOpenBrace && tok1->tokAt(1)->link())
                         {
                             const Token *first = tok1->tokAt(1);
                             const Token *last = first->link();
@@ -1452,9 +1452,9 @@ bool CheckClass::checkConstFunc(const Scope *scope, const Token *tok)
     bool isconst = true;
     for (const Token *tok1 = tok; tok1; tok1 = tok1->next())
     {
-        if (tok1->str() == "{")
+        if (tok1->kind() == Token::eOpenBrace)
             ++indentlevel;
-        else if (tok1->str() == "}")
+        else if (tok1->kind() == Token::eCloseBrace)
         {
             if (indentlevel <= 1)
                 break;
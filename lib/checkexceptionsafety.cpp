@@ -53,12 +53,12 @@ void CheckExceptionSafety::destructors()
         unsigned int indentlevel = 0;
         for (const Token *tok2 = tok->tokAt(5); tok2; tok2 = tok2->next())
         {
-            if (tok2->str() == "{")
+            if (tok2->kind() == Token::eOpenBrace)
             {
                 ++indentlevel;
             }
 
-            else if (tok2->str() == "}")
+            else if (tok2->kind() == Token::eCloseBrace)
             {
                 if (indentlevel <= 1)
                     break;
@@ -114,14 +114,14 @@ void CheckExceptionSafety::deallocThrow()
 
                 if (tok2->str() == "class")
                 {
-                    while (tok2 && tok2->str() != ";" && tok2->str() != "{")
+                    while (tok2 && tok2->str() != ";" && tok2->kind() != Token::eOpenBrace)
                         tok2 = tok2->next();
                     tok2 = tok2 ? tok2->next() : 0;
                     if (!tok2)
                         break;
                 }
 
-                if (tok2->str() == "{")
+                if (tok2->kind() == Token::eOpenBrace)
                 {
                     tok2 = tok2->link();
                     if (!tok2)
@@ -143,9 +143,9 @@ void CheckExceptionSafety::deallocThrow()
         // is there a throw after the deallocation?
         for (const Token *tok2 = tok; tok2; tok2 = tok2->next())
         {
-            if (tok2->str() == "{")
+            if (tok2->kind() == Token::eOpenBrace)
                 ++indentlevel;
-            else if (tok2->str() == "}")
+            else if (tok2->kind() == Token::eCloseBrace)
             {
                 if (indentlevel == 0)
                     break;
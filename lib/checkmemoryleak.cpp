@@ -370,7 +370,7 @@ CheckMemoryLeak::AllocType CheckMemoryLeak::functionReturnType(const Token *tok)
     unsigned int parlevel = 0;
     while (tok)
     {
-        if (tok->str() == "{" || tok->str() == "}")
+        if (tok->kind() == Token::eOpenBrace || tok->kind() == Token::eCloseBrace)
             return No;
 
         if (tok->str() == "(")
@@ -394,7 +394,7 @@ CheckMemoryLeak::AllocType CheckMemoryLeak::functionReturnType(const Token *tok)
     if (!Token::Match(tok, ") const| {"))
         return No;
 
-    while (tok->str() != "{")
+    while (tok->kind() != Token::eOpenBrace)
         tok = tok->next();
 
     // Get return pointer..
@@ -402,9 +402,9 @@ CheckMemoryLeak::AllocType CheckMemoryLeak::functionReturnType(const Token *tok)
     unsigned int indentlevel = 0;
     for (const Token *tok2 = tok; tok2; tok2 = tok2->next())
     {
-        if (tok2->str() == "{")
+        if (tok2->kind() == Token::eOpenBrace)
             ++indentlevel;
-        else if (tok2->str() == "}")
+        else if (tok2->kind() == Token::eCloseBrace)
         {
             if (indentlevel <= 1)
                 return No;
@@ -467,7 +467,7 @@ const char *CheckMemoryLeak::functionArgAlloc(const Token *tok, unsigned int tar
 
     while (tok)
     {
-        if (tok->str() == "{" || tok->str() == "}")
+        if (tok->kind() == Token::eOpenBrace || tok->kind() == Token::eCloseBrace)
             return "";
 
         if (tok->str() == "(")
@@ -505,7 +505,7 @@ const char *CheckMemoryLeak::functionArgAlloc(const Token *tok, unsigned int tar
     if (!Token::Match(tok, ") const| {"))
         return "";
 
-    while (tok->str() != "{")
+    while (tok->kind() != Token::eOpenBrace)
         tok = tok->next();
 
     // Check if pointer is allocated.
@@ -513,9 +513,9 @@ const char *CheckMemoryLeak::functionArgAlloc(const Token *tok, unsigned int tar
     int realloc = 0;
     while (0 != (tok = tok->next()))
     {
-        if (tok->str() == "{")
+        if (tok->kind() == Token::eOpenBrace)
             ++indentlevel;
-        else if (tok->str() == "}")
+        else if (tok->kind() == Token::eCloseBrace)
         {
             if (indentlevel <= 1)
                 break;
@@ -579,9 +579,9 @@ void CheckMemoryLeakInFunction::parse_noreturn()
         unsigned int indentlevel = 1;
         for (const Token *tok2 = scope->classStart->next(); tok2; tok2 = tok2->next())
         {
-            if (tok2->str() == "{")
+            if (tok2->kind() == Token::eOpenBrace)
                 ++indentlevel;
-            else if (tok2->str() == "}")
+            else if (tok2->kind() == Token::eCloseBrace)
             {
                 --indentlevel;
                 if (indentlevel == 0)
@@ -705,7 +705,7 @@ const char * CheckMemoryLeakInFunction::call_func(const Token *tok, std::list<co
     if (varid == 0)
     {
         const Token *ftok = _tokenizer->getFunctionTokenByName(funcname.c_str());
-        while (ftok && (ftok->str() != "{"))
+        while (ftok && (ftok->kind() != Token::eOpenBrace))
             ftok = ftok->next();
         if (!ftok)
             return 0;
@@ -799,7 +799,7 @@ const char * CheckMemoryLeakInFunction::call_func(const Token *tok, std::list<co
                 if (parameterVarid == 0)
                     return "recursive";
                 // Check if the function deallocates the variable..
-                while (ftok && (ftok->str() != "{"))
+                while (ftok && (ftok->kind() != Token::eOpenBrace))
                     ftok = ftok->next();
                 Token *func = getcode(ftok->tokAt(1), callstack, parameterVarid, alloctype, dealloctype, false, sz);
                 //simplifycode(func, all);
@@ -869,12 +869,12 @@ Token *CheckMemoryLeakInFunction::getcode(const Token *tok, std::list<const Toke
     int parlevel = 0;
     for (; tok; tok = tok->next())
     {
-        if (tok->str() == "{")
+        if (tok->kind() == Token::eOpenBrace)
         {
             addtoken(&rettail, tok, "{");
             ++indentlevel;
         }
-        else if (tok->str() == "}")
+        else if (tok->kind() == Token::eCloseBrace)
         {
             addtoken(&rettail, tok, "}");
             if (indentlevel <= 0)
@@ -921,7 +921,7 @@ Token *CheckMemoryLeakInFunction::getcode(const Token *tok, std::list<const Toke
                     }
 
                     if (tok2->varId() == varid ||
-                        tok2->str() == ":" || tok2->str() == "{" || tok2->str() == "}")
+                        tok2->str() == ":" || tok2->kind() == Token::eOpenBrace || tok2->kind() == Token::eCloseBrace)
                     {
                         break;
                     }
@@ -1156,9 +1156,9 @@ Token *CheckMemoryLeakInFunction::getcode(const Token *tok, std::list<const Toke
                     // if a variable is assigned then add variable to "extravar".
                     for (const Token *tok2 = tok->next()->link()->tokAt(2); tok2; tok2 = tok2->next())
                     {
-                        if (tok2->str() == "{")
+                        if (tok2->kind() == Token::eOpenBrace)
                             tok2 = tok2->link();
-                        else if (tok2->str() == "}")
+                        else if (tok2->kind() == Token::eCloseBrace)
                             break;
                         else if (Token::Match(tok2, "%var% ="))
                             extravar.insert(tok2->varId());
@@ -1451,9 +1451,9 @@ Token *CheckMemoryLeakInFunction::getcode(const Token *tok, std::list<const Toke
                 bool use = false;
                 for (const Token *tok2 = tok; tok2; tok2 = tok2->next())
                 {
-                    if (tok2->str() == "{")
+                    if (tok2->kind() == Token::eOpenBrace)
                         ++indentlevel2;
-                    else if (tok2->str() == "}")
+                    else if (tok2->kind() == Token::eCloseBrace)
                     {
                         if (indentlevel2 <= 1)
                             break;
@@ -1644,9 +1644,9 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
         int trylevel = -1;
         for (Token *tok2 = tok; tok2; tok2 = tok2->next())
         {
-            if (tok2->str() == "{")
+            if (tok2->kind() == Token::eOpenBrace)
                 ++indentlevel;
-            else if (tok2->str() == "}")
+            else if (tok2->kind() == Token::eCloseBrace)
             {
                 --indentlevel;
                 if (indentlevel <= trylevel)
@@ -1662,9 +1662,9 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
     // Insert extra ";"
     for (Token *tok2 = tok; tok2; tok2 = tok2->next())
     {
-        if (!tok2->previous() || Token::Match(tok2->previous(), "[;{}]"))
+        if (!tok2->previous() || TOKEN_MATCH(tok2->previous(), "[;{}]"))
         {
-            if (Token::Match(tok2, "assign|callfunc|use assign|callfunc|use"))
+            if (TOKEN_MATCH(tok2, "assign|callfunc|use assign|callfunc|use"))
             {
                 tok2->insertToken(";");
             }
@@ -1680,14 +1680,14 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             unsigned int indent = 0;
             for (Token *end = start; end; end = end->next())
             {
-                if (end->str() == "{")
+                if (end->kind() == Token::eOpenBrace)
                     ++indent;
-                else if (end->str() == "}")
+                else if (end->kind() == Token::eCloseBrace)
                 {
                     if (indent <= 1)
                     {
                         // If the start/end braces are redundant, delete them
-                        if (indent == 1 && Token::Match(end->previous(), "[;{}] } %any%"))
+                        if (indent == 1 && TOKEN_MATCH(end->previous(), "[;{}] } %any%"))
                         {
                             start->deleteNext();
                             end->deleteThis();
@@ -1714,13 +1714,13 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
         {
             if (tok2->str() == "callfunc")
             {
-                if (!Token::Match(tok2->previous(), "[;{}] callfunc ; }"))
+                if (!TOKEN_MATCH(tok2->previous(), "[;{}] callfunc ; }"))
                     tok2->deleteThis();
             }
         }
 
         // If the code starts with "if return ;" then remove it
-        if (Token::Match(tok, ";| if return ;"))
+        if (TOKEN_MATCH(tok, ";| if return ;"))
         {
             tok->deleteThis();
             tok->deleteThis();
@@ -1738,15 +1738,15 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                 unsigned int innerIndentlevel = 0;
                 for (Token *tok3 = tok2->tokAt(2); tok3; tok3 = tok3->next())
                 {
-                    if (tok3->str() == "{")
+                    if (tok3->kind() == Token::eOpenBrace)
                         ++innerIndentlevel;
-                    else if (tok3->str() == "}")
+                    else if (tok3->kind() == Token::eCloseBrace)
                     {
                         if (innerIndentlevel == 0)
                             break;
                         --innerIndentlevel;
                     }
-                    while (innerIndentlevel == 0 && Token::Match(tok3, "[{};] if|ifv|else { continue ; }"))
+                    while (innerIndentlevel == 0 && TOKEN_MATCH(tok3, "[{};] if|ifv|else { continue ; }"))
                     {
                         Token::eraseTokens(tok3, tok3->tokAt(6));
                         if (Token::simpleMatch(tok3->next(), "else"))
@@ -1767,7 +1767,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
         for (Token *tok2 = tok; tok2; tok2 = tok2 ? tok2->next() : NULL)
         {
             // Delete extra ";"
-            while (Token::Match(tok2, "[;{}] ;"))
+            while (TOKEN_MATCH(tok2, "[;{}] ;"))
             {
                 tok2->deleteNext();
                 done = false;
@@ -1782,13 +1782,13 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // Delete braces around a single instruction..
-            if (Token::Match(tok2->next(), "{ %var% ; }"))
+            if (TOKEN_MATCH(tok2->next(), "{ %var% ; }"))
             {
                 tok2->deleteNext();
                 Token::eraseTokens(tok2->tokAt(2), tok2->tokAt(4));
                 done = false;
             }
-            if (Token::Match(tok2->next(), "{ %var% %var% ; }"))
+            if (TOKEN_MATCH(tok2->next(), "{ %var% %var% ; }"))
             {
                 tok2->deleteNext();
                 Token::eraseTokens(tok2->tokAt(3), tok2->tokAt(5));
@@ -1796,7 +1796,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // Reduce "if if|callfunc" => "if"
-            else if (Token::Match(tok2, "if if|callfunc"))
+            else if (TOKEN_MATCH(tok2, "if if|callfunc"))
             {
                 tok2->deleteNext();
                 done = false;
@@ -1805,14 +1805,14 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             else if (tok2->next() && tok2->next()->str() == "if")
             {
                 // Delete empty if that is not followed by an else
-                if (Token::Match(tok2->next(), "if ; !!else"))
+                if (TOKEN_MATCH(tok2->next(), "if ; !!else"))
                 {
                     tok2->deleteNext();
                     done = false;
                 }
 
                 // Reduce "if X ; else X ;" => "X ;"
-                else if (Token::Match(tok2->next(), "if %var% ; else %var% ;") &&
+                else if (TOKEN_MATCH(tok2->next(), "if %var% ; else %var% ;") &&
                          std::string(tok2->strAt(2)) == std::string(tok2->strAt(5)))
                 {
                     Token::eraseTokens(tok2, tok2->tokAt(5));
@@ -1827,14 +1827,14 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                 }
 
                 // Reduce "if return ; alloc ;" => "alloc ;"
-                else if (Token::Match(tok2, "[;{}] if return ; alloc|return ;"))
+                else if (TOKEN_MATCH(tok2, "[;{}] if return ; alloc|return ;"))
                 {
                     Token::eraseTokens(tok2, tok2->tokAt(4));
                     done = false;
                 }
 
                 // "[;{}] if alloc ; else return ;" => "[;{}] alloc ;"
-                else if (Token::Match(tok2, "[;{}] if alloc ; else return ;"))
+                else if (TOKEN_MATCH(tok2, "[;{}] if alloc ; else return ;"))
                 {
                     tok2->deleteNext();                                // Remove "if"
                     Token::eraseTokens(tok2->next(), tok2->tokAt(5));  // Remove "; else return"
@@ -1842,7 +1842,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                 }
 
                 // Reduce "if ; else %var% ;" => "if %var% ;"
-                else if (Token::Match(tok2->next(), "if ; else %var% ;"))
+                else if (TOKEN_MATCH(tok2->next(), "if ; else %var% ;"))
                 {
                     Token::eraseTokens(tok2->next(), tok2->tokAt(4));
                     done = false;
@@ -1856,28 +1856,28 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                 }
 
                 // Reduce "if return ; else|if return|continue ;" => "if return ;"
-                else if (Token::Match(tok2->next(), "if return ; else|if return|continue|break ;"))
+                else if (TOKEN_MATCH(tok2->next(), "if return ; else|if return|continue|break ;"))
                 {
                     Token::eraseTokens(tok2->tokAt(3), tok2->tokAt(6));
                     done = false;
                 }
 
                 // Reduce "if continue|break ; else|if return ;" => "if return ;"
-                else if (Token::Match(tok2->next(), "if continue|break ; if|else return ;"))
+                else if (TOKEN_MATCH(tok2->next(), "if continue|break ; if|else return ;"))
                 {
                     Token::eraseTokens(tok2->next(), tok2->tokAt(5));
                     done = false;
                 }
 
                 // Remove "else" after "if continue|break|return"
-                else if (Token::Match(tok2->next(), "if continue|break|return ; else"))
+                else if (TOKEN_MATCH(tok2->next(), "if continue|break|return ; else"))
                 {
                     tok2->tokAt(4)->deleteThis();
                     done = false;
                 }
 
                 // Delete "if { dealloc|assign|use ; return ; }"
-                else if (Token::Match(tok2, "[;{}] if { dealloc|assign|use ; return ; }"))
+                else if (TOKEN_MATCH(tok2, "[;{}] if { dealloc|assign|use ; return ; }"))
                 {
                     Token::eraseTokens(tok2, tok2->tokAt(8));
                     if (Token::simpleMatch(tok2->next(), "else"))
@@ -1886,7 +1886,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                 }
 
                 // Remove "if { dealloc ; callfunc ; } !!else"
-                else if (Token::Match(tok2->next(), "if { dealloc|assign ; callfunc ; } !!else"))
+                else if (TOKEN_MATCH(tok2->next(), "if { dealloc|assign ; callfunc ; } !!else"))
                 {
                     Token::eraseTokens(tok2, tok2->tokAt(8));
                     done = false;
@@ -1896,7 +1896,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // Reduce "alloc while(!var) alloc ;" => "alloc ;"
-            if (Token::Match(tok2, "[;{}] alloc ; while(!var) alloc ;"))
+            if (TOKEN_MATCH(tok2, "[;{}] alloc ; while(!var) alloc ;"))
             {
                 Token::eraseTokens(tok2, tok2->tokAt(4));
                 done = false;
@@ -1911,14 +1911,14 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // Reduce "if(var) dealloc ;" and "if(var) use ;" that is not followed by an else..
-            if (Token::Match(tok2, "[;{}] if(var) assign|dealloc|use ; !!else"))
+            if (TOKEN_MATCH(tok2, "[;{}] if(var) assign|dealloc|use ; !!else"))
             {
                 Token::eraseTokens(tok2, tok2->tokAt(2));
                 done = false;
             }
 
             // Reduce "; if(!var) alloc ; !!else" => "; dealloc ; alloc ;"
-            if (Token::Match(tok2, "; if(!var) alloc ; !!else"))
+            if (TOKEN_MATCH(tok2, "; if(!var) alloc ; !!else"))
             {
                 // Remove the "if(!var)"
                 Token::eraseTokens(tok2, tok2->tokAt(2));
@@ -1931,14 +1931,14 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // Reduce "; if(!var) exit ;" => ";"
-            if (Token::Match(tok2, "; if(!var) exit ;"))
+            if (TOKEN_MATCH(tok2, "; if(!var) exit ;"))
             {
                 Token::eraseTokens(tok2, tok2->tokAt(3));
                 done = false;
             }
 
             // Reduce "if* ;"..
-            if (Token::Match(tok2->next(), "if(var)|if(!var)|ifv ;"))
+            if (TOKEN_MATCH(tok2->next(), "if(var)|if(!var)|ifv ;"))
             {
                 // Followed by else..
                 if (Token::simpleMatch(tok2->tokAt(3), "else"))
@@ -1968,7 +1968,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // Reduce "while1 continue| ;" => "use ;"
-            if (Token::Match(tok2, "while1 if| continue| ;"))
+            if (TOKEN_MATCH(tok2, "while1 if| continue| ;"))
             {
                 tok2->str("use");
                 while (tok2->strAt(1) != ";")
@@ -1985,21 +1985,21 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // Delete if block: "alloc; if return use ;"
-            if (Token::Match(tok2, "alloc ; if return use ; !!else"))
+            if (TOKEN_MATCH(tok2, "alloc ; if return use ; !!else"))
             {
                 Token::eraseTokens(tok2, tok2->tokAt(5));
                 done = false;
             }
 
             // Reduce "alloc|dealloc|use|callfunc ; exit ;" => "; exit ;"
-            if (Token::Match(tok2, "[;{}] alloc|dealloc|use|callfunc ; exit ;"))
+            if (TOKEN_MATCH(tok2, "[;{}] alloc|dealloc|use|callfunc ; exit ;"))
             {
                 tok2->deleteNext();
                 done = false;
             }
 
             // Reduce "alloc|dealloc|use ; if(var) exit ;"
-            if (Token::Match(tok2, "alloc|dealloc|use ; if(var) exit ;"))
+            if (TOKEN_MATCH(tok2, "alloc|dealloc|use ; if(var) exit ;"))
             {
                 tok2->deleteThis();
                 done = false;
@@ -2014,7 +2014,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // Remove the "if break|continue ;" that follows "dealloc ; alloc ;"
-            if (! _settings->inconclusive && Token::Match(tok2, "dealloc ; alloc ; if break|continue ;"))
+            if (! _settings->inconclusive && TOKEN_MATCH(tok2, "dealloc ; alloc ; if break|continue ;"))
             {
                 tok2 = tok2->tokAt(3);
                 Token::eraseTokens(tok2, tok2->tokAt(3));
@@ -2022,7 +2022,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // if break ; break ; => break ;
-            if (Token::Match(tok2->previous(), "[;{}] if break ; break ;"))
+            if (TOKEN_MATCH(tok2->previous(), "[;{}] if break ; break ;"))
             {
                 Token::eraseTokens(tok2, tok2->tokAt(4));
                 done = false;
@@ -2045,28 +2045,28 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // Reduce "loop break ; => ";"
-            if (Token::Match(tok2->next(), "loop break|continue ;"))
+            if (TOKEN_MATCH(tok2->next(), "loop break|continue ;"))
             {
                 Token::eraseTokens(tok2, tok2->tokAt(3));
                 done = false;
             }
 
             // Reduce "loop|do ;" => ";"
-            if (Token::Match(tok2, "loop|do ;"))
+            if (TOKEN_MATCH(tok2, "loop|do ;"))
             {
                 tok2->deleteThis();
                 done = false;
             }
 
             // Reduce "loop if break|continue ; !!else" => ";"
-            if (Token::Match(tok2->next(), "loop if break|continue ; !!else"))
+            if (TOKEN_MATCH(tok2->next(), "loop if break|continue ; !!else"))
             {
                 Token::eraseTokens(tok2, tok2->tokAt(4));
                 done = false;
             }
 
             // Reduce "loop { if break|continue ; !!else" => "loop {"
-            if (Token::Match(tok2, "loop { if break|continue ; !!else"))
+            if (TOKEN_MATCH(tok2, "loop { if break|continue ; !!else"))
             {
                 Token::eraseTokens(tok2->next(), tok2->tokAt(5));
                 done = false;
@@ -2094,7 +2094,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // Reduce "loop|while1 { dealloc ; alloc ; }"
-            if (Token::Match(tok2, "loop|while1 { dealloc ; alloc ; }"))
+            if (TOKEN_MATCH(tok2, "loop|while1 { dealloc ; alloc ; }"))
             {
                 // delete "loop|while1"
                 tok2->deleteThis();
@@ -2118,21 +2118,21 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // Delete if block in "alloc ; if(!var) return ;"
-            if (Token::Match(tok2, "alloc ; if(!var) return ;"))
+            if (TOKEN_MATCH(tok2, "alloc ; if(!var) return ;"))
             {
                 Token::eraseTokens(tok2, tok2->tokAt(4));
                 done = false;
             }
 
             // Reduce "[;{}] return use ; %var%" => "[;{}] return use ;"
-            if (Token::Match(tok2, "[;{}] return use ; %var%"))
+            if (TOKEN_MATCH(tok2, "[;{}] return use ; %var%"))
             {
                 Token::eraseTokens(tok2->tokAt(3), tok2->tokAt(5));
                 done = false;
             }
 
             // Reduce "if(var) return use ;" => "return use ;"
-            if (Token::Match(tok2->next(), "if(var) return use ; !!else"))
+            if (TOKEN_MATCH(tok2->next(), "if(var) return use ; !!else"))
             {
                 Token::eraseTokens(tok2, tok2->tokAt(2));
                 done = false;
@@ -2140,14 +2140,14 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
 
             // malloc - realloc => alloc ; dealloc ; alloc ;
             // Reduce "[;{}] alloc ; dealloc ; alloc ;" => "[;{}] alloc ;"
-            if (Token::Match(tok2, "[;{}] alloc ; dealloc ; alloc ;"))
+            if (TOKEN_MATCH(tok2, "[;{}] alloc ; dealloc ; alloc ;"))
             {
                 Token::eraseTokens(tok2->next(), tok2->tokAt(6));
                 done = false;
             }
 
             // use; dealloc; => dealloc;
-            if (Token::Match(tok2, "[;{}] use ; dealloc ;"))
+            if (TOKEN_MATCH(tok2, "[;{}] use ; dealloc ;"))
             {
                 Token::eraseTokens(tok2, tok2->tokAt(3));
                 done = false;
@@ -2161,7 +2161,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // use; if| use; => use;
-            while (Token::Match(tok2, "[;{}] use ; if| use ;"))
+            while (TOKEN_MATCH(tok2, "[;{}] use ; if| use ;"))
             {
                 Token *t = tok2->tokAt(2);
                 t->deleteNext();
@@ -2172,7 +2172,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             }
 
             // Delete first part in "use ; return use ;"
-            if (Token::Match(tok2, "[;{}] use ; return use ;"))
+            if (TOKEN_MATCH(tok2, "[;{}] use ; return use ;"))
             {
                 Token::eraseTokens(tok2, tok2->tokAt(3));
                 done = false;
@@ -2201,10 +2201,10 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                 bool incase = false;
                 for (const Token * _tok = tok2->tokAt(2); _tok; _tok = _tok->next())
                 {
-                    if (_tok->str() == "{")
+                    if (_tok->kind() == Token::eOpenBrace)
                         break;
 
-                    else if (_tok->str() == "}")
+                    else if (_tok->kind() == Token::eCloseBrace)
                     {
                         valid = true;
                         break;
@@ -2219,10 +2219,10 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                     else if (incase && _tok->str() == "case")
                         break;
 
-                    else if (Token::Match(_tok, "return !!;"))
+                    else if (TOKEN_MATCH(_tok, "return !!;"))
                         break;
 
-                    if (Token::Match(_tok, "if return|break use| ;"))
+                    if (TOKEN_MATCH(_tok, "if return|break use| ;"))
                         _tok = _tok->tokAt(2);
 
                     incase |= (_tok->str() == "case");
@@ -2236,7 +2236,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                     Token::eraseTokens(tok2, tok2->tokAt(2));
                     tok2 = tok2->next();
                     bool first = true;
-                    while (Token::Match(tok2, "case|default"))
+                    while (TOKEN_MATCH(tok2, "case|default"))
                     {
                         const bool def(tok2->str() == "default");
                         tok2->str(first ? "if" : "}");
@@ -2256,11 +2256,11 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                         }
                         while (tok2)
                         {
-                            if (tok2->str() == "}")
+                            if (tok2->kind() == Token::eCloseBrace)
                                 break;
-                            if (Token::Match(tok2, "break|return ;"))
+                            if (TOKEN_MATCH(tok2, "break|return ;"))
                                 break;
-                            if (Token::Match(tok2, "if return|break use| ;"))
+                            if (TOKEN_MATCH(tok2, "if return|break use| ;"))
                                 tok2 = tok2->tokAt(2);
                             else
                                 tok2 = tok2->next();
@@ -2516,9 +2516,9 @@ void CheckMemoryLeakInFunction::checkReallocUsage()
         unsigned int indentlevel = 1;
         for (tok = tok->next(); tok; tok = tok->next())
         {
-            if (tok->str() == "{")
+            if (tok->kind() == Token::eOpenBrace)
                 ++indentlevel;
-            else if (tok->str() == "}")
+            else if (tok->kind() == Token::eCloseBrace)
             {
                 --indentlevel;
                 if (indentlevel == 0)
@@ -2585,9 +2585,9 @@ void CheckMemoryLeakInFunction::parseFunctionScope(const Token *tok, const Token
     unsigned int indentlevel = 0;
     do
     {
-        if (tok->str() == "{")
+        if (tok->kind() == Token::eOpenBrace)
             ++indentlevel;
-        else if (tok->str() == "}")
+        else if (tok->kind() == Token::eCloseBrace)
         {
             if (indentlevel <= 1)
                 break;
@@ -2766,9 +2766,9 @@ void CheckMemoryLeakInClass::variable(const Scope *scope, const Token *tokVarnam
         bool initlist = false;
         for (const Token *tok = functionToken; tok; tok = tok->next())
         {
-            if (tok->str() == "{")
+            if (tok->kind() == Token::eOpenBrace)
                 ++indent;
-            else if (tok->str() == "}")
+            else if (tok->kind() == Token::eCloseBrace)
             {
                 if (indent <= 1)
                     break;
@@ -2899,7 +2899,7 @@ void CheckMemoryLeakInClass::checkPublicFunctions(const Scope *scope, const Toke
             func->access == Public && func->hasBody)
         {
             const Token *tok2 = func->token;
-            while (tok2->str() != "{")
+            while (tok2->kind() != Token::eOpenBrace)
                 tok2 = tok2->next();
             if (Token::Match(tok2, "{|}|; %varid% =", varid))
             {
@@ -2938,9 +2938,9 @@ void CheckMemoryLeakStructMember::check()
     unsigned int indentlevel1 = 0;
     for (const Token *tok = _tokenizer->tokens(); tok; tok = tok->next())
     {
-        if (tok->str() == "{")
+        if (tok->kind() == Token::eOpenBrace)
             ++indentlevel1;
-        else if (tok->str() == "}")
+        else if (tok->kind() == Token::eCloseBrace)
             --indentlevel1;
 
         // Locate struct variables..
@@ -2957,9 +2957,9 @@ void CheckMemoryLeakStructMember::check()
                 unsigned int indentlevel2 = 0;
                 for (const Token *tok2 = vartok; tok2; tok2 = tok2->next())
                 {
-                    if (tok2->str() == "{")
+                    if (tok2->kind() == Token::eOpenBrace)
                         ++indentlevel2;
-                    else if (tok2->str() == "}")
+                    else if (tok2->kind() == Token::eCloseBrace)
                     {
                         if (indentlevel2 == 0)
                             break;
@@ -2983,10 +2983,10 @@ void CheckMemoryLeakStructMember::check()
             unsigned int indentlevel2 = 0;
             for (const Token *tok2 = vartok; tok2; tok2 = tok2->next())
             {
-                if (tok2->str() == "{")
+                if (tok2->kind() == Token::eOpenBrace)
                     ++indentlevel2;
 
-                else if (tok2->str() == "}")
+                else if (tok2->kind() == Token::eCloseBrace)
                 {
                     if (indentlevel2 == 0)
                         break;
@@ -3008,10 +3008,10 @@ void CheckMemoryLeakStructMember::check()
                     unsigned int indentlevel3 = indentlevel2;
                     for (const Token *tok3 = tok2; tok3; tok3 = tok3->next())
                     {
-                        if (tok3->str() == "{")
+                        if (tok3->kind() == Token::eOpenBrace)
                             ++indentlevel3;
 
-                        else if (tok3->str() == "}")
+                        else if (tok3->kind() == Token::eCloseBrace)
                         {
                             if (indentlevel3 == 0)
                             {
@@ -3037,11 +3037,11 @@ void CheckMemoryLeakStructMember::check()
                                 const std::string tok3str_(tok3->str());
                                 if (tok3->str() == "return")
                                     ret = true;
-                                else if (tok3->str() == "{" || tok3->str() == "}")
+                                else if (tok3->kind() == Token::eOpenBrace || tok3->kind() == Token::eCloseBrace)
                                     break;
                                 tok3 = tok3->next();
                             }
-                            if (!ret || !tok3 || tok3->str() != "}")
+                            if (!ret || !tok3 || tok3->kind() != Token::eCloseBrace)
                                 break;
                             --indentlevel3;
                             continue;
@@ -3078,9 +3078,9 @@ void CheckMemoryLeakStructMember::check()
                             unsigned int indentlevel4 = 0;
                             for (const Token *tok4 = tok3; tok4; tok4 = tok4->next())
                             {
-                                if (tok4->str() == "{")
+                                if (tok4->kind() == Token::eOpenBrace)
                                     ++indentlevel4;
-                                else if (tok4->str() == "}")
+                                else if (tok4->kind() == Token::eCloseBrace)
                                 {
                                     --indentlevel4;
                                     if (indentlevel4 == 0)
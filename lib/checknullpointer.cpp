@@ -43,59 +43,40 @@ bool CheckNullPointer::isUpper(const std::string &str)
     return true;
 }
 
-/**
- * @brief parse a function call and extract information about variable usage
- * @param tok first token
- * @param var variables that the function read / write.
- * @param value 0 => invalid with null pointers as parameter.
- *              1-.. => invalid with uninitialized data.
- */
-void CheckNullPointer::parseFunctionCall(const Token &tok, std::list<const Token *> &var, unsigned char value)
+namespace
 {
     // standard functions that dereference first parameter..
     // both uninitialized data and null pointers are invalid.
-    static std::set<std::string> functionNames1;
-    if (functionNames1.empty())
+    const char * const functionNames1Array[] =
     {
-        functionNames1.insert("memchr");
-        functionNames1.insert("memcmp");
-        functionNames1.insert("strcat");
-        functionNames1.insert("strncat");
-        functionNames1.insert("strchr");
-        functionNames1.insert("strrchr");
-        functionNames1.insert("strcmp");
-        functionNames1.insert("strncmp");
-        functionNames1.insert("strdup");
-        functionNames1.insert("strndup");
-        functionNames1.insert("strlen");
-        functionNames1.insert("strstr");
-        functionNames1.insert("fclose");
-        functionNames1.insert("feof");
-        functionNames1.insert("fwrite");
-        functionNames1.insert("fseek");
-        functionNames1.insert("ftell");
-        functionNames1.insert("fgetpos");
-        functionNames1.insert("fsetpos");
-        functionNames1.insert("rewind");
-    }
+        "memchr", "memcmp", "strcat", "strncat", "strchr", "strrchr", "strcmp",
+        "strncmp", "strdup", "strndup", "strlen", "strstr", "fclose", "feof", "fwrite",
+        "fseek", "ftell", "fgetpos", "fsetpos", "rewind"
+    };
 
     // standard functions that dereference second parameter..
     // both uninitialized data and null pointers are invalid.
-    static std::set<std::string> functionNames2;
-    if (functionNames2.empty())
+    const char * const functionNames2Array[] =
     {
-        functionNames2.insert("memcmp");
-        functionNames2.insert("memcpy");
-        functionNames2.insert("memmove");
-        functionNames2.insert("strcat");
-        functionNames2.insert("strncat");
-        functionNames2.insert("strcmp");
-        functionNames2.insert("strncmp");
-        functionNames2.insert("strcpy");
-        functionNames2.insert("strncpy");
-        functionNames2.insert("strstr");
-    }
+        "memcmp", "memcpy", "memmove", "strcat", "strncat", "strcmp", "strncmp",
+        "strcpy", "strncpy", "strstr"
+    };
+
+    // The sets are created before main() so they are not changed when
+    // several threads use them
+    const std::set<std::string> functionNames1(functionNames1Array, functionNames1Array + sizeof(functionNames1Array) / sizeof(*functionNames1Array));
+    const std::set<std::string> functionNames2(functionNames2Array, functionNames2Array + sizeof(functionNames2Array) / sizeof(*functionNames2Array));
+}
 
+/**
+ * @brief parse a function call and extract information about variable usage
+ * @param tok first token
+ * @param var variables that the function read / write.
+ * @param value 0 => invalid with null pointers as parameter.
+ *              1-.. => invalid with uninitialized data.
+ */
+void CheckNullPointer::parseFunctionCall(const Token &tok, std::list<const Token *> &var, unsigned char value)
+{
     // 1st parameter..
     if ((Token::Match(&tok, "%var% ( %var% ,|)") && tok.tokAt(2)->varId() > 0) ||
         (value == 0 && Token::Match(&tok, "%var% ( 0 ,|)")))
@@ -212,7 +193,7 @@ void CheckNullPointer::nullPointerAfterLoop()
         while (0 != (tok2 = tok2 ? tok2->next() : 0))
         {
             // Don't check into inner scopes or outer scopes. Stop checking if "break" is found
-            if (tok2->str() == "{" || tok2->str() == "}" || tok2->str() == "break")
+            if (tok2->kind() == Token::eOpenBrace || tok2->kind() == Token::eCloseBrace || tok2->str() == "break")
                 break;
 
             // loop variable is found..
@@ -281,9 +262,9 @@ void CheckNullPointer::nullPointerLinkedList()
                 unsigned int indentlevel3 = 0;
                 for (const Token *tok3 = tok1->next()->link(); tok3; tok3 = tok3->next())
                 {
-                    if (tok3->str() == "{")
+                    if (tok3->kind() == Token::eOpenBrace)
                         ++indentlevel3;
-                    else if (tok3->str() == "}")
+                    else if (tok3->kind() == Token::eCloseBrace)
                     {
                         if (indentlevel3 <= 1)
                             break;
@@ -300,9 +281,9 @@ void CheckNullPointer::nullPointerLinkedList()
                         unsigned int indentlevel4 = indentlevel3;
                         for (const Token *tok4 = tok3->next()->link(); tok4; tok4 = tok4->next())
                         {
-                            if (tok4->str() == "{")
+                            if (tok4->kind() == Token::eOpenBrace)
                                 ++indentlevel4;
-                            else if (tok4->str() == "}")
+                            else if (tok4->kind() == Token::eCloseBrace)
                             {
                                 if (indentlevel4 <= 1)
                                 {
@@ -411,10 +392,10 @@ void CheckNullPointer::nullPointerStructByDeRefAndChec()
         unsigned int indentlevel2 = 0;
         for (const Token *tok2 = tok1->tokAt(3); tok2; tok2 = tok2->next())
         {
-            if (tok2->str() == "{")
+            if (tok2->kind() == Token::eOpenBrace)
                 ++indentlevel2;
 
-            else if (tok2->str() == "}")
+            else if (tok2->kind() == Token::eCloseBrace)
             {
                 if (indentlevel2 <= 1)
                     break;
@@ -529,8 +510,8 @@ void CheckNullPointer::nullPointerByDeRefAndChec()
                     }
                 }
 
-                else if (tok1->str() == "{" ||
-                         tok1->str() == "}")
+                else if (tok1->kind() == Token::eOpenBrace ||
+                         tok1->kind() == Token::eCloseBrace)
                     break;
 
                 // label..
@@ -616,9 +597,9 @@ void CheckNullPointer::nullPointerByCheckAndDeRef()
             unsigned int indentlevel = 1;
             for (const Token *tok2 = tok1; tok2; tok2 = tok2->next())
             {
-                if (tok2->str() == "{")
+                if (tok2->kind() == Token::eOpenBrace)
                     ++indentlevel;
-                else if (tok2->str() == "}")
+                else if (tok2->kind() == Token::eCloseBrace)
                 {
                     if (indentlevel == 0)
                         break;
@@ -699,10 +680,10 @@ void CheckNullPointer::nullConstantDereference()
 
         else if (indentlevel >= 1)
         {
-            if (tok->str() == "{")
+            if (tok->kind() == Token::eOpenBrace)
                 ++indentlevel;
 
-            else if (tok->str() == "}")
+            else if (tok->kind() == Token::eCloseBrace)
             {
                 if (indentlevel <= 2)
                     indentlevel = 0;
@@ -716,9 +697,9 @@ void CheckNullPointer::nullConstantDereference()
             else if (Token::simpleMatch(tok, "exit ( )"))
             {
                 // Goto end of scope
-                while (tok && tok->str() != "}")
+                while (tok && tok->kind() != Token::eCloseBrace)
                 {
-                    if (tok->str() == "{")
+                    if (tok->kind() == Token::eOpenBrace)
                         tok = tok->link();
                     tok = tok->next();
                 }
@@ -883,9 +864,9 @@ private:
             unsigned int indentlevel = 0;
             for (const Token *tok2 = &tok; tok2; tok2 = tok2->next())
             {
-                if (tok2->str() == "{")
+                if (tok2->kind() == Token::eOpenBrace)
                     ++indentlevel;
-                else if (tok2->str() == "}")
+                else if (tok2->kind() == Token::eCloseBrace)
                 {
                     if (indentlevel == 0)
                         break;
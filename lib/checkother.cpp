@@ -249,7 +249,7 @@ void CheckOther::checkRedundantAssignmentInSwitch()
         int indentLevel = 0;
         for (const Token *tok2 = tok->tokAt(5); tok2; tok2 = tok2->next())
         {
-            if (tok2->str() == "{")
+            if (tok2->kind() == Token::eOpenBrace)
             {
                 // Inside a conditional or loop. Don't mark variable accesses as being redundant. E.g.:
                 //   case 3: b = 1;
@@ -269,7 +269,7 @@ void CheckOther::checkRedundantAssignmentInSwitch()
                 else
                     ++ indentLevel;
             }
-            else if (tok2->str() == "}")
+            else if (tok2->kind() == Token::eCloseBrace)
             {
                 -- indentLevel;
 
@@ -346,7 +346,7 @@ void CheckOther::checkSwitchCaseFallThrough()
             {
                 tok2 = tok2->tokAt(1)->link()->next();
                 // skip over "do { } while ( ) ;" case
-                if (tok2->str() == "{")
+                if (tok2->kind() == Token::eOpenBrace)
                 {
                     if (tok2->link() == NULL)
                     {
@@ -408,11 +408,11 @@ void CheckOther::checkSwitchCaseFallThrough()
                 justbreak = true;
                 firstcase = false;
             }
-            else if (tok2->str() == "{")
+            else if (tok2->kind() == Token::eOpenBrace)
             {
                 scopenest.push(tok2->link());
             }
-            else if (tok2->str() == "}")
+            else if (tok2->kind() == Token::eCloseBrace)
             {
                 if (!ifnest.empty() && tok2 == ifnest.top().first)
                 {
@@ -1633,7 +1633,7 @@ void CheckOther::functionVariableUsage()
         unsigned int indentlevel = 0;
         for (const Token *tok = tok1; tok; tok = tok->next())
         {
-            if (tok->str() == "{")
+            if (tok->kind() == Token::eOpenBrace)
             {
                 // replace the head node when found
                 if (indentlevel == 0)
@@ -1643,7 +1643,7 @@ void CheckOther::functionVariableUsage()
                     scope = scope->addChild(tok);
                 ++indentlevel;
             }
-            else if (tok->str() == "}")
+            else if (tok->kind() == Token::eCloseBrace)
             {
                 --indentlevel;
 
@@ -1652,17 +1652,17 @@ void CheckOther::functionVariableUsage()
                 if (indentlevel == 0)
                     break;
             }
-            else if (Token::Match(tok, "struct|union|class {") ||
-                     Token::Match(tok, "struct|union|class %type% {|:"))
+            else if (TOKEN_MATCH(tok, "struct|union|class {") ||
+                     TOKEN_MATCH(tok, "struct|union|class %type% {|:"))
             {
-                while (tok->str() != "{")
+                while (tok->kind() != Token::eOpenBrace)
                     tok = tok->next();
                 tok = tok->link();
                 if (! tok)
                     break;
             }
 
-            if (Token::Match(tok, "[;{}] asm ( ) ;"))
+            if (TOKEN_MATCH(tok, "[;{}] asm ( ) ;"))
             {
                 variables.clear();
                 break;
@@ -1670,7 +1670,7 @@ void CheckOther::functionVariableUsage()
 
             // standard type declaration with possible initialization
             // int i; int j = 0; static int k;
-            if (Token::Match(tok, "[;{}] static| %type% %var% ;|=") &&
+            if (TOKEN_MATCH(tok, "[;{}] static| %type% %var% ;|=") &&
                 nextIsStandardType(tok))
             {
                 tok = tok->next();
@@ -1686,7 +1686,7 @@ void CheckOther::functionVariableUsage()
 
             // standard type declaration and initialization using constructor
             // int i(0); static int j(0);
-            else if (Token::Match(tok, "[;{}] static| %type% %var% ( %any% ) ;") &&
+            else if (TOKEN_MATCH(tok, "[;{}] static| %type% %var% ( %any% ) ;") &&
                      nextIsStandardType(tok))
             {
                 tok = tok->next();
@@ -1704,7 +1704,7 @@ void CheckOther::functionVariableUsage()
 
             // standard type declaration of array of with possible initialization
             // int i[10]; int j[2] = { 0, 1 }; static int k[2] = { 2, 3 };
-            else if (Token::Match(tok, "[;{}] static| const| %type% *| %var% [ %any% ] ;|=") &&
+            else if (TOKEN_MATCH(tok, "[;{}] static| const| %type% *| %var% [ %any% ] ;|=") &&
                      nextIsStandardType(tok))
             {
                 bool isStatic = false;
@@ -1736,9 +1736,9 @@ void CheckOther::functionVariableUsage()
                     if (Token::simpleMatch(nametok->tokAt(4), "= {"))
                     {
                         tok = nametok->tokAt(6);
-                        while (tok->str() != "}")
+                        while (tok->kind() != Token::eCloseBrace)
                         {
-                            if (Token::Match(tok, "%var%"))
+                            if (TOKEN_MATCH(tok, "%var%"))
                                 variables.read(tok->varId());
                             tok = tok->next();
                         }
@@ -1750,7 +1750,7 @@ void CheckOther::functionVariableUsage()
 
             // pointer or reference declaration with possible initialization
             // int * i; int * j = 0; static int * k = 0;
-            else if (Token::Match(tok, "[;{}] static| const| %type% *|& %var% ;|="))
+            else if (TOKEN_MATCH(tok, "[;{}] static| const| %type% *|& %var% ;|="))
             {
                 bool isStatic = false;
 
@@ -1793,7 +1793,7 @@ void CheckOther::functionVariableUsage()
 
             // pointer to pointer declaration with possible initialization
             // int ** i; int ** j = 0; static int ** k = 0;
-            else if (Token::Match(tok, "[;{}] static| const| %type% * * %var% ;|="))
+            else if (TOKEN_MATCH(tok, "[;{}] static| const| %type% * * %var% ;|="))
             {
                 bool isStatic = false;
 
@@ -1826,7 +1826,7 @@ void CheckOther::functionVariableUsage()
 
             // pointer or reference of struct or union declaration with possible initialization
             // struct s * i; struct s * j = 0; static struct s * k = 0;
-            else if (Token::Match(tok, "[;{}] static| const| struct|union %type% *|& %var% ;|="))
+            else if (TOKEN_MATCH(tok, "[;{}] static| const| struct|union %type% *|& %var% ;|="))
             {
                 Variables::VariableType type;
                 bool isStatic = false;
@@ -1862,7 +1862,7 @@ void CheckOther::functionVariableUsage()
 
             // pointer or reference declaration with initialization using constructor
             // int * i(j); int * k(i); static int * l(i);
-            else if (Token::Match(tok, "[;{}] static| const| %type% &|* %var% ( %any% ) ;") &&
+            else if (TOKEN_MATCH(tok, "[;{}] static| const| %type% &|* %var% ( %any% ) ;") &&
                      nextIsStandardTypeOrVoid(tok))
             {
                 Variables::VariableType type;
@@ -1883,7 +1883,7 @@ void CheckOther::functionVariableUsage()
                 unsigned int varid = 0;
 
                 // check for aliased variable
-                if (Token::Match(tok->tokAt(4), "%var%"))
+                if (TOKEN_MATCH(tok->tokAt(4), "%var%"))
                     varid = tok->tokAt(4)->varId();
 
                 variables.addVar(tok->tokAt(2), type, scope, true);
@@ -1913,7 +1913,7 @@ void CheckOther::functionVariableUsage()
 
             // array of pointer or reference declaration with possible initialization
             // int * p[10]; int * q[10] = { 0 }; static int * * r[10] = { 0 };
-            else if (Token::Match(tok, "[;{}] static| const| %type% *|& %var% [ %any% ] ;|="))
+            else if (TOKEN_MATCH(tok, "[;{}] static| const| %type% *|& %var% [ %any% ] ;|="))
             {
                 bool isStatic = false;
 
@@ -1944,7 +1944,7 @@ void CheckOther::functionVariableUsage()
 
             // array of pointer or reference of struct or union declaration with possible initialization
             // struct S * p[10]; struct T * q[10] = { 0 }; static struct S * r[10] = { 0 };
-            else if (Token::Match(tok, "[;{}] static| const| struct|union %type% *|& %var% [ %any% ] ;|="))
+            else if (TOKEN_MATCH(tok, "[;{}] static| const| struct|union %type% *|& %var% [ %any% ] ;|="))
             {
                 bool isStatic = false;
 
@@ -1971,9 +1971,9 @@ void CheckOther::functionVariableUsage()
             }
 
             // Freeing memory (not considered "using" the pointer if it was also allocated in this function)
-            else if (Token::Match(tok, "free|g_free|kfree|vfree ( %var% )") ||
-                     Token::Match(tok, "delete %var% ;") ||
-                     Token::Match(tok, "delete [ ] %var% ;"))
+            else if (TOKEN_MATCH(tok, "free|g_free|kfree|vfree ( %var% )") ||
+                     TOKEN_MATCH(tok, "delete %var% ;") ||
+                     TOKEN_MATCH(tok, "delete [ ] %var% ;"))
             {
                 unsigned int varid = 0;
                 if (tok->str() != "delete")
@@ -1999,12 +1999,12 @@ void CheckOther::functionVariableUsage()
                 }
             }
 
-            else if (Token::Match(tok, "return|throw %var%"))
+            else if (TOKEN_MATCH(tok, "return|throw %var%"))
                 variables.readAll(tok->next()->varId());
 
             // assignment
-            else if (Token::Match(tok, "*| (| ++|--| %var% ++|--| )| =") ||
-                     Token::Match(tok, "*| ( const| %type% *| ) %var% ="))
+            else if (TOKEN_MATCH(tok, "*| (| ++|--| %var% ++|--| )| =") ||
+                     TOKEN_MATCH(tok, "*| ( const| %type% *| ) %var% ="))
             {
                 bool dereference = false;
                 bool pre = false;
@@ -2016,19 +2016,19 @@ void CheckOther::functionVariableUsage()
                     tok = tok->next();
                 }
 
-                if (Token::Match(tok, "( const| %type% *| ) %var% ="))
+                if (TOKEN_MATCH(tok, "( const| %type% *| ) %var% ="))
                     tok = tok->link()->next();
 
                 else if (tok->str() == "(")
                     tok = tok->next();
 
-                if (Token::Match(tok, "++|--"))
+                if (TOKEN_MATCH(tok, "++|--"))
                 {
                     pre = true;
                     tok = tok->next();
                 }
 
-                if (Token::Match(tok->next(), "++|--"))
+                if (TOKEN_MATCH(tok->next(), "++|--"))
                     post = true;
 
                 const unsigned int varid1 = tok->varId();
@@ -2054,7 +2054,7 @@ void CheckOther::functionVariableUsage()
                     }
                     // Consider allocating memory separately because allocating/freeing alone does not constitute using the variable
                     else if (var && var->_type == Variables::pointer &&
-                             Token::Match(start, "%var% = new|malloc|calloc|g_malloc|kmalloc|vmalloc"))
+                             TOKEN_MATCH(start, "%var% = new|malloc|calloc|g_malloc|kmalloc|vmalloc"))
                     {
                         bool allocate = true;
 
@@ -2082,7 +2082,7 @@ void CheckOther::functionVariableUsage()
                         else
                             variables.write(varid1);
                     }
-                    else if (varid1 && Token::Match(tok, "%varid% .", varid1))
+                    else if (varid1 && TOKEN_MATCH_VARID(tok, "%varid% .", varid1))
                     {
                         variables.use(varid1);
                     }
@@ -2099,7 +2099,7 @@ void CheckOther::functionVariableUsage()
                             variables.writeAliases(tok->varId());
                             variables.read(tok->varId());
                         }
-                        else if (tok->varId() != varid1 && Token::Match(tok, "%var% ."))
+                        else if (tok->varId() != varid1 && TOKEN_MATCH(tok, "%var% ."))
                             variables.use(tok->varId());
                         else if (tok->varId() != varid1 &&
                                  var2->_type == Variables::standard &&
@@ -2110,7 +2110,7 @@ void CheckOther::functionVariableUsage()
 
                 const Token *equal = tok->next();
 
-                if (Token::Match(tok->next(), "[ %any% ]"))
+                if (TOKEN_MATCH(tok->next(), "[ %any% ]"))
                     equal = tok->tokAt(4);
 
                 // checked for chained assignments
@@ -2126,7 +2126,7 @@ void CheckOther::functionVariableUsage()
             }
 
             // assignment
-            else if (Token::Match(tok, "%var% [") && Token::Match(tok->next()->link(), "] ="))
+            else if (TOKEN_MATCH(tok, "%var% [") && TOKEN_MATCH(tok->next()->link(), "] ="))
             {
                 unsigned int varid = tok->varId();
                 const Variables::VariableUsage *var = variables.find(varid);
@@ -2135,7 +2135,7 @@ void CheckOther::functionVariableUsage()
                 {
                     // Consider allocating memory separately because allocating/freeing alone does not constitute using the variable
                     if (var->_type == Variables::pointer &&
-                        Token::Match(tok->next()->link(), "] = new|malloc|calloc|g_malloc|kmalloc|vmalloc"))
+                        TOKEN_MATCH(tok->next()->link(), "] = new|malloc|calloc|g_malloc|kmalloc|vmalloc"))
                     {
                         variables.allocateMemory(varid);
                     }
@@ -2149,45 +2149,45 @@ void CheckOther::functionVariableUsage()
                 }
             }
 
-            else if (Token::Match(tok, ">>|& %var%"))
+            else if (TOKEN_MATCH(tok, ">>|& %var%"))
                 variables.use(tok->next()->varId());    // use = read + write
-            else if (Token::Match(tok, "[;{}] %var% >>"))
+            else if (TOKEN_MATCH(tok, "[;{}] %var% >>"))
                 variables.use(tok->next()->varId());    // use = read + write
 
             // function parameter
-            else if (Token::Match(tok, "[(,] %var% ["))
+            else if (TOKEN_MATCH(tok, "[(,] %var% ["))
                 variables.use(tok->next()->varId());   // use = read + write
-            else if (Token::Match(tok, "[(,] %var% [,)]") && tok->previous()->str() != "*")
+            else if (TOKEN_MATCH(tok, "[(,] %var% [,)]") && tok->previous()->str() != "*")
                 variables.use(tok->next()->varId());   // use = read + write
-            else if (Token::Match(tok, "[(,] (") &&
-                     Token::Match(tok->next()->link(), ") %var% [,)]"))
+            else if (TOKEN_MATCH(tok, "[(,] (") &&
+                     TOKEN_MATCH(tok->next()->link(), ") %var% [,)]"))
                 variables.use(tok->next()->link()->next()->varId());   // use = read + write
 
             // function
-            else if (Token::Match(tok, "%var% ("))
+            else if (TOKEN_MATCH(tok, "%var% ("))
             {
                 variables.read(tok->varId());
-                if (Token::Match(tok->tokAt(2), "%var% ="))
+                if (TOKEN_MATCH(tok->tokAt(2), "%var% ="))
                     variables.read(tok->tokAt(2)->varId());
             }
 
-            else if (Token::Match(tok, "[{,] %var% [,}]"))
+            else if (TOKEN_MATCH(tok, "[{,] %var% [,}]"))
                 variables.read(tok->next()->varId());
 
-            else if (Token::Match(tok, "%var% ."))
+            else if (TOKEN_MATCH(tok, "%var% ."))
                 variables.use(tok->varId());   // use = read + write
 
-            else if ((Token::Match(tok, "[(=&!]") || isOp(tok)) &&
-                     (Token::Match(tok->next(), "%var%") && !Token::Match(tok->next(), "true|false|new")))
+            else if ((TOKEN_MATCH(tok, "[(=&!]") || isOp(tok)) &&
+                     (TOKEN_MATCH(tok->next(), "%var%") && !TOKEN_MATCH(tok->next(), "true|false|new")))
                 variables.readAll(tok->next()->varId());
 
-            else if (Token::Match(tok, "%var%") && (tok->next()->str() == ")" || isOp(tok->next())))
+            else if (TOKEN_MATCH(tok, "%var%") && (tok->next()->str() == ")" || isOp(tok->next())))
                 variables.readAll(tok->varId());
 
-            else if (Token::Match(tok, "; %var% ;"))
+            else if (TOKEN_MATCH(tok, "; %var% ;"))
                 variables.readAll(tok->next()->varId());
 
-            if (Token::Match(tok, "++|-- %var%"))
+            if (TOKEN_MATCH(tok, "++|-- %var%"))
             {
                 if (tok->strAt(-1) != ";")
                     variables.use(tok->next()->varId());
@@ -2195,7 +2195,7 @@ void CheckOther::functionVariableUsage()
                     variables.modified(tok->next()->varId());
             }
 
-            else if (Token::Match(tok, "%var% ++|--"))
+            else if (TOKEN_MATCH(tok, "%var% ++|--"))
             {
                 if (tok->strAt(-1) != ";")
                     variables.use(tok->varId());
@@ -2300,7 +2300,7 @@ void CheckOther::checkVariableScope()
             {
                 for (const Token *tok2 = tok; tok2; tok2 = tok2->next())
                 {
-                    if (tok2->str() == "{")
+                    if (tok2->kind() == Token::eOpenBrace)
                     {
                         tok = tok2->link();
                         break;
@@ -2314,11 +2314,11 @@ void CheckOther::checkVariableScope()
                     break;
             }
 
-            else if (tok->str() == "{")
+            else if (tok->kind() == Token::eOpenBrace)
             {
                 ++indentlevel;
             }
-            else if (tok->str() == "}")
+            else if (tok->kind() == Token::eCloseBrace)
             {
                 --indentlevel;
                 if (indentlevel == 0)
@@ -2379,7 +2379,7 @@ void CheckOther::lookupVar(const Token *tok1, const std::string &varname)
     bool for_or_while = false;  // is sub-scope a "for/while/etc". anything that is not "if"
     while (tok)
     {
-        if (tok->str() == "{")
+        if (tok->kind() == Token::eOpenBrace)
         {
             if (tok->strAt(-1) == "=")
             {
@@ -2394,7 +2394,7 @@ void CheckOther::lookupVar(const Token *tok1, const std::string &varname)
                 ++indentlevel;
         }
 
-        else if (tok->str() == "}")
+        else if (tok->kind() == Token::eCloseBrace)
         {
             if (indentlevel == 0)
                 break;
@@ -2573,7 +2573,7 @@ void CheckOther::checkStructMemberUsage()
                     break;
                 }
 
-                if (tok2->str() == "}")
+                if (tok2->kind() == Token::eCloseBrace)
                     break;
             }
 
@@ -2593,7 +2593,7 @@ void CheckOther::checkStructMemberUsage()
                 structname = "";
         }
 
-        if (tok->str() == "}")
+        if (tok->kind() == Token::eCloseBrace)
             structname.clear();
 
         if (!structname.empty() && Token::Match(tok, "[{;]"))
@@ -2667,10 +2667,10 @@ void CheckOther::checkCharVariable()
             int indentlevel = 0;
             for (const Token *tok2 = tok->next(); tok2; tok2 = tok2->next())
             {
-                if (tok2->str() == "{")
+                if (tok2->kind() == Token::eOpenBrace)
                     ++indentlevel;
 
-                else if (tok2->str() == "}")
+                else if (tok2->kind() == Token::eCloseBrace)
                 {
                     --indentlevel;
                     if (indentlevel <= 0)
@@ -2738,7 +2738,7 @@ void CheckOther::checkIncompleteStatement()
         else if (Token::simpleMatch(tok, "= {"))
             tok = tok->next()->link();
 
-        else if (tok->str() == "{" && Token::Match(tok->tokAt(-2), "%type% %var%"))
+        else if (tok->kind() == Token::eOpenBrace && Token::Match(tok->tokAt(-2), "%type% %var%"))
             tok = tok->link();
 
         else if (Token::Match(tok, "[;{}] %str%") || Token::Match(tok, "[;{}] %num%"))
@@ -2833,7 +2833,7 @@ void CheckOther::checkMathFunctions()
     {
         // case log(-2)
         if (tok->varId() == 0 &&
-            Token::Match(tok, "log|log10 ( %num% )") &&
+            TOKEN_MATCH(tok, "log|log10 ( %num% )") &&
             MathLib::isNegative(tok->tokAt(2)->str()) &&
             MathLib::isInt(tok->tokAt(2)->str()) &&
             MathLib::toLongNumber(tok->tokAt(2)->str()) <= 0)
@@ -2842,7 +2842,7 @@ void CheckOther::checkMathFunctions()
         }
         // case log(-2.0)
         else if (tok->varId() == 0 &&
-                 Token::Match(tok, "log|log10 ( %num% )") &&
+                 TOKEN_MATCH(tok, "log|log10 ( %num% )") &&
                  MathLib::isNegative(tok->tokAt(2)->str()) &&
                  MathLib::isFloat(tok->tokAt(2)->str()) &&
                  MathLib::toDoubleNumber(tok->tokAt(2)->str()) <= 0.)
@@ -2852,7 +2852,7 @@ void CheckOther::checkMathFunctions()
 
         // case log(0.0)
         else if (tok->varId() == 0 &&
-                 Token::Match(tok, "log|log10 ( %num% )") &&
+                 TOKEN_MATCH(tok, "log|log10 ( %num% )") &&
                  !MathLib::isNegative(tok->tokAt(2)->str()) &&
                  MathLib::isFloat(tok->tokAt(2)->str()) &&
                  MathLib::toDoubleNumber(tok->tokAt(2)->str()) <= 0.)
@@ -2862,7 +2862,7 @@ void CheckOther::checkMathFunctions()
 
         // case log(0)
         else if (tok->varId() == 0 &&
-                 Token::Match(tok, "log|log10 ( %num% )") &&
+                 TOKEN_MATCH(tok, "log|log10 ( %num% )") &&
                  !MathLib::isNegative(tok->tokAt(2)->str()) &&
                  MathLib::isInt(tok->tokAt(2)->str()) &&
                  MathLib::toLongNumber(tok->tokAt(2)->str()) <= 0)
@@ -2936,11 +2936,11 @@ void CheckOther::checkMisusedScopedObject()
 
         for (const Token *tok = scope->classStart; tok; tok = tok->next())
         {
-            if (tok->str() == "{")
+            if (tok->kind() == Token::eOpenBrace)
             {
                 ++depth;
             }
-            else if (tok->str() == "}")
+            else if (tok->kind() == Token::eCloseBrace)
             {
                 --depth;
                 if (depth == 0)
@@ -72,11 +72,11 @@ void CheckStl::iterators()
         for (const Token *tok2 = tok->tokAt(7); tok2; tok2 = tok2->next())
         {
             // If a { is found then count it and continue
-            if (tok2->str() == "{" && ++indent)
+            if (tok2->kind() == Token::eOpenBrace && ++indent)
                 continue;
 
             // If a } is found then count it. break if indentlevel becomes 0.
-            if (tok2->str() == "}" && --indent == 0)
+            if (tok2->kind() == Token::eCloseBrace && --indent == 0)
                 break;
 
             // Is iterator compared against different container?
@@ -240,9 +240,9 @@ void CheckStl::stlOutOfBounds()
 
                 for (const Token *tok3 = tok2->tokAt(8); tok3; tok3 = tok3->next())
                 {
-                    if (tok3->str() == "{")
+                    if (tok3->kind() == Token::eOpenBrace)
                         ++indent3;
-                    else if (tok3->str() == "}")
+                    else if (tok3->kind() == Token::eCloseBrace)
                     {
                         if (indent3 <= 1)
                             break;
@@ -494,9 +494,9 @@ void CheckStl::pushback()
             bool invalidPointer = false;
             for (const Token *tok2 = tok; indent >= 0 && tok2; tok2 = tok2->next())
             {
-                if (tok2->str() == "{" || tok2->str() == "(")
+                if (tok2->kind() == Token::eOpenBrace || tok2->str() == "(")
                     ++indent;
-                else if (tok2->str() == "}" || tok2->str() == ")")
+                else if (tok2->kind() == Token::eCloseBrace || tok2->str() == ")")
                 {
                     if (indent == 0 && Token::simpleMatch(tok2, ") {"))
                         tok2 = tok2->next();
@@ -561,9 +561,9 @@ void CheckStl::pushback()
         std::string invalidIterator;
         for (const Token *tok2 = tok; indent >= 0 && tok2; tok2 = tok2->next())
         {
-            if (tok2->str() == "{" || tok2->str() == "(")
+            if (tok2->kind() == Token::eOpenBrace || tok2->str() == "(")
                 ++indent;
-            else if (tok2->str() == "}" || tok2->str() == ")")
+            else if (tok2->kind() == Token::eCloseBrace || tok2->str() == ")")
             {
                 if (indent == 0 && Token::simpleMatch(tok2, ") {"))
                     tok2 = tok2->next();
@@ -590,9 +590,9 @@ void CheckStl::pushback()
                 unsigned int indent3 = 0;
                 for (const Token *tok3 = tok2->tokAt(20); tok3; tok3 = tok3->next())
                 {
-                    if (tok3->str() == "{")
+                    if (tok3->kind() == Token::eOpenBrace)
                         ++indent3;
-                    else if (tok3->str() == "}")
+                    else if (tok3->kind() == Token::eCloseBrace)
                     {
                         if (indent3 <= 1)
                             break;
@@ -701,9 +701,9 @@ void CheckStl::stlBoundries()
                 unsigned int indentlevel = 0;
                 for (const Token *tok2 = tok; tok2; tok2 = tok2->next())
                 {
-                    if (tok2->str() == "{")
+                    if (tok2->kind() == Token::eOpenBrace)
                         ++indentlevel;
-                    else if (tok2->str() == "}")
+                    else if (tok2->kind() == Token::eCloseBrace)
                     {
                         if (indentlevel == 0)
                             break;
@@ -887,7 +887,7 @@ void CheckStl::redundantCondition()
     const Token *tok = Token::findmatch(_tokenizer->tokens(), pattern);
     while (tok)
     {
-        bool b(tok->tokAt(15)->str() == "{");
+        bool b(tok->tokAt(15)->kind() == Token::eOpenBrace);
 
         // Get tokens for the fields %var% and %any%
         const Token *var1 = tok->tokAt(2);
@@ -957,9 +957,9 @@ void CheckStl::missingComparison()
                 // Parse loop..
                 for (const Token *tok3 = tok2->tokAt(20); tok3; tok3 = tok3->next())
                 {
-                    if (tok3->str() == "{")
+                    if (tok3->kind() == Token::eOpenBrace)
                         ++indentlevel;
-                    else if (tok3->str() == "}")
+                    else if (tok3->kind() == Token::eCloseBrace)
                     {
                         if (indentlevel == 0)
                             break;
@@ -1010,9 +1010,9 @@ void CheckStl::string_c_str()
             unsigned int indentlevel = 0;
             while (NULL != (tok = tok->next()))
             {
-                if (tok->str() == "{")
+                if (tok->kind() == Token::eOpenBrace)
                     ++indentlevel;
-                else if (tok->str() == "}")
+                else if (tok->kind() == Token::eCloseBrace)
                 {
                     if (indentlevel <= 1)
                         break;
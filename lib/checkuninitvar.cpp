@@ -584,7 +584,7 @@ private:
             }
         }
 
-        if (Token::Match(&tok, "%var% (") && uvarFunctions.find(tok.str()) == uvarFunctions.end())
+        if (Token::Match(&tok, "%var% (") && !isUvarFunction(tok.str()))
         {
             // sizeof/typeof doesn't dereference. A function name that is all uppercase
             // might be an unexpanded macro that uses sizeof/typeof
@@ -866,9 +866,9 @@ private:
                     unsigned int indentlevel = 0;
                     for (const Token *tok3 = tok2->tokAt(5); tok3; tok3 = tok3->next())
                     {
-                        if (tok3->str() == "{")
+                        if (tok3->kind() == Token::eOpenBrace)
                             ++indentlevel;
-                        else if (tok3->str() == "}")
+                        else if (tok3->kind() == Token::eCloseBrace)
                         {
                             if (indentlevel == 0)
                                 break;
@@ -928,7 +928,7 @@ private:
     {
         while (tok)
         {
-            if (tok->str() == "{" || tok->str() == "}" || tok->str() == "for")
+            if (tok->kind() == Token::eOpenBrace || tok->kind() == Token::eCloseBrace || tok->str() == "for")
                 return;
             if (Token::simpleMatch(tok, "if ("))
             {
@@ -955,14 +955,23 @@ private:
 
 public:
 
-    /** Functions that don't handle uninitialized variables well */
+    /**
+     * Functions that don't handle uninitialized variables well. It is
+     * only written when the files are checked by a single thread
+     * (_jobs == 1), the -j worker threads only read it.
+     */
     static std::set<std::string> uvarFunctions;
 
+    static bool isUvarFunction(const std::string &name)
+    {
+        return uvarFunctions.find(name) != uvarFunctions.end();
+    }
+
     static void analyseFunctions(const Token * const tokens, std::set<std::string> &func)
     {
         for (const Token *tok = tokens; tok; tok = tok->next())
         {
-            if (tok->str() == "{")
+            if (tok->kind() == Token::eOpenBrace)
             {
                 tok = tok->link();
                 continue;
@@ -994,9 +1003,9 @@ public:
                         unsigned int indentlevel = 0;
                         for (const Token *tok3 = tok2; tok3; tok3 = tok3->next())
                         {
-                            if (tok3->str() == "{")
+                            if (tok3->kind() == Token::eOpenBrace)
                                 ++indentlevel;
-                            else if (tok3->str() == "}")
+                            else if (tok3->kind() == Token::eCloseBrace)
                             {
                                 if (indentlevel <= 1)
                                     break;
@@ -1075,7 +1084,11 @@ void CheckUninitVar::executionPaths()
     {
         // no writing if multiple threads are used (TODO: thread safe analysis?)
         if (_settings->_jobs == 1)
-            UninitVar::analyseFunctions(_tokenizer->tokens(), UninitVar::uvarFunctions);
+        {
+            std::set<std::string> functions;
+            UninitVar::analyseFunctions(_tokenizer->tokens(), functions);
+            saveAnalysisData(functions);
+        }
 
         UninitVar c(this);
         checkExecutionPaths(_tokenizer->tokens(), &c);
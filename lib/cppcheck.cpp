@@ -35,18 +35,15 @@
 #include <pcre.h>
 #endif
 
-static TimerResults S_timerResults;
-
 CppCheck::CppCheck(ErrorLogger &errorLogger, bool useGlobalSuppressions)
-    : _useGlobalSuppressions(useGlobalSuppressions), _errorLogger(errorLogger)
+    : _useGlobalSuppressions(useGlobalSuppressions), _errorLogger(errorLogger),
+      _splitConfigurations(false), _tooManyConfigurations(false)
 {
     exitcode = 0;
 }
 
 CppCheck::~CppCheck()
 {
-    if (_settings._showtime != SHOWTIME_NONE)
-        S_timerResults.ShowResults();
 }
 
 void CppCheck::settings(const Settings &currentSettings)
@@ -116,6 +113,12 @@ unsigned int CppCheck::check()
             _errorLogger.reportOut(std::string("Checking ") + fixedpath + std::string("..."));
         }
 
+        const double fileStart = (_settings._showtime != SHOWTIME_NONE) ? Timer::now() : 0.0;
+
+        _remainingConfigurations.clear();
+        _preprocessedCode.clear();
+        _tooManyConfigurations = false;
+
         try
         {
             Preprocessor preprocessor(&_settings, this);
@@ -132,7 +135,7 @@ unsigned int CppCheck::check()
             {
                 // Only file name was given, read the content from file
                 std::ifstream fin(fname.c_str());
-                Timer t("Preprocessor::preprocess", _settings._showtime, &S_timerResults);
+                Timer t("Preprocessor::preprocess", _settings._showtime, &_timerResults);
                 preprocessor.preprocess(fin, filedata, configurations, fname, _settings._includePaths);
             }
 
@@ -144,6 +147,15 @@ unsigned int CppCheck::check()
                 configurations.push_back(_settings.userDefines);
             }
 
+            // Inline suppressions and unmatched suppressions of the file
+            // need all configurations to be checked by this instance
+            const bool split = _splitConfigurations &&
+                               !_settings._inlineSuppressions &&
+                               _settings.nomsg.getUnmatchedLocalSuppressions(fname).empty();
+
+            // Parse the #if blocks once for all configurations
+            const ConditionalCode code(filedata, &_settings);
+
             int checkCount = 0;
             for (std::list<std::string>::const_iterator it = configurations.begin(); it != configurations.end(); ++it)
             {
@@ -151,44 +163,22 @@ unsigned int CppCheck::check()
                 // was used.
                 if (!_settings._force && checkCount > 11)
                 {
-                    const std::string fixedpath = Path::toNativeSeparators(fname);
-                    ErrorLogger::ErrorMessage::FileLocation location;
-                    location.setfile(fixedpath);
-                    std::list<ErrorLogger::ErrorMessage::FileLocation> loclist;
-                    loclist.push_back(location);
-                    const std::string msg("Interrupted checking because of too many #ifdef configurations.\n"
-                                          "The checking of the file was interrupted because there were too many "
-                                          "#ifdef configurations. Checking of all #ifdef configurations can be forced "
-                                          "by --force command line option or from GUI preferences. However that may "
-                                          "increase the checking time.");
-                    ErrorLogger::ErrorMessage errmsg(loclist,
-                                                     Severity::information,
-                                                     msg,
-                                                     "toomanyconfigs");
-                    _errorLogger.reportErr(errmsg);
+                    if (_remainingConfigurations.empty())
+                        reportTooManyConfigurations(fname);
+                    else
+                        _tooManyConfigurations = true;
                     break;
                 }
 
-                cfg = *it;
-                Timer t("Preprocessor::getcode", _settings._showtime, &S_timerResults);
-                const std::string codeWithoutCfg = Preprocessor::getcode(filedata, *it, fname, &_settings, &_errorLogger);
-                t.Stop();
-
-                // If only errors are printed, print filename after the check
-                if (_settings._errorsOnly == false && it != configurations.begin())
-                {
-                    std::string fixedpath = Path::simplifyPath(fname.c_str());
-                    fixedpath = Path::toNativeSeparators(fixedpath);
-                    _errorLogger.reportOut(std::string("Checking ") + fixedpath + ": " + cfg + std::string("..."));
-                }
-
-                std::string appendCode = _settings.append();
-                if (!appendCode.empty())
-                    Preprocessor::preprocessWhitespaces(appendCode);
-
-                checkFile(codeWithoutCfg + appendCode, _filenames[c].c_str());
+                if (split && it != configurations.begin())
+                    _remainingConfigurations.push_back(*it);
+                else
+                    checkPreprocessed(fname, code, *it, it == configurations.begin());
                 ++checkCount;
             }
+
+            if (!_remainingConfigurations.empty())
+                _preprocessedCode.swap(filedata);
         }
         catch (std::runtime_error &e)
         {
@@ -197,6 +187,9 @@ unsigned int CppCheck::check()
             _errorLogger.reportOut("Bailing out from checking " + fixedpath + ": " + e.what());
         }
 
+        if (_settings._showtime != SHOWTIME_NONE && _settings._showtime != SHOWTIME_FILE)
+            _timerResults.AddFileResults(fname, Timer::now() - fileStart);
+
         reportUnmatchedSuppressions(_settings.nomsg.getUnmatchedLocalSuppressions(fname));
 
         _errorLogger.reportStatus(c + 1, (unsigned int)_filenames.size());
@@ -219,6 +212,72 @@ unsigned int CppCheck::check()
     return exitcode;
 }
 
+unsigned int CppCheck::checkConfiguration(const std::string &filename, const std::string &filedata, const std::string &configuration, bool interrupted)
+{
+    exitcode = 0;
+
+    // Only files with several configurations are split
+    _settings.ifcfg = true;
+
+    try
+    {
+        checkPreprocessed(filename, ConditionalCode(filedata, &_settings), configuration, false);
+    }
+    catch (std::runtime_error &e)
+    {
+        // Exception was thrown when checking this file..
+        const std::string fixedpath = Path::toNativeSeparators(filename);
+        _errorLogger.reportOut("Bailing out from checking " + fixedpath + ": " + e.what());
+    }
+
+    if (interrupted)
+        reportTooManyConfigurations(filename);
+
+    _errorList.clear();
+    return exitcode;
+}
+
+void CppCheck::checkPreprocessed(const std::string &filename, const ConditionalCode &code, const std::string &configuration, bool first)
+{
+    cfg = configuration;
+    Timer t("Preprocessor::getcode", _settings._showtime, &_timerResults);
+    const std::string codeWithoutCfg = code.getcode(configuration, filename, &_settings, &_errorLogger);
+    t.Stop();
+
+    // If only errors are printed, print filename after the check
+    if (_settings._errorsOnly == false && !first)
+    {
+        std::string fixedpath = Path::simplifyPath(filename.c_str());
+        fixedpath = Path::toNativeSeparators(fixedpath);
+        _errorLogger.reportOut(std::string("Checking ") + fixedpath + ": " + cfg + std::string("..."));
+    }
+
+    std::string appendCode = _settings.append();
+    if (!appendCode.empty())
+        Preprocessor::preprocessWhitespaces(appendCode);
+
+    checkFile(codeWithoutCfg + appendCode, filename.c_str());
+}
+
+void CppCheck::reportTooManyConfigurations(const std::string &filename)
+{
+    const std::string fixedpath = Path::toNativeSeparators(filename);
+    ErrorLogger::ErrorMessage::FileLocation location;
+    location.setfile(fixedpath);
+    std::list<ErrorLogger::ErrorMessage::FileLocation> loclist;
+    loclist.push_back(location);
+    const std::string msg("Interrupted checking because of too many #ifdef configurations.\n"
+                          "The checking of the file was interrupted because there were too many "
+                          "#ifdef configurations. Checking of all #ifdef configurations can be forced "
+                          "by --force command line option or from GUI preferences. However that may "
+                          "increase the checking time.");
+    ErrorLogger::ErrorMessage errmsg(loclist,
+                                     Severity::information,
+                                     msg,
+                                     "toomanyconfigs");
+    _errorLogger.reportErr(errmsg);
+}
+
 void CppCheck::analyseFile(std::istream &fin, const std::string &filename)
 {
     // Preprocess file..
@@ -260,12 +319,13 @@ void CppCheck::checkFile(const std::string &code, const char FileName[])
         return;
 
     Tokenizer _tokenizer(&_settings, this);
+    _tokenizer.setTimerResults(&_timerResults);
     bool result;
 
     // Tokenize the file
     std::istringstream istr(code);
 
-    Timer timer("Tokenizer::tokenize", _settings._showtime, &S_timerResults);
+    Timer timer("Tokenizer::tokenize", _settings._showtime, &_timerResults);
     result = _tokenizer.tokenize(istr, FileName, cfg);
     timer.Stop();
     if (!result)
@@ -274,7 +334,7 @@ void CppCheck::checkFile(const std::string &code, const char FileName[])
         return;
     }
 
-    Timer timer2("Tokenizer::fillFunctionList", _settings._showtime, &S_timerResults);
+    Timer timer2("Tokenizer::fillFunctionList", _settings._showtime, &_timerResults);
     _tokenizer.fillFunctionList();
     timer2.Stop();
 
@@ -284,17 +344,17 @@ void CppCheck::checkFile(const std::string &code, const char FileName[])
         if (_settings.terminated())
             return;
 
-        Timer timerRunChecks((*it)->name() + "::runChecks", _settings._showtime, &S_timerResults);
+        Timer timerRunChecks((*it)->name() + "::runChecks", _settings._showtime, &_timerResults);
         (*it)->runChecks(&_tokenizer, &_settings, this);
     }
 
-    Timer timer3("Tokenizer::simplifyTokenList", _settings._showtime, &S_timerResults);
+    Timer timer3("Tokenizer::simplifyTokenList", _settings._showtime, &_timerResults);
     result = _tokenizer.simplifyTokenList();
     timer3.Stop();
     if (!result)
         return;
 
-    Timer timer4("Tokenizer::fillFunctionList", _settings._showtime, &S_timerResults);
+    Timer timer4("Tokenizer::fillFunctionList", _settings._showtime, &_timerResults);
     _tokenizer.fillFunctionList();
     timer4.Stop();
 
@@ -307,7 +367,7 @@ void CppCheck::checkFile(const std::string &code, const char FileName[])
         if (_settings.terminated())
             return;
 
-        Timer timerSimpleChecks((*it)->name() + "::runSimplifiedChecks", _settings._showtime, &S_timerResults);
+        Timer timerSimpleChecks((*it)->name() + "::runSimplifiedChecks", _settings._showtime, &_timerResults);
         (*it)->runSimplifiedChecks(&_tokenizer, &_settings, this);
     }
 
@@ -396,12 +456,6 @@ Settings &CppCheck::settings()
 
 void CppCheck::reportErr(const ErrorLogger::ErrorMessage &msg)
 {
-    std::string errmsg = msg.toString(_settings._verbose);
-
-    // Alert only about unique errors
-    if (std::find(_errorList.begin(), _errorList.end(), errmsg) != _errorList.end())
-        return;
-
     std::string file;
     unsigned int line(0);
     if (!msg._callStack.empty())
@@ -424,8 +478,11 @@ void CppCheck::reportErr(const ErrorLogger::ErrorMessage &msg)
     if (!_settings.nofail.isSuppressed(msg._id, file, line))
         exitcode = 1;
 
-    _errorList.push_back(errmsg);
-    std::string errmsg2(errmsg);
+    // Alert only about unique errors
+    if (!_errorList.insert(msg, _settings._verbose))
+        return;
+
+    std::string errmsg2(msg.toString(_settings._verbose));
     if (_settings._verbose)
     {
         errmsg2 += "\n    Defines=\'" + cfg + "\'\n";
@@ -22,12 +22,15 @@
 #include "settings.h"
 #include "errorlogger.h"
 #include "checkunusedfunctions.h"
+#include "timer.h"
 
 #include <string>
 #include <list>
 #include <sstream>
 #include <vector>
 
+class ConditionalCode;
+
 /// @addtogroup Core
 /// @{
 
@@ -102,6 +105,14 @@ public:
 
     const std::vector<std::string> &filenames() const;
 
+    /**
+     * @brief Results of the timers, when --showtime is used
+     */
+    const TimerResults &timerResults() const
+    {
+        return _timerResults;
+    }
+
     virtual void reportStatus(unsigned int index, unsigned int max);
 
     /**
@@ -118,6 +129,56 @@ public:
      */
     void getErrorMessages();
 
+    /**
+     * @brief Check only the first configuration of the files. The other
+     * configurations are kept so that they can be checked with
+     * checkConfiguration(), possibly by other CppCheck instances.
+     * Files with inline suppressions or suppressions for the file are not
+     * split.
+     */
+    void splitConfigurations(bool split)
+    {
+        _splitConfigurations = split;
+    }
+
+    /**
+     * @brief The configurations of the last checked file that were not
+     * checked, see splitConfigurations().
+     */
+    const std::list<std::string> &remainingConfigurations() const
+    {
+        return _remainingConfigurations;
+    }
+
+    /**
+     * @brief The preprocessed code of the last checked file, if it has
+     * remaining configurations.
+     */
+    const std::string &preprocessedCode() const
+    {
+        return _preprocessedCode;
+    }
+
+    /**
+     * @brief Were there more configurations than are checked? Then the
+     * last remaining configuration should be checked as interrupted.
+     */
+    bool tooManyConfigurations() const
+    {
+        return _tooManyConfigurations;
+    }
+
+    /**
+     * @brief Check a remaining configuration of a file.
+     * @param filename the file
+     * @param filedata the preprocessed code, see preprocessedCode()
+     * @param configuration the configuration to check
+     * @param interrupted report that the checking of the file was
+     * interrupted because of too many configurations
+     * @return 1 if errors were found, otherwise 0
+     */
+    unsigned int checkConfiguration(const std::string &filename, const std::string &filedata, const std::string &configuration, bool interrupted);
+
     /**
      * @brief Analyse file - It's public so unit tests can be written
      */
@@ -127,6 +188,12 @@ private:
     /** @brief Check file */
     void checkFile(const std::string &code, const char FileName[]);
 
+    /** @brief Check a configuration of preprocessed code */
+    void checkPreprocessed(const std::string &filename, const ConditionalCode &code, const std::string &configuration, bool first);
+
+    /** @brief Report that there are too many configurations to check them all */
+    void reportTooManyConfigurations(const std::string &filename);
+
     /**
      * @brief Errors and warnings are directed here.
      *
@@ -144,7 +211,9 @@ private:
     virtual void reportOut(const std::string &outmsg);
 
     unsigned int exitcode;
-    std::list<std::string> _errorList;
+
+    /** @brief The messages that have been reported for the file */
+    ErrorMessageSet _errorList;
     std::ostringstream _errout;
     Settings _settings;
     bool _useGlobalSuppressions;
@@ -160,6 +229,15 @@ private:
 
     /** @brief Current preprocessor configuration */
     std::string     cfg;
+
+    /** @brief Results of the timers, see --showtime */
+    TimerResults _timerResults;
+
+    /** @brief See splitConfigurations() */
+    bool _splitConfigurations;
+    std::list<std::string> _remainingConfigurations;
+    std::string _preprocessedCode;
+    bool _tooManyConfigurations;
 };
 
 /// @}
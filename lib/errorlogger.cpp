@@ -20,6 +20,7 @@
 #include "path.h"
 #include "cppcheck.h"
 
+#include <cstring>
 #include <sstream>
 #include <vector>
 
@@ -62,86 +63,94 @@ void ErrorLogger::ErrorMessage::setmsg(const std::string &msg)
     }
 }
 
+// The serialized message is binary. The numbers are in the byte order
+// of the machine, the message is only passed between the processes of
+// one cppcheck run.
+static void appendNumber(std::string &data, unsigned int number)
+{
+    data.append(reinterpret_cast<const char *>(&number), sizeof(number));
+}
+
+static void appendString(std::string &data, const std::string &str)
+{
+    appendNumber(data, (unsigned int)str.size());
+    data.append(str);
+}
+
+static bool readNumber(const char *&pos, const char *end, unsigned int &number)
+{
+    if ((std::size_t)(end - pos) < sizeof(number))
+        return false;
+    std::memcpy(&number, pos, sizeof(number));
+    pos += sizeof(number);
+    return true;
+}
+
+static bool readString(const char *&pos, const char *end, std::string &str)
+{
+    unsigned int len = 0;
+    if (!readNumber(pos, end, len) || (std::size_t)(end - pos) < len)
+        return false;
+    str.assign(pos, len);
+    pos += len;
+    return true;
+}
+
 std::string ErrorLogger::ErrorMessage::serialize() const
 {
-    // Serialize this message into a simple string
-    std::ostringstream oss;
-    oss << _id.length() << " " << _id;
-    oss << Severity::toString(_severity).length() << " " << Severity::toString(_severity);
-    oss << _shortMessage.length() << " " << _shortMessage;
-    oss << _verboseMessage.length() << " " << _verboseMessage;
-    oss << _callStack.size() << " ";
+    std::string data;
+    data.reserve(64 + _id.size() + _shortMessage.size() + _verboseMessage.size());
+    appendString(data, _id);
+    appendNumber(data, (unsigned int)_severity);
+    appendString(data, _shortMessage);
+    appendString(data, _verboseMessage);
+    appendNumber(data, (unsigned int)_callStack.size());
 
     for (std::list<ErrorLogger::ErrorMessage::FileLocation>::const_iterator tok = _callStack.begin(); tok != _callStack.end(); ++tok)
     {
-        std::ostringstream smallStream;
-        smallStream << (*tok).line << ":" << (*tok).getfile();
-        oss << smallStream.str().length() << " " << smallStream.str();
+        appendNumber(data, (*tok).line);
+        appendString(data, (*tok).getfile());
     }
 
-    return oss.str();
+    return data;
 }
 
 bool ErrorLogger::ErrorMessage::deserialize(const std::string &data)
 {
-    _callStack.clear();
-    std::istringstream iss(data);
-    std::vector<std::string> results;
-    while (iss.good())
-    {
-        unsigned int len = 0;
-        if (!(iss >> len))
-            return false;
+    return deserialize(data.data(), data.size());
+}
 
-        iss.get();
-        std::string temp;
-        for (unsigned int i = 0; i < len && iss.good(); ++i)
-        {
-            char c = static_cast<char>(iss.get());
-            temp.append(1, c);
-        }
+bool ErrorLogger::ErrorMessage::deserialize(const char data[], std::size_t size)
+{
+    _callStack.clear();
 
-        results.push_back(temp);
-        if (results.size() == 4)
-            break;
-    }
+    const char *pos = data;
+    const char * const end = data + size;
 
-    _id = results[0];
-    _severity = Severity::fromString(results[1]);
-    _shortMessage = results[2];
-    _verboseMessage = results[3];
+    unsigned int severity = 0;
+    if (!readString(pos, end, _id) ||
+        !readNumber(pos, end, severity) ||
+        severity > Severity::debug ||
+        !readString(pos, end, _shortMessage) ||
+        !readString(pos, end, _verboseMessage))
+        return false;
+    _severity = static_cast<Severity::SeverityType>(severity);
 
     unsigned int stackSize = 0;
-    if (!(iss >> stackSize))
+    if (!readNumber(pos, end, stackSize))
         return false;
 
-    while (iss.good())
+    std::string file;
+    for (unsigned int i = 0; i < stackSize; ++i)
     {
-        unsigned int len = 0;
-        if (!(iss >> len))
-            return false;
-
-        iss.get();
-        std::string temp;
-        for (unsigned int i = 0; i < len && iss.good(); ++i)
-        {
-            char c = static_cast<char>(iss.get());
-            temp.append(1, c);
-        }
-
         ErrorLogger::ErrorMessage::FileLocation loc;
-        loc.setfile(temp.substr(temp.find(':') + 1));
-        temp = temp.substr(0, temp.find(':'));
-        std::istringstream fiss(temp);
-        fiss >> loc.line;
-
+        if (!readNumber(pos, end, loc.line) || !readString(pos, end, file))
+            return false;
+        loc.setfile(file);
         _callStack.push_back(loc);
-
-        if (_callStack.size() >= stackSize)
-            break;
     }
 
-    return true;
+    return pos == end;
 }
 
 std::string ErrorLogger::ErrorMessage::getXMLHeader(int xml_version)
@@ -301,6 +310,88 @@ void ErrorLogger::reportUnmatchedSuppressions(const std::list<Settings::Suppress
     }
 }
 
+ErrorMessageSet::ErrorMessageSet()
+    : _buckets(64), _size(0)
+{
+}
+
+/** FNV-1a hash of a string, continuing from hash */
+static unsigned int hashString(unsigned int hash, const std::string &str)
+{
+    for (std::string::size_type i = 0; i < str.size(); ++i)
+        hash = (hash ^ (unsigned char)str[i]) * 16777619U;
+    return hash;
+}
+
+static unsigned int hashNumber(unsigned int hash, unsigned int number)
+{
+    return (hash ^ number) * 16777619U;
+}
+
+bool ErrorMessageSet::Entry::operator==(const Entry &other) const
+{
+    return hash == other.hash &&
+           severity == other.severity &&
+           locations == other.locations &&
+           message == other.message;
+}
+
+bool ErrorMessageSet::insert(const ErrorLogger::ErrorMessage &msg, bool verbose)
+{
+    Entry entry;
+    entry.severity = msg._severity;
+    entry.message = verbose ? msg.verboseMessage() : msg.shortMessage();
+    entry.locations.reserve(msg._callStack.size());
+
+    unsigned int hash = hashNumber(2166136261U, (unsigned int)entry.severity);
+    for (std::list<ErrorLogger::ErrorMessage::FileLocation>::const_iterator it = msg._callStack.begin(); it != msg._callStack.end(); ++it)
+    {
+        entry.locations.push_back(std::make_pair(it->getfile(), it->line));
+        hash = hashNumber(hashString(hash, entry.locations.back().first), it->line);
+    }
+    entry.hash = hashString(hash, entry.message);
+
+    Bucket &bucket = _buckets[entry.hash & (_buckets.size() - 1)];
+    for (Bucket::const_iterator it = bucket.begin(); it != bucket.end(); ++it)
+    {
+        if (*it == entry)
+            return false;
+    }
+
+    bucket.push_back(Entry());
+    std::swap(bucket.back().locations, entry.locations);
+    std::swap(bucket.back().message, entry.message);
+    bucket.back().hash = entry.hash;
+    bucket.back().severity = entry.severity;
+
+    if (++_size > _buckets.size())
+        grow();
+    return true;
+}
+
+void ErrorMessageSet::grow()
+{
+    std::vector<Bucket> buckets(_buckets.size() * 2);
+    for (std::vector<Bucket>::iterator b = _buckets.begin(); b != _buckets.end(); ++b)
+    {
+        // Move the entries without copying them
+        while (!b->empty())
+        {
+            Bucket &to = buckets[b->front().hash & (buckets.size() - 1)];
+            to.splice(to.end(), *b, b->begin());
+        }
+    }
+    _buckets.swap(buckets);
+}
+
+void ErrorMessageSet::clear()
+{
+    if (_size == 0)
+        return;
+    _buckets.assign(64, Bucket());
+    _size = 0;
+}
+
 std::string ErrorLogger::callStackToString(const std::list<ErrorLogger::ErrorMessage::FileLocation> &callStack)
 {
     std::ostringstream ostr;
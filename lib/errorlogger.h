@@ -22,6 +22,7 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include "settings.h"
 
@@ -154,9 +155,24 @@ public:
          */
         std::string toString(bool verbose, const std::string &outputFormat = "") const;
 
+        /**
+         * Serialize the message so that it can be passed to another
+         * process of the same cppcheck run. The format is binary.
+         */
         std::string serialize() const;
+
+        /** Read a message that was serialized with serialize() */
         bool deserialize(const std::string &data);
 
+        /**
+         * Read a message that was serialized with serialize(), directly
+         * from a buffer
+         * @param data the serialized message
+         * @param size size of the serialized message
+         * @return false if the data is not a serialized message
+         */
+        bool deserialize(const char data[], std::size_t size);
+
         std::list<FileLocation> _callStack;
         Severity::SeverityType _severity;
         std::string _id;
@@ -220,7 +236,8 @@ public:
      * Information about how many files have been checked
      *
      * @param index This many files have been checked.
-     * @param max This many files there are in total.
+     * @param max This many files there are in total, 0 if that is not
+     * known yet because more files are being searched.
      */
     virtual void reportStatus(unsigned int index, unsigned int max) = 0;
 
@@ -246,6 +263,55 @@ public:
     static std::string callStackToString(const std::list<ErrorLogger::ErrorMessage::FileLocation> &callStack);
 };
 
+/**
+ * @brief The error messages that have been reported, so that each
+ * message is reported only once.
+ *
+ * Two messages are the same if they would be written as the same text:
+ * same locations, severity and message. The messages are not formatted,
+ * they are found with a hash of these fields.
+ */
+class ErrorMessageSet
+{
+public:
+    ErrorMessageSet();
+
+    /**
+     * Add a message
+     * @param msg the message
+     * @param verbose compare the verbose messages instead of the short ones
+     * @return true if the message was added, false if it is already in the set
+     */
+    bool insert(const ErrorLogger::ErrorMessage &msg, bool verbose);
+
+    void clear();
+
+    std::size_t size() const
+    {
+        return _size;
+    }
+
+private:
+    /** The fields of a message that are compared */
+    struct Entry
+    {
+        unsigned int hash;
+        std::vector<std::pair<std::string, unsigned int> > locations;
+        Severity::SeverityType severity;
+        std::string message;
+
+        bool operator==(const Entry &other) const;
+    };
+
+    typedef std::list<Entry> Bucket;
+
+    /** Double the number of buckets */
+    void grow();
+
+    std::vector<Bucket> _buckets;
+    std::size_t _size;
+};
+
 
 /// @}
 
@@ -150,7 +150,7 @@ void ExecutionPath::checkScope(const Token *tok, std::list<ExecutionPath *> &che
     {
         // might be a noreturn function..
         if (Token::simpleMatch(tok->tokAt(-2), ") ; }") &&
-            Token::Match(tok->tokAt(-2)->link()->tokAt(-2), "[;{}] %var% (") &&
+            TOKEN_MATCH(tok->tokAt(-2)->link()->tokAt(-2), "[;{}] %var% (") &&
             tok->tokAt(-2)->link()->previous()->varId() == 0)
         {
             ExecutionPath::bailOut(checks);
@@ -184,7 +184,7 @@ void ExecutionPath::checkScope(const Token *tok, std::list<ExecutionPath *> &che
         }
 
         // goto/setjmp/longjmp => bailout
-        if (Token::Match(tok, "goto|setjmp|longjmp"))
+        if (TOKEN_MATCH(tok, "goto|setjmp|longjmp"))
         {
             ExecutionPath::bailOut(checks);
             return;
@@ -244,7 +244,7 @@ void ExecutionPath::checkScope(const Token *tok, std::list<ExecutionPath *> &che
         }
 
         // for/while/switch/do .. bail out
-        if (Token::Match(tok, "for|while|switch|do"))
+        if (TOKEN_MATCH(tok, "for|while|switch|do"))
         {
             // goto {
             const Token *tok2 = tok->next();
@@ -363,14 +363,14 @@ void ExecutionPath::checkScope(const Token *tok, std::list<ExecutionPath *> &che
             return;
         }
 
-        if (Token::Match(tok, "abort|exit ("))
+        if (TOKEN_MATCH(tok, "abort|exit ("))
         {
             ExecutionPath::bailOut(checks);
             return;
         }
 
         // don't parse into "struct type { .."
-        if (Token::Match(tok, "struct|union|class %type% {|:"))
+        if (TOKEN_MATCH(tok, "struct|union|class %type% {|:"))
         {
             while (tok && tok->str() != "{" && tok->str() != ";")
                 tok = tok->next();
@@ -401,7 +401,7 @@ void ExecutionPath::checkScope(const Token *tok, std::list<ExecutionPath *> &che
         }
 
         // ; { ... }
-        if (Token::Match(tok->previous(), "[;{}] {"))
+        if (TOKEN_MATCH(tok->previous(), "[;{}] {"))
         {
             ExecutionPath::checkScope(tok->next(), checks);
             tok = tok->link();
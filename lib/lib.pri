@@ -1,6 +1,7 @@
 # no manual edits - this file is autogenerated by dmake
 
 LIBS += -L../externals -lpcre
+unix:LIBS += -lpthread
 INCLUDEPATH += ../externals ../externals/tinyxml
 HEADERS += $${BASEPATH}check.h \
            $${BASEPATH}checkautovariables.h \
@@ -23,6 +24,7 @@ HEADERS += $${BASEPATH}check.h \
            $${BASEPATH}preprocessor.h \
            $${BASEPATH}settings.h \
            $${BASEPATH}symboldatabase.h \
+           $${BASEPATH}threading.h \
            $${BASEPATH}timer.h \
            $${BASEPATH}token.h \
            $${BASEPATH}tokenize.h
@@ -47,6 +49,7 @@ SOURCES += $${BASEPATH}checkautovariables.cpp \
            $${BASEPATH}preprocessor.cpp \
            $${BASEPATH}settings.cpp \
            $${BASEPATH}symboldatabase.cpp \
+           $${BASEPATH}threading.cpp \
            $${BASEPATH}timer.cpp \
            $${BASEPATH}token.cpp \
            $${BASEPATH}tokenize.cpp
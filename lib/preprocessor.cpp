@@ -23,6 +23,7 @@
 #include "path.h"
 #include "errorlogger.h"
 #include "settings.h"
+#include "threading.h"
 
 #include <algorithm>
 #include <stdexcept>
@@ -34,6 +35,22 @@
 #include <vector>
 #include <set>
 #include <stack>
+#include <map>
+#include <list>
+#include <iterator>
+#include <climits>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 Preprocessor::Preprocessor(Settings *settings, ErrorLogger *errorLogger) : _settings(settings), _errorLogger(errorLogger)
 {
@@ -56,21 +73,6 @@ void Preprocessor::writeError(const std::string &fileName, const unsigned int li
                            errorType));
 }
 
-static unsigned char readChar(std::istream &istr)
-{
-    unsigned char ch = (unsigned char)istr.get();
-
-    // Handling of newlines..
-    if (ch == '\r')
-    {
-        ch = '\n';
-        if ((char)istr.peek() == '\n')
-            (void)istr.get();
-    }
-
-    return ch;
-}
-
 // Splits a string that contains the specified separator into substrings
 static std::list<std::string> split(const std::string &s, char separator)
 {
@@ -106,21 +108,48 @@ static std::string join(const std::list<std::string> &list, char separator)
     return s;
 }
 
-/** Just read the code into a string. Perform simple cleanup of the code */
-std::string Preprocessor::read(std::istream &istr, const std::string &filename, Settings *settings)
+/** Is the character whitespace or a control character? (Not extended ASCII) */
+static bool isSpaceOrCntrl(unsigned char ch)
 {
-    // ------------------------------------------------------------------------------------------
-    //
+    return ch <= ' ' || ch == 0x7f;
+}
+
+/**
+ * Is the character copied as it is by the first pass of read()? The
+ * others are line endings, backslashes, and whitespace and control
+ * characters that are replaced with spaces.
+ */
+static bool isPlainChar(unsigned char ch)
+{
+    return ch == ' ' || (!isSpaceOrCntrl(ch) && ch != '\\');
+}
+
+/**
+ * Join the lines that end with a backslash, convert the line endings
+ * to "\\n" and replace whitespace and control characters with spaces.
+ * The runs of plain characters are copied in one go.
+ */
+static std::string spliceLines(const char *data, std::size_t size)
+{
+    std::string code;
+    code.reserve(size);
+
     // handling <backspace><newline>
     // when this is encountered the <backspace><newline> will be "skipped".
     // on the next <newline>, extra newlines will be added
-    std::ostringstream code;
     unsigned int newlines = 0;
-    for (unsigned char ch = readChar(istr); istr.good(); ch = readChar(istr))
+    const char * const end = data + size;
+    const char *pos = data;
+    while (pos < end)
     {
-        // Replace assorted special chars with spaces..
-        if (((ch & 0x80) == 0) && (ch != '\n') && (std::isspace(ch) || std::iscntrl(ch)))
-            ch = ' ';
+        const char * const run = pos;
+        while (pos < end && isPlainChar(static_cast<unsigned char>(*pos)))
+            ++pos;
+        code.append(run, pos);
+        if (pos == end)
+            break;
+
+        const unsigned char ch = static_cast<unsigned char>(*pos++);
 
         // <backspace><newline>..
         // for gcc-compatibility the trailing spaces should be ignored
@@ -129,49 +158,60 @@ std::string Preprocessor::read(std::istream &istr, const std::string &filename,
         // The solution for now is to have a compiler-dependent behaviour.
         if (ch == '\\')
         {
-            unsigned char chNext;
-
 #ifdef __GNUC__
             // gcc-compatibility: ignore spaces
-            for (;;)
-            {
-                chNext = (unsigned char)istr.peek();
-                if (chNext != '\n' && chNext != '\r' &&
-                    (std::isspace(chNext) || std::iscntrl(chNext)))
-                {
-                    // Skip whitespace between <backspace> and <newline>
-                    (void)readChar(istr);
-                    continue;
-                }
-
-                break;
-            }
-#else
-            // keep spaces
-            chNext = (unsigned char)istr.peek();
+            while (pos < end && *pos != '\n' && *pos != '\r' && isSpaceOrCntrl(static_cast<unsigned char>(*pos)))
+                ++pos;
 #endif
-            if (chNext == '\n' || chNext == '\r')
+            if (pos < end && (*pos == '\n' || *pos == '\r'))
             {
                 ++newlines;
-                (void)readChar(istr);   // Skip the "<backspace><newline>"
+                if (*pos++ == '\r' && pos < end && *pos == '\n')
+                    ++pos;
             }
             else
-                code << "\\";
+                code += '\\';
         }
-        else
+        else if (ch == '\n' || ch == '\r')
         {
-            code << char(ch);
+            // A '\r' at the end of the file has always been dropped
+            if (ch == '\r' && pos == end)
+                break;
+            if (ch == '\r' && *pos == '\n')
+                ++pos;
+            code += '\n';
 
             // if there has been <backspace><newline> sequences, add extra newlines..
-            if (ch == '\n' && newlines > 0)
+            if (newlines > 0)
             {
-                code << std::string(newlines, '\n');
+                code.append(newlines, '\n');
                 newlines = 0;
             }
         }
+        else
+        {
+            // Replace assorted special chars with spaces..
+            code += ' ';
+        }
     }
-    std::string result = code.str();
-    code.str("");
+
+    return code;
+}
+
+/** Just read the code into a string. Perform simple cleanup of the code */
+std::string Preprocessor::read(std::istream &istr, const std::string &filename, Settings *settings)
+{
+    // Read the stream in chunks
+    std::string data;
+    char buffer[16384];
+    while (istr.read(buffer, sizeof(buffer)) || istr.gcount() > 0)
+        data.append(buffer, static_cast<std::string::size_type>(istr.gcount()));
+    return read(data.data(), data.size(), filename, settings);
+}
+
+std::string Preprocessor::read(const char *data, std::size_t size, const std::string &filename, Settings *settings)
+{
+    std::string result = spliceLines(data, size);
 
     // ------------------------------------------------------------------------------------------
     //
@@ -197,7 +237,8 @@ std::string Preprocessor::read(std::istream &istr, const std::string &filename,
 
 std::string Preprocessor::preprocessCleanupDirectives(const std::string &processedFile) const
 {
-    std::ostringstream code;
+    std::string code;
+    code.reserve(processedFile.size());
     std::istringstream sstr(processedFile);
 
     std::string line;
@@ -220,7 +261,7 @@ std::string Preprocessor::preprocessCleanupDirectives(const std::string &process
             } escapeStatus = ESC_NONE;
 
             char prev = ' '; // hack to make it skip spaces between # and the directive
-            code << "#";
+            code += "#";
             std::string::const_iterator i = line.begin();
             ++i;
 
@@ -260,14 +301,14 @@ std::string Preprocessor::preprocessCleanupDirectives(const std::string &process
                     if (needSpace)
                     {
                         if (*i == '(' || *i == '!')
-                            code << " ";
+                            code += " ";
                         else if (!std::isalpha(*i))
                             needSpace = false;
                     }
                     if (*i == '#')
                         needSpace = true;
                 }
-                code << *i;
+                code += *i;
                 if (escapeStatus != ESC_NONE && prev == '\\' && *i == '\\')
                 {
                     prev = ' ';
@@ -286,12 +327,13 @@ std::string Preprocessor::preprocessCleanupDirectives(const std::string &process
         else
         {
             // Do not mess with regular code..
-            code << line;
+            code += line;
         }
-        code << (sstr.eof()?"":"\n");
+        if (!sstr.eof())
+            code += "\n";
     }
 
-    return code.str();
+    return code;
 }
 
 static bool hasbom(const std::string &str)
@@ -324,6 +366,49 @@ static bool isFallThroughComment(std::string comment)
            comment == "fall";
 }
 
+/** Is the character copied as it is by removeComments() in code? */
+static bool isOrdinaryCode(unsigned char ch)
+{
+    return ch > ' ' && ch < 0x80 && ch != '\"' && ch != '#' && ch != '\'' && ch != '/' && ch != 'R';
+}
+
+std::size_t Preprocessor::ordinaryCodeScalar(const char *data, std::size_t size)
+{
+    std::size_t pos = 0;
+    while (pos < size && isOrdinaryCode(static_cast<unsigned char>(data[pos])))
+        ++pos;
+    return pos;
+}
+
+std::size_t Preprocessor::ordinaryCode(const char *data, std::size_t size)
+{
+    std::size_t pos = 0;
+#ifdef __SSE2__
+    // Check 16 characters at a time. The signed comparison finds both the
+    // whitespace and control characters and the extended ASCII characters.
+    const __m128i space = _mm_set1_epi8(' ' + 1);
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i hash = _mm_set1_epi8('#');
+    const __m128i apostrophe = _mm_set1_epi8('\'');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i r = _mm_set1_epi8('R');
+    for (; pos + 16 <= size; pos += 16)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        __m128i special = _mm_cmplt_epi8(chars, space);
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(chars, quote));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(chars, hash));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(chars, apostrophe));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(chars, slash));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(chars, r));
+        const int mask = _mm_movemask_epi8(special);
+        if (mask != 0)
+            return pos + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned int>(mask)));
+    }
+#endif
+    return pos + ordinaryCodeScalar(data + pos, size - pos);
+}
+
 std::string Preprocessor::removeComments(const std::string &str, const std::string &filename, Settings *settings)
 {
     // For the error report
@@ -333,12 +418,17 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
     // when this is encountered the <backspace><newline> will be "skipped".
     // on the next <newline>, extra newlines will be added
     unsigned int newlines = 0;
-    std::ostringstream code;
+    std::string code;
+    code.reserve(str.size());
     unsigned char previous = 0;
     bool inPreprocessorLine = false;
     std::vector<std::string> suppressionIDs;
     bool fallThroughComment = false;
 
+    // Only look into the comments when they can add suppressions
+    const bool inlineSuppressions = settings && settings->_inlineSuppressions;
+    const bool fallThroughSuppressions = _settings && _settings->_checkCodingStyle && _settings->inconclusive;
+
     for (std::string::size_type i = hasbom(str) ? 3U : 0U; i < str.length(); ++i)
     {
         unsigned char ch = static_cast<unsigned char>(str[i]);
@@ -351,11 +441,12 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
             writeError(filename, lineno, _errorLogger, "syntaxError", errmsg.str());
         }
 
-        if ((str.compare(i, 6, "#error") == 0 && (!_settings || _settings->userDefines.empty())) ||
-            str.compare(i, 8, "#warning") == 0)
+        if (ch == '#' &&
+            ((str.compare(i, 6, "#error") == 0 && (!_settings || _settings->userDefines.empty())) ||
+             str.compare(i, 8, "#warning") == 0))
         {
             if (str.compare(i, 6, "#error") == 0)
-                code << "#error";
+                code += "#error";
 
             i = str.find("\n", i);
             if (i == std::string::npos)
@@ -374,7 +465,7 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
             }
             else
             {
-                code << char(ch);
+                code += char(ch);
                 previous = ch;
             }
 
@@ -386,7 +477,7 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
                 ++lineno;
                 if (newlines > 0)
                 {
-                    code << std::string(newlines, '\n');
+                    code.append(newlines, '\n');
                     newlines = 0;
                     previous = '\n';
                 }
@@ -396,75 +487,73 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
         }
 
         // Remove comments..
-        if (str.compare(i, 2, "//", 0, 2) == 0)
+        if (ch == '/' && str.compare(i, 2, "//", 0, 2) == 0)
         {
             size_t commentStart = i + 2;
             i = str.find('\n', i);
             if (i == std::string::npos)
                 break;
-            std::string comment(str, commentStart, i - commentStart);
-
-            if (settings && settings->_inlineSuppressions)
+            if (inlineSuppressions || fallThroughSuppressions)
             {
-                std::istringstream iss(comment);
-                std::string word;
-                iss >> word;
-                if (word == "cppcheck-suppress")
+                std::string comment(str, commentStart, i - commentStart);
+
+                if (inlineSuppressions)
                 {
+                    std::istringstream iss(comment);
+                    std::string word;
                     iss >> word;
-                    if (iss)
-                        suppressionIDs.push_back(word);
+                    if (word == "cppcheck-suppress")
+                    {
+                        iss >> word;
+                        if (iss)
+                            suppressionIDs.push_back(word);
+                    }
                 }
-            }
 
-            if (isFallThroughComment(comment))
-            {
-                fallThroughComment = true;
+                if (fallThroughSuppressions && isFallThroughComment(comment))
+                {
+                    fallThroughComment = true;
+                }
             }
 
-            code << "\n";
+            code += "\n";
             previous = '\n';
             ++lineno;
         }
-        else if (str.compare(i, 2, "/*", 0, 2) == 0)
+        else if (ch == '/' && str.compare(i, 2, "/*", 0, 2) == 0)
         {
             size_t commentStart = i + 2;
-            unsigned char chPrev = 0;
-            ++i;
-            while (i < str.length() && (chPrev != '*' || ch != '/'))
+            const std::string::size_type commentEnd = str.find("*/", commentStart);
+            i = (commentEnd == std::string::npos) ? str.length() : commentEnd + 1;
+            const unsigned int commentNewlines = static_cast<unsigned int>(std::count(str.begin() + static_cast<std::string::difference_type>(commentStart), str.begin() + static_cast<std::string::difference_type>(i), '\n'));
+            newlines += commentNewlines;
+            lineno += commentNewlines;
+            if (inlineSuppressions || fallThroughSuppressions)
             {
-                chPrev = ch;
-                ++i;
-                ch = static_cast<unsigned char>(str[i]);
-                if (ch == '\n')
+                std::string comment(str, commentStart, i - commentStart - 1);
+
+                if (fallThroughSuppressions && isFallThroughComment(comment))
                 {
-                    ++newlines;
-                    ++lineno;
+                    fallThroughComment = true;
                 }
-            }
-            std::string comment(str, commentStart, i - commentStart - 1);
-
-            if (isFallThroughComment(comment))
-            {
-                fallThroughComment = true;
-            }
 
-            if (settings && settings->_inlineSuppressions)
-            {
-                std::istringstream iss(comment);
-                std::string word;
-                iss >> word;
-                if (word == "cppcheck-suppress")
+                if (inlineSuppressions)
                 {
+                    std::istringstream iss(comment);
+                    std::string word;
                     iss >> word;
-                    if (iss)
-                        suppressionIDs.push_back(word);
+                    if (word == "cppcheck-suppress")
+                    {
+                        iss >> word;
+                        if (iss)
+                            suppressionIDs.push_back(word);
+                    }
                 }
             }
         }
         else if (ch == '#' && previous == '\n')
         {
-            code << ch;
+            code += char(ch);
             previous = ch;
             inPreprocessorLine = true;
         }
@@ -477,7 +566,7 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
 
                 // First check for a "fall through" comment match, but only
                 // add a suppression if the next token is 'case' or 'default'
-                if (_settings->_checkCodingStyle && _settings->inconclusive && fallThroughComment)
+                if (fallThroughSuppressions && fallThroughComment)
                 {
                     std::string::size_type j = str.find_first_not_of("abcdefghijklmnopqrstuvwxyz", i);
                     std::string tok = str.substr(i, j - i);
@@ -508,7 +597,7 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
             // String or char constants..
             if (ch == '\"' || ch == '\'')
             {
-                code << char(ch);
+                code += char(ch);
                 char chNext;
                 do
                 {
@@ -522,14 +611,14 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
                             ++newlines;
                         else
                         {
-                            code << chNext;
-                            code << chSeq;
+                            code += chNext;
+                            code += chSeq;
                             previous = static_cast<unsigned char>(chSeq);
                         }
                     }
                     else
                     {
-                        code << chNext;
+                        code += chNext;
                         previous = static_cast<unsigned char>(chNext);
                     }
                 }
@@ -560,52 +649,62 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
                 if (delim != " " && endpos != std::string::npos)
                 {
                     unsigned int rawstringnewlines = 0;
-                    code << '\"';
+                    code += '\"';
                     for (std::string::size_type p = i + 3 + delim.size(); p < endpos; ++p)
                     {
                         if (str[p] == '\n')
                         {
                             rawstringnewlines++;
-                            code << "\\n";
+                            code += "\\n";
                         }
                         else if (std::iscntrl((unsigned char)str[p]) ||
                                  std::isspace((unsigned char)str[p]))
                         {
-                            code << " ";
+                            code += " ";
                         }
                         else if (str[p] == '\\')
                         {
-                            code << "\\";
+                            code += "\\";
                         }
                         else if (str[p] == '\"' || str[p] == '\'')
                         {
-                            code << "\\" << (char)str[p];
+                            code += '\\';
+                            code += str[p];
                         }
                         else
                         {
-                            code << (char)str[p];
+                            code += str[p];
                         }
                     }
-                    code << "\"";
+                    code += "\"";
                     if (rawstringnewlines > 0)
-                        code << std::string(rawstringnewlines, '\n');
+                        code.append(rawstringnewlines, '\n');
                     i = endpos + delim.size() + 2;
                 }
                 else
                 {
-                    code << "R";
+                    code += "R";
                     previous = 'R';
                 }
             }
             else
             {
-                code << char(ch);
+                code += char(ch);
                 previous = ch;
+
+                // Copy the ordinary code that follows in one go
+                const std::size_t run = ordinaryCode(str.data() + i + 1, str.length() - i - 1);
+                if (run > 0)
+                {
+                    code.append(str, i + 1, run);
+                    i += run;
+                    previous = static_cast<unsigned char>(str[i]);
+                }
             }
         }
     }
 
-    return code.str();
+    return code;
 }
 
 std::string Preprocessor::removeIf0(const std::string &code)
@@ -794,8 +893,9 @@ void Preprocessor::preprocess(std::istream &istr, std::map<std::string, std::str
     std::list<std::string> configs;
     std::string data;
     preprocess(istr, data, configs, filename, includePaths);
+    const ConditionalCode code(data, _settings);
     for (std::list<std::string>::const_iterator it = configs.begin(); it != configs.end(); ++it)
-        result[ *it ] = Preprocessor::getcode(data, *it, filename, _settings, _errorLogger);
+        result[ *it ] = code.getcode(*it, filename, _settings, _errorLogger);
 }
 
 std::string Preprocessor::removeSpaceNearNL(const std::string &str)
@@ -986,17 +1086,59 @@ std::string Preprocessor::getdef(std::string line, bool def)
 }
 
 
+/**
+ * Is the condition a single name that the tokenizer leaves as it is?
+ * Then Preprocessor::simplifyCondition() only has to look it up. Some
+ * names, e.g. "NULL" and "unsigned", are simplified by the tokenizer.
+ * @param condition the condition
+ * @param plainNames names that have been checked before
+ */
+static bool isPlainName(const std::string &condition, std::map<std::string, bool> &plainNames)
+{
+    if (condition.empty() || std::isdigit(static_cast<unsigned char>(condition[0])))
+        return false;
+    for (std::string::size_type pos = 0; pos < condition.size(); ++pos)
+    {
+        const char ch = condition[pos];
+        if (ch != '_' && !std::isalnum(static_cast<unsigned char>(ch)))
+            return false;
+    }
+
+    const std::map<std::string, bool>::const_iterator it = plainNames.find(condition);
+    if (it != plainNames.end())
+        return it->second;
+
+    Settings settings;
+    Tokenizer tokenizer(&settings, NULL);
+    std::istringstream istr(("(" + condition + ")").c_str());
+    tokenizer.tokenize(istr, "", "", true);
+    const Token *tok = tokenizer.tokens();
+    const bool plain = Token::Match(tok, "( %var% )") && tok->strAt(1) == condition && !tok->tokAt(3);
+    plainNames[condition] = plain;
+    return plain;
+}
 
 std::list<std::string> Preprocessor::getcfgs(const std::string &filedata, const std::string &filename)
 {
     std::list<std::string> ret;
     ret.push_back("");
 
+    // the configurations in ret, to skip duplicates quickly
+    std::set<std::string> configurations;
+    configurations.insert("");
+
     std::list<std::string> deflist, ndeflist;
 
     // constants defined through "#define" in the code..
     std::set<std::string> defines;
 
+    // ..and their values. If a constant is defined with several values
+    // the largest value is used.
+    std::map<std::string, std::string> varmap;
+
+    // the names that simplifyCondition() doesn't need to tokenize
+    std::map<std::string, bool> plainNames;
+
     // How deep into included files are we currently parsing?
     // 0=>Source file, 1=>Included by source file, 2=>included by header that was included by source file, etc
     int filelevel = 0;
@@ -1042,15 +1184,21 @@ std::list<std::string> Preprocessor::getcfgs(const std::string &filedata, const
                 valid = false;
                 break;
             }
+            const std::string::size_type pos = line.find(" ", 8);
             if (!valid)
                 line.clear();
-            else if (line.find(" ", 8) == std::string::npos)
+            else if (pos == std::string::npos)
                 defines.insert(line.substr(8));
             else
             {
-                std::string s = line.substr(8);
-                s[s.find(" ")] = '=';
-                defines.insert(s);
+                const std::string varname(line.substr(8, pos - 8));
+                const std::string value(line.substr(pos + 1));
+                defines.insert(varname);
+                const std::map<std::string, std::string>::iterator var = varmap.find(varname);
+                if (var == varmap.end())
+                    varmap[varname] = value;
+                else if (var->second < value)
+                    var->second = value;
             }
         }
 
@@ -1107,20 +1255,14 @@ std::list<std::string> Preprocessor::getcfgs(const std::string &filedata, const
             }
 
             // Replace defined constants
+            if (isPlainName(def, plainNames))
             {
-                std::map<std::string, std::string> varmap;
-                for (std::set<std::string>::const_iterator it = defines.begin(); it != defines.end(); ++it)
-                {
-                    std::string::size_type pos = it->find("=");
-                    if (pos == std::string::npos)
-                        continue;
-                    const std::string varname(it->substr(0, pos));
-                    const std::string value(it->substr(pos + 1));
-                    varmap[varname] = value;
-                }
-
-                simplifyCondition(varmap, def, false);
+                const std::map<std::string, std::string>::const_iterator var = varmap.find(def);
+                if (var != varmap.end())
+                    def = (var->second == "0") ? "0" : "1";
             }
+            else
+                simplifyCondition(varmap, def, false);
 
             if (! deflist.empty() && line.compare(0, 6, "#elif ") == 0)
                 deflist.pop_back();
@@ -1169,7 +1311,7 @@ std::list<std::string> Preprocessor::getcfgs(const std::string &filedata, const
                 deflist.push_back(nmark);
             }
 
-            if (std::find(ret.begin(), ret.end(), def) == ret.end())
+            if (configurations.insert(def).second)
             {
                 ret.push_back(def);
             }
@@ -1206,44 +1348,16 @@ std::list<std::string> Preprocessor::getcfgs(const std::string &filedata, const
         if (_errorLogger)
             _errorLogger->reportProgress(filename, "Preprocessing (get configurations 2)", (100 * count++) / ret.size());
 
-        std::string cfg(*it);
-        for (std::set<std::string>::const_iterator it2 = defines.begin(); it2 != defines.end(); ++it2)
-        {
-            std::string::size_type pos = 0;
-
-            // Get name of define
-            std::string defineName(*it2);
-            if (defineName.find("=") != std::string::npos)
-                defineName.erase(defineName.find("="));
-
-            // Remove ifdef configurations that match the defineName
-            while ((pos = cfg.find(defineName, pos)) != std::string::npos)
-            {
-                std::string::size_type pos1 = pos;
-                ++pos;
-                if (pos1 > 0 && cfg[pos1-1] != ';')
-                    continue;
-                std::string::size_type pos2 = pos1 + defineName.length();
-                if (pos2 < cfg.length() && cfg[pos2] != ';')
-                    continue;
-                --pos;
-                cfg.erase(pos, defineName.length());
-            }
-        }
-        if (cfg.length() != it->length())
+        // Remove ifdef configurations that match a define
+        const std::list<std::string> defs(split(*it, ';'));
+        std::list<std::string> undefined;
+        for (std::list<std::string>::const_iterator it2 = defs.begin(); it2 != defs.end(); ++it2)
         {
-            while (cfg.length() > 0 && cfg[0] == ';')
-                cfg.erase(0, 1);
-
-            while (cfg.length() > 0 && cfg[cfg.length()-1] == ';')
-                cfg.erase(cfg.length() - 1);
-
-            std::string::size_type pos = 0;
-            while ((pos = cfg.find(";;", pos)) != std::string::npos)
-                cfg.erase(pos, 1);
-
-            *it = cfg;
+            if (defines.find(*it2) == defines.end())
+                undefined.push_back(*it2);
         }
+        if (undefined.size() != defs.size())
+            *it = join(undefined, ';');
     }
 
     // convert configurations: "defined(A) && defined(B)" => "A;B"
@@ -1543,10 +1657,180 @@ bool Preprocessor::match_cfg_def(const std::map<std::string, std::string> &cfg,
 
 std::string Preprocessor::getcode(const std::string &filedata, std::string cfg, const std::string &filename, const Settings *settings, ErrorLogger *errorLogger)
 {
-    // For the error report
+    return ConditionalCode(filedata, settings).getcode(cfg, filename, settings, errorLogger);
+}
+
+ConditionalCode::ConditionalCode(const std::string &filedata, const Settings *settings)
+{
+    // Split the code into lines..
+    std::vector<std::string> lines;
+    for (std::string::size_type pos = 0; pos < filedata.size();)
+    {
+        std::string::size_type end = filedata.find('\n', pos);
+        if (end == std::string::npos)
+            end = filedata.size();
+        lines.push_back(filedata.substr(pos, end - pos));
+        pos = end + 1;
+    }
+
+    // Nesting level of the #if blocks, and the directives on each
+    // level that wait for the next #elif / #else / #endif
+    unsigned int level = 0;
+    std::vector<std::vector<std::size_t> > waiting(1);
+
+    // For the error report. The lines in "#pragma asm" blocks are not counted.
     unsigned int lineno = 0;
 
-    std::ostringstream ret;
+    for (std::size_t i = 0; i < lines.size(); ++i)
+    {
+        const std::string &line = lines[i];
+        ++lineno;
+
+        if (line.empty() || line[0] != '#')
+        {
+            // Code is added to the run of code before it
+            if (_items.empty() || _items.back().type != Item::Code)
+                _items.push_back(Item(Item::Code));
+            _items.back().text += line;
+            _items.back().text += '\n';
+            ++_items.back().lines;
+            continue;
+        }
+
+        if (line.compare(0, 11, "#pragma asm") == 0)
+        {
+            Item item(Item::PragmaAsm);
+            item.text = "\n";
+            bool found_end = false;
+            while (++i < lines.size())
+            {
+                if (lines[i].compare(0, 14, "#pragma endasm") == 0)
+                {
+                    found_end = true;
+                    break;
+                }
+
+                item.text += "\n";
+            }
+
+            // The code ends at a "#pragma asm" without end
+            if (found_end)
+            {
+                std::string endasm(lines[i]);
+                if (endasm.find("=") != std::string::npos)
+                {
+                    Tokenizer tokenizer(settings, NULL);
+                    endasm.erase(0, sizeof("#pragma endasm"));
+                    std::istringstream tempIstr(endasm.c_str());
+                    tokenizer.tokenize(tempIstr, "");
+                    if (Token::Match(tokenizer.tokens(), "( %var% = %any% )"))
+                    {
+                        item.text += "asm(" + tokenizer.tokens()->strAt(1) + ");";
+                    }
+                }
+
+                item.text += "\n";
+            }
+            _items.push_back(item);
+            continue;
+        }
+
+        const std::string def = Preprocessor::getdef(line, true);
+        const std::string ndef = Preprocessor::getdef(line, false);
+
+        Item item(Item::Other);
+        if (line.compare(0, 8, "#define ") == 0)
+        {
+            item.type = Item::Define;
+            std::string::size_type pos = line.find_first_of(" (", 8);
+            if (pos == std::string::npos)
+                item.def = line.substr(8);
+            else if (line[pos] == ' ')
+            {
+                item.def = line.substr(8, pos - 8);
+                item.value = line.substr(pos + 1);
+            }
+            else
+                item.def = line.substr(8, pos - 8);
+        }
+        else if (line.compare(0, 7, "#elif !") == 0)
+        {
+            item.type = Item::ElifNot;
+            item.def = ndef;
+        }
+        else if (line.compare(0, 6, "#elif ") == 0)
+        {
+            item.type = Item::Elif;
+            item.def = def;
+        }
+        else if (!def.empty())
+        {
+            item.type = Item::If;
+            item.def = def;
+        }
+        else if (!ndef.empty())
+        {
+            item.type = Item::IfNot;
+            item.def = ndef;
+        }
+        else if (line == "#else")
+            item.type = Item::Else;
+        else if (line.compare(0, 6, "#endif") == 0)
+            item.type = Item::Endif;
+        else if (line.compare(0, 6, "#error") == 0)
+            item.type = Item::Error;
+
+        item.linenr = lineno;
+
+        // We must not remove #file tags or line numbers
+        // are corrupted. File tags are removed by the tokenizer.
+        // The #define and #undef lines are kept in the configurations
+        // that they are part of.
+        if (line.compare(0, 7, "#file \"") == 0 || line.compare(0, 8, "#endfile") == 0)
+        {
+            item.keep = true;
+            item.text = line;
+        }
+        else if (line.compare(0, 8, "#define ") == 0 || line.compare(0, 6, "#undef") == 0 || item.type == Item::Error)
+            item.text = line;
+
+        const std::size_t index = _items.size();
+        if (item.type == Item::ElifNot || item.type == Item::Elif ||
+            item.type == Item::Else || item.type == Item::Endif)
+        {
+            if (level > 0)
+            {
+                for (std::size_t j = 0; j < waiting[level].size(); ++j)
+                    _items[waiting[level][j]].next = index;
+                waiting[level].clear();
+
+                if (item.type == Item::Endif)
+                    --level;
+                if (level > 0)
+                    waiting[level].push_back(index);
+            }
+        }
+        else if (item.type == Item::If || item.type == Item::IfNot)
+        {
+            ++level;
+            if (waiting.size() <= level)
+                waiting.resize(level + 1);
+            waiting[level].push_back(index);
+        }
+        _items.push_back(item);
+    }
+
+    // The blocks that have no end continue to the end of the code
+    for (std::size_t i = 1; i < waiting.size(); ++i)
+    {
+        for (std::size_t j = 0; j < waiting[i].size(); ++j)
+            _items[waiting[i][j]].next = _items.size();
+    }
+}
+
+std::string ConditionalCode::getcode(const std::string &cfg, const std::string &filename, const Settings *settings, ErrorLogger *errorLogger) const
+{
+    std::string ret;
 
     bool match = true;
     std::list<bool> matching_ifdef;
@@ -1586,170 +1870,118 @@ std::string Preprocessor::getcode(const std::string &filedata, std::string cfg,
         }
     }
 
-    std::istringstream istr(filedata);
-    std::string line;
-    while (getline(istr, line))
+    for (std::size_t i = 0; i < _items.size(); ++i)
     {
-        ++lineno;
+        const Item &item = _items[i];
 
-        if (line.compare(0, 11, "#pragma asm") == 0)
+        if (item.type == Item::Code)
         {
-            ret << "\n";
-            bool found_end = false;
-            while (getline(istr, line))
-            {
-                if (line.compare(0, 14, "#pragma endasm") == 0)
-                {
-                    found_end = true;
-                    break;
-                }
-
-                ret << "\n";
-            }
-            if (!found_end)
-                break;
-
-            if (line.find("=") != std::string::npos)
-            {
-                Tokenizer tokenizer(settings, NULL);
-                line.erase(0, sizeof("#pragma endasm"));
-                std::istringstream tempIstr(line.c_str());
-                tokenizer.tokenize(tempIstr, "");
-                if (Token::Match(tokenizer.tokens(), "( %var% = %any% )"))
-                {
-                    ret << "asm(" << tokenizer.tokens()->strAt(1) << ");";
-                }
-            }
-
-            ret << "\n";
-
+            if (match)
+                ret += item.text;
+            else
+                ret.append(item.lines, '\n');
             continue;
         }
 
-        std::string def = getdef(line, true);
-        std::string ndef = getdef(line, false);
+        if (item.type == Item::PragmaAsm)
+        {
+            ret += item.text;
+            continue;
+        }
 
-        if (line.compare(0, 8, "#define ") == 0)
+        switch (item.type)
         {
+        case Item::Define:
             match = true;
             for (std::list<bool>::const_iterator it = matching_ifdef.begin(); it != matching_ifdef.end(); ++it)
                 match &= bool(*it);
 
             if (match)
-            {
-                std::string::size_type pos = line.find_first_of(" (", 8);
-                if (pos == std::string::npos)
-                    cfgmap[line.substr(8)] = "";
-                else if (line[pos] == ' ')
-                    cfgmap[line.substr(8, pos - 8)] = line.substr(pos + 1);
-                else
-                    cfgmap[line.substr(8, pos - 8)] = "";
-            }
-        }
-
-        else if (line.compare(0, 7, "#elif !") == 0)
-        {
-            if (matched_ifdef.back())
-            {
-                matching_ifdef.back() = false;
-            }
-            else
-            {
-                if (!match_cfg_def(cfgmap, ndef))
-                {
-                    matching_ifdef.back() = true;
-                    matched_ifdef.back() = true;
-                }
-            }
-        }
+                cfgmap[item.def] = item.value;
+            break;
 
-        else if (line.compare(0, 6, "#elif ") == 0)
-        {
+        case Item::ElifNot:
+        case Item::Elif:
+            if (matched_ifdef.empty())
+                break;
             if (matched_ifdef.back())
             {
                 matching_ifdef.back() = false;
             }
             else
             {
-                if (match_cfg_def(cfgmap, def))
+                if (Preprocessor::match_cfg_def(cfgmap, item.def) == (item.type == Item::Elif))
                 {
                     matching_ifdef.back() = true;
                     matched_ifdef.back() = true;
                 }
             }
-        }
-
-        else if (! def.empty())
-        {
-            matching_ifdef.push_back(match_cfg_def(cfgmap, def));
-            matched_ifdef.push_back(matching_ifdef.back());
-        }
+            break;
 
-        else if (! ndef.empty())
-        {
-            matching_ifdef.push_back(! match_cfg_def(cfgmap, ndef));
+        case Item::If:
+        case Item::IfNot:
+            matching_ifdef.push_back(Preprocessor::match_cfg_def(cfgmap, item.def) == (item.type == Item::If));
             matched_ifdef.push_back(matching_ifdef.back());
-        }
+            break;
 
-        else if (line == "#else")
-        {
+        case Item::Else:
             if (! matched_ifdef.empty())
                 matching_ifdef.back() = ! matched_ifdef.back();
-        }
+            break;
 
-        else if (line.compare(0, 6, "#endif") == 0)
-        {
+        case Item::Endif:
             if (! matched_ifdef.empty())
                 matched_ifdef.pop_back();
             if (! matching_ifdef.empty())
                 matching_ifdef.pop_back();
-        }
+            break;
 
-        if (!line.empty() && line[0] == '#')
-        {
-            match = true;
-            for (std::list<bool>::const_iterator it = matching_ifdef.begin(); it != matching_ifdef.end(); ++it)
-                match &= bool(*it);
+        default:
+            break;
         }
 
+        match = true;
+        for (std::list<bool>::const_iterator it = matching_ifdef.begin(); it != matching_ifdef.end(); ++it)
+            match &= bool(*it);
+
         // #error => return ""
-        if (match && line.compare(0, 6, "#error") == 0)
+        if (match && item.type == Item::Error)
         {
             if (settings && !settings->userDefines.empty())
             {
                 Settings settings2(*settings);
                 Preprocessor preprocessor(&settings2, errorLogger);
-                preprocessor.error(filename, lineno, line);
+                preprocessor.error(filename, item.linenr, item.text);
             }
             return "";
         }
 
-        if (!match && (line.compare(0, 8, "#define ") == 0 ||
-                       line.compare(0, 6, "#undef") == 0))
-        {
-            // Remove define that is not part of this configuration
-            line = "";
-        }
-        else if (line.compare(0, 7, "#file \"") == 0 ||
-                 line.compare(0, 8, "#endfile") == 0 ||
-                 line.compare(0, 8, "#define ") == 0 ||
-                 line.compare(0, 6, "#undef") == 0)
-        {
-            // We must not remove #file tags or line numbers
-            // are corrupted. File tags are removed by the tokenizer.
-        }
-        else if (!match || line.compare(0, 1, "#") == 0)
+        if (item.keep || match)
+            ret += item.text;
+        ret += '\n';
+
+        // Skip the code that is not part of this configuration
+        if (!match && item.type != Item::Define && item.type != Item::Other && item.type != Item::Error)
         {
-            // Remove #if, #else, #pragma etc, leaving only
-            // #define, #undef, #file and #endfile. and also lines
-            // which are not part of this configuration.
-            line = "";
+            for (++i; i < item.next; ++i)
+            {
+                const Item &skipped = _items[i];
+                if (skipped.type == Item::Code)
+                    ret.append(skipped.lines, '\n');
+                else if (skipped.type == Item::PragmaAsm)
+                    ret += skipped.text;
+                else
+                {
+                    if (skipped.keep)
+                        ret += skipped.text;
+                    ret += '\n';
+                }
+            }
+            --i;
         }
-
-        ret << line << "\n";
     }
 
-    return expandMacros(ret.str(), filename, errorLogger);
+    return Preprocessor::expandMacros(ret, filename, errorLogger);
 }
 
 void Preprocessor::error(const std::string &filename, unsigned int linenr, const std::string &msg)
@@ -1809,17 +2041,242 @@ static int tolowerWrapper(int c)
 }
 
 
+namespace
+{
+    /**
+     * @brief The headers after Preprocessor::read(), shared by all
+     * Preprocessor instances in the process.
+     *
+     * A header is read once and reused by every file that includes
+     * it, as long as its modification time and size are unchanged.
+     * The headers are keyed by their canonical path, so a header that
+     * is included through different relative paths is read once. When
+     * the cached text grows past MaxBytes the least recently used
+     * headers are dropped.
+     */
+    class HeaderCache
+    {
+    public:
+        HeaderCache() : _bytes(0)
+        { }
+
+        /** Get the text of a header. Returns false if it is not cached */
+        bool get(const std::string &path, const struct stat &st, bool userDefines, std::string &text)
+        {
+            MutexLock lock(_mutex);
+            const std::map<std::string, Entry>::iterator it = _entries.find(path);
+            if (it == _entries.end() ||
+                it->second.mtime != st.st_mtime ||
+                it->second.size != st.st_size ||
+                it->second.userDefines != userDefines)
+                return false;
+            _used.splice(_used.end(), _used, it->second.used);
+            text = it->second.text;
+            return true;
+        }
+
+        /** Save the text of a header */
+        void put(const std::string &path, const struct stat &st, bool userDefines, const std::string &text)
+        {
+            MutexLock lock(_mutex);
+            const std::map<std::string, Entry>::iterator it = _entries.find(path);
+            Entry *entry;
+            if (it != _entries.end())
+            {
+                entry = &it->second;
+                _bytes -= entry->text.size();
+                _used.splice(_used.end(), _used, entry->used);
+            }
+            else
+            {
+                entry = &_entries[path];
+                entry->used = _used.insert(_used.end(), path);
+            }
+            entry->mtime = st.st_mtime;
+            entry->size = st.st_size;
+            entry->userDefines = userDefines;
+            entry->text = text;
+            _bytes += text.size();
+
+            while (_bytes > MaxBytes && _used.size() > 1)
+            {
+                const std::map<std::string, Entry>::iterator oldest = _entries.find(_used.front());
+                _bytes -= oldest->second.text.size();
+                _entries.erase(oldest);
+                _used.pop_front();
+            }
+        }
+
+    private:
+        /** Largest total size of the cached text */
+        static const std::string::size_type MaxBytes = 64 * 1024 * 1024;
+
+        struct Entry
+        {
+            time_t mtime;
+            off_t size;
+            /** the "#error" lines are kept only when there are no user defines */
+            bool userDefines;
+            std::string text;
+            /** position in _used */
+            std::list<std::string>::iterator used;
+        };
+
+        std::map<std::string, Entry> _entries;
+        /** The cached paths, the least recently used first */
+        std::list<std::string> _used;
+        std::string::size_type _bytes;
+        Mutex _mutex;
+    };
+
+    HeaderCache headerCache;
+
+    /** The absolute path of a file with symbolic links resolved */
+    std::string canonicalPath(const std::string &path)
+    {
+#ifdef _WIN32
+        char buffer[_MAX_PATH];
+        if (_fullpath(buffer, path.c_str(), _MAX_PATH))
+            return buffer;
+#else
+        char buffer[PATH_MAX];
+        if (realpath(path.c_str(), buffer))
+            return buffer;
+#endif
+        return path;
+    }
+
+    /**
+     * @brief The contents of a source file. Large files are mapped to
+     * memory, the others are read in chunks.
+     */
+    class SourceFile
+    {
+    public:
+        SourceFile(const std::string &path, std::size_t size) : _data(0), _size(0), _mapped(false)
+        {
+#ifndef _WIN32
+            // Mapping a small file costs more than reading it
+            if (size >= 65536)
+            {
+                const int fd = open(path.c_str(), O_RDONLY);
+                if (fd >= 0)
+                {
+                    void * const addr = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    close(fd);
+                    if (addr != MAP_FAILED)
+                    {
+                        _data = static_cast<const char *>(addr);
+                        _size = size;
+                        _mapped = true;
+                        return;
+                    }
+                }
+            }
+#endif
+            std::ifstream fin(path.c_str(), std::ios::in | std::ios::binary);
+            _buffer.reserve(size);
+            char buffer[16384];
+            while (fin.read(buffer, sizeof(buffer)) || fin.gcount() > 0)
+                _buffer.append(buffer, static_cast<std::string::size_type>(fin.gcount()));
+            _data = _buffer.data();
+            _size = _buffer.size();
+        }
+
+        ~SourceFile()
+        {
+#ifndef _WIN32
+            if (_mapped)
+                munmap(const_cast<char *>(_data), _size);
+#endif
+        }
+
+        const char *data() const
+        {
+            return _data;
+        }
+
+        std::size_t size() const
+        {
+            return _size;
+        }
+
+    private:
+        // Not implemented..
+        SourceFile(const SourceFile &);
+        SourceFile &operator=(const SourceFile &);
+
+        const char *_data;
+        std::size_t _size;
+        bool _mapped;
+        std::string _buffer;
+    };
+
+    /** Position of a string in a buffer, or std::string::npos */
+    std::string::size_type find(const char *data, std::size_t size, const char str[])
+    {
+        const char * const end = data + size;
+        const char * const pos = std::search(data, end, str, str + std::strlen(str));
+        return pos == end ? std::string::npos : static_cast<std::string::size_type>(pos - data);
+    }
+}
+
+std::string Preprocessor::readHeader(const std::string &path, const std::string &filename)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+    {
+        std::ifstream fin(path.c_str(), std::ios::in | std::ios::binary);
+        return read(fin, filename, _settings);
+    }
+
+    const bool userDefines = _settings && !_settings->userDefines.empty();
+    const std::string canonical(canonicalPath(path));
+    std::string text;
+    if (headerCache.get(canonical, st, userDefines, text))
+        return text;
+
+    const SourceFile file(path, static_cast<std::size_t>(st.st_size));
+    const char * const data = file.data();
+    const std::size_t size = file.size();
+    text = read(data, size, filename, _settings);
+
+    // Reading the header must not have side effects, or another file
+    // that gets the cached text would miss them: unhandled characters
+    // are reported and comments can add inline suppressions.
+    bool sideEffects = false;
+    for (std::size_t i = 0; i < size && !sideEffects; ++i)
+        sideEffects = (data[i] & 0x80) != 0;
+    const std::string::size_type npos = std::string::npos;
+    if (_settings && _settings->_inlineSuppressions && find(data, size, "cppcheck-suppress") != npos)
+        sideEffects = true;
+    if (_settings && _settings->_checkCodingStyle && _settings->inconclusive &&
+        (find(data, size, "case") != npos || find(data, size, "default") != npos))
+        sideEffects = true;
+
+    if (!sideEffects)
+        headerCache.put(canonical, st, userDefines, text);
+
+    return text;
+}
+
 void Preprocessor::handleIncludes(std::string &code, const std::string &filePath, const std::list<std::string> &includePaths)
 {
-    std::list<std::string> paths;
-    std::string path;
-    path = filePath;
+    std::string path(filePath);
     path.erase(1 + path.find_last_of("\\/"));
-    paths.push_back(path);
-    std::string::size_type pos = 0;
-    std::string::size_type endfilePos = 0;
+
     std::set<std::string> handledFiles;
-    endfilePos = pos;
+    std::string output;
+    output.reserve(code.size());
+    expandIncludes(code, filePath, path, 0, includePaths, handledFiles, output);
+    code.swap(output);
+}
+
+void Preprocessor::expandIncludes(const std::string &code, const std::string &filePath, const std::string &path, unsigned int linenr, const std::list<std::string> &includePaths, std::set<std::string> &handledFiles, std::string &output)
+{
+    // The code before this position has been copied to the output
+    std::string::size_type copied = 0;
+    std::string::size_type pos = 0;
     while ((pos = code.find("#include", pos)) != std::string::npos)
     {
         // Accept only includes that are at the start of a line
@@ -1829,20 +2286,13 @@ void Preprocessor::handleIncludes(std::string &code, const std::string &filePath
             continue;
         }
 
-        // If endfile is encountered, we have moved to a next file in our stack,
-        // so remove last path in our list.
-        while ((endfilePos = code.find("\n#endfile", endfilePos)) != std::string::npos && endfilePos < pos)
-        {
-            paths.pop_back();
-            endfilePos += 9; // size of #endfile
-        }
-
-        endfilePos = pos;
-        std::string::size_type end = code.find("\n", pos);
-        std::string filename = code.substr(pos, end - pos);
+        output.append(code, copied, pos - copied);
+        linenr += static_cast<unsigned int>(std::count(code.begin() + static_cast<std::string::difference_type>(copied), code.begin() + static_cast<std::string::difference_type>(pos), '\n'));
 
         // Remove #include clause
-        code.erase(pos, end - pos);
+        const std::string::size_type end = code.find("\n", pos);
+        std::string filename = code.substr(pos, end - pos);
+        pos = copied = (end == std::string::npos) ? code.size() : end;
 
         HeaderTypes headerType = getHeaderFileName(filename);
         if (headerType == NoHeader)
@@ -1872,16 +2322,17 @@ void Preprocessor::handleIncludes(std::string &code, const std::string &filePath
 
         if (headerType == UserHeader && !fileOpened)
         {
-            fin.open((paths.back() + filename).c_str());
+            fin.open((path + filename).c_str());
             if (fin.is_open())
             {
-                filename = paths.back() + filename;
+                filename = path + filename;
                 fileOpened = true;
             }
         }
 
         if (fileOpened)
         {
+            const std::string openedPath(filename);
             filename = Path::simplifyPath(filename.c_str());
             std::string tempFile = filename;
             std::transform(tempFile.begin(), tempFile.end(), tempFile.begin(), tolowerWrapper);
@@ -1894,19 +2345,19 @@ void Preprocessor::handleIncludes(std::string &code, const std::string &filePath
             }
 
             handledFiles.insert(tempFile);
-            processedFile = Preprocessor::read(fin, filename, _settings);
             fin.close();
+            processedFile = readHeader(openedPath, filename);
         }
 
         if (!processedFile.empty())
         {
-            // Remove space characters that are after or before new line character
-            processedFile = "#file \"" + filename + "\"\n" + processedFile + "\n#endfile";
-            code.insert(pos, processedFile);
-
-            path = filename;
-            path.erase(1 + path.find_last_of("\\/"));
-            paths.push_back(path);
+            // Expand the includes of the header where it is included.
+            // Its lines are counted from the "#file" line.
+            std::string headerPath(filename);
+            headerPath.erase(1 + headerPath.find_last_of("\\/"));
+            output += "#file \"" + filename + "\"\n";
+            expandIncludes(processedFile, filename, headerPath, 1, includePaths, handledFiles, output);
+            output += "\n#endfile";
         }
         else if (!fileOpened)
         {
@@ -1918,39 +2369,15 @@ void Preprocessor::handleIncludes(std::string &code, const std::string &filePath
             if (_errorLogger && _settings && _settings->isEnabled("missingInclude"))
 #endif
             {
-                std::string f = filePath;
-
-                // Determine line number of include
-                unsigned int linenr = 0;
-                unsigned int level = 0;
-                for (std::string::size_type p = 1; p <= pos; ++p)
-                {
-                    if (level == 0 && code[pos-p] == '\n')
-                        ++linenr;
-                    else if (code.compare(pos-p, 9, "#endfile\n") == 0)
-                    {
-                        ++level;
-                    }
-                    else if (code.compare(pos-p, 6, "#file ") == 0)
-                    {
-                        if (level == 0)
-                        {
-                            const std::string::size_type pos1 = pos - p + 7;
-                            const std::string::size_type pos2 = code.find_first_of("\"\n", pos1);
-                            f = code.substr(pos1, (pos2 == std::string::npos) ? pos2 : (pos2 - pos1));
-                            break;
-                        }
-                        --level;
-                    }
-                }
-
-                missingInclude(Path::toNativeSeparators(f),
+                missingInclude(Path::toNativeSeparators(filePath),
                                linenr,
                                filename,
                                headerType == UserHeader);
             }
         }
     }
+
+    output.append(code, copied, std::string::npos);
 }
 
 // Report that include is missing
@@ -25,6 +25,9 @@
 #include <istream>
 #include <string>
 #include <list>
+#include <set>
+#include <vector>
+#include <cstddef>
 
 class ErrorLogger;
 class Settings;
@@ -88,6 +91,12 @@ public:
     /** Just read the code into a string. Perform simple cleanup of the code */
     std::string read(std::istream &istr, const std::string &filename, Settings *settings);
 
+    /**
+     * Read the code from a buffer, e.g. a mapped file. Same as the
+     * read() above.
+     */
+    std::string read(const char *data, std::size_t size, const std::string &filename, Settings *settings);
+
     /**
      * Get preprocessed code for a given configuration
      */
@@ -144,6 +153,19 @@ protected:
      */
     std::string removeComments(const std::string &str, const std::string &filename, Settings *settings);
 
+    /**
+     * Length of the ordinary code at the start of a buffer, i.e. the
+     * characters that removeComments() copies as they are. The
+     * characters are checked 16 at a time when SSE2 is available.
+     * @param data The buffer
+     * @param size Size of the buffer
+     * @return number of ordinary characters
+     */
+    static std::size_t ordinaryCode(const char *data, std::size_t size);
+
+    /** Same as ordinaryCode(), checks one character at a time */
+    static std::size_t ordinaryCodeScalar(const char *data, std::size_t size);
+
     /**
      * Cleanup 'if 0' from the code
      * @param str Code processed by read().
@@ -228,11 +250,110 @@ private:
      */
     void handleIncludes(std::string &code, const std::string &filePath, const std::list<std::string> &includePaths);
 
+    /**
+     * Append code to the output, with the included files expanded
+     * where they are included. The output is only appended to, so
+     * the time is linear in the size of the output.
+     * @param code The code of a source file or header
+     * @param filePath The file that the code is from
+     * @param path The directory of the file, user headers are also searched from here
+     * @param linenr The line number at the start of the code, for the error messages
+     * @param includePaths List of paths where include files should be searched from
+     * @param handledFiles The files that have been included already (lowercase)
+     * @param output The output
+     */
+    void expandIncludes(const std::string &code, const std::string &filePath, const std::string &path, unsigned int linenr, const std::list<std::string> &includePaths, std::set<std::string> &handledFiles, std::string &output);
+
+    /**
+     * Read an included header. The text is cached and shared with
+     * the other files that include the same header.
+     * @param path The path where the header was found
+     * @param filename The simplified path of the header
+     * @return the header after read()
+     */
+    std::string readHeader(const std::string &path, const std::string &filename);
+
     Settings *_settings;
     ErrorLogger *_errorLogger;
 
     /** filename for cpp/c file - useful when reporting errors */
     std::string file0;
+
+    friend class ConditionalCode;
+};
+
+/**
+ * @brief Preprocessed code that is parsed into runs of code and
+ * preprocessor directives. Each configuration is then produced by
+ * walking them, without splitting the code into lines again. The
+ * blocks that are not part of a configuration are skipped.
+ */
+class ConditionalCode
+{
+public:
+    /**
+     * Parse preprocessed code
+     * @param filedata The code from Preprocessor::preprocess()
+     * @param settings Settings, used for the "#pragma asm" blocks
+     */
+    ConditionalCode(const std::string &filedata, const Settings *settings);
+
+    /**
+     * Get the code for a configuration. Same as Preprocessor::getcode().
+     */
+    std::string getcode(const std::string &cfg, const std::string &filename, const Settings *settings, ErrorLogger *errorLogger) const;
+
+private:
+    /** A run of code lines, a directive or a "#pragma asm" block */
+    struct Item
+    {
+        enum Type
+        {
+            Code,
+            PragmaAsm,
+            Define,
+            ElifNot,
+            Elif,
+            If,
+            IfNot,
+            Else,
+            Endif,
+            Error,
+            Other
+        };
+
+        explicit Item(Type t) : type(t), lines(0), linenr(0), keep(false), next(0)
+        { }
+
+        Type type;
+
+        /** The code lines, the directive, or the output of a "#pragma asm" block */
+        std::string text;
+
+        /** Number of lines in a run of code */
+        unsigned int lines;
+
+        /** Line number of a directive */
+        unsigned int linenr;
+
+        /** The condition of #if / #elif, or the name of a #define */
+        std::string def;
+
+        /** The value of a #define */
+        std::string value;
+
+        /** The directive is kept in all configurations (#file / #endfile) */
+        bool keep;
+
+        /**
+         * When the code after this directive is not part of the
+         * configuration, the next directive that can change that
+         * (#elif / #else / #endif on the same level).
+         */
+        std::size_t next;
+    };
+
+    std::vector<Item> _items;
 };
 
 /// @}
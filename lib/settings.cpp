@@ -38,6 +38,7 @@ Settings::Settings()
     _xml = false;
     _xml_version = 1;
     _jobs = 1;
+    _executor = EXECUTOR_PROCESSES;
     _exitCode = 0;
     _showtime = 0; // TODO: use enum
     _append = "";
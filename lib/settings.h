@@ -95,6 +95,19 @@ public:
         time. Default is 1. (-j N) */
     unsigned int _jobs;
 
+    /** @brief How the files are checked at the same time (--executor=processes|threads) */
+    enum Executor
+    {
+        /** A child process checks each file */
+        EXECUTOR_PROCESSES,
+
+        /** Worker threads check the files */
+        EXECUTOR_THREADS
+    };
+
+    /** @brief How the files are checked when _jobs is more than 1 */
+    Executor _executor;
+
     /** @brief If errors are found, this value is returned from main().
         Default value is 0. */
     int _exitCode;
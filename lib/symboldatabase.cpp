@@ -33,6 +33,10 @@
 #include <algorithm>
 
 
+//---------------------------------------------------------------------------
+
+const std::string Variable::_noname;
+
 //---------------------------------------------------------------------------
 
 SymbolDatabase::SymbolDatabase(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger)
@@ -1327,7 +1331,7 @@ void Scope::getVariableList()
         }
 
         // Is it a nested class or structure?
-        else if (Token::Match(tok, "class|struct|union|namespace %type% :|{"))
+        else if (TOKEN_MATCH(tok, "class|struct|union|namespace %type% :|{"))
         {
             tok = tok->tokAt(2);
             while (tok && tok->str() != "{")
@@ -1377,7 +1381,7 @@ void Scope::getVariableList()
         }
 
         // Is it a forward declaration?
-        else if (Token::Match(tok, "class|struct|union %var% ;"))
+        else if (TOKEN_MATCH(tok, "class|struct|union %var% ;"))
         {
             tok = tok->tokAt(2);
             continue;
@@ -1388,7 +1392,7 @@ void Scope::getVariableList()
             continue;
 
         // skip return and delete
-        else if (Token::Match(tok, "return|delete"))
+        else if (TOKEN_MATCH(tok, "return|delete"))
         {
             while (tok->next()->str() != ";")
                 tok = tok->next();
@@ -1396,7 +1400,7 @@ void Scope::getVariableList()
         }
 
         // Search for start of statement..
-        else if (tok->previous() && !Token::Match(tok->previous(), ";|{|}|public:|protected:|private:"))
+        else if (tok->previous() && !TOKEN_MATCH(tok->previous(), ";|{|}|public:|protected:|private:"))
             continue;
         else if (Token::Match(tok, ";|{|}"))
             continue;
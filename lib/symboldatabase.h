@@ -127,13 +127,11 @@ public:
      */
     const std::string &name() const
     {
-        static const std::string noname;
-
         // name may not exist for function arguments
         if (_name)
             return _name->str();
 
-        return noname;
+        return _noname;
     }
 
     /**
@@ -308,6 +306,9 @@ private:
 
     /** @brief pointer to scope this variable is in */
     const Scope *_scope;
+
+    /** @brief name of the variables without a name, see name() */
+    static const std::string _noname;
 };
 
 class Function
@@ -0,0 +1,334 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//---------------------------------------------------------------------------
+#include "threading.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+//---------------------------------------------------------------------------
+
+#if defined(_WIN32)
+
+struct Mutex::Data
+{
+    CRITICAL_SECTION section;
+};
+
+Mutex::Mutex() : _data(new Data)
+{
+    InitializeCriticalSection(&_data->section);
+}
+
+Mutex::~Mutex()
+{
+    DeleteCriticalSection(&_data->section);
+    delete _data;
+}
+
+void Mutex::lock()
+{
+    EnterCriticalSection(&_data->section);
+}
+
+void Mutex::unlock()
+{
+    LeaveCriticalSection(&_data->section);
+}
+
+struct ConditionVariable::Data
+{
+    CONDITION_VARIABLE cond;
+};
+
+ConditionVariable::ConditionVariable() : _data(new Data)
+{
+    InitializeConditionVariable(&_data->cond);
+}
+
+ConditionVariable::~ConditionVariable()
+{
+    delete _data;
+}
+
+void ConditionVariable::wait(Mutex &mutex)
+{
+    SleepConditionVariableCS(&_data->cond, &mutex._data->section, INFINITE);
+}
+
+void ConditionVariable::signal()
+{
+    WakeConditionVariable(&_data->cond);
+}
+
+void ConditionVariable::broadcast()
+{
+    WakeAllConditionVariable(&_data->cond);
+}
+
+struct Thread::Data
+{
+    HANDLE handle;
+    Function function;
+    void *argument;
+};
+
+static DWORD WINAPI threadStart(LPVOID data)
+{
+    Thread::run(data);
+    return 0;
+}
+
+Thread::Thread() : _data(new Data)
+{
+    _data->handle = 0;
+}
+
+Thread::~Thread()
+{
+    delete _data;
+}
+
+bool Thread::start(Function function, void *argument)
+{
+    _data->function = function;
+    _data->argument = argument;
+    _data->handle = CreateThread(0, 0, threadStart, _data, 0, 0);
+    return _data->handle != 0;
+}
+
+void Thread::join()
+{
+    WaitForSingleObject(_data->handle, INFINITE);
+    CloseHandle(_data->handle);
+    _data->handle = 0;
+}
+
+// The values are not destroyed when a thread ends, only when the
+// ThreadLocal is destroyed.
+struct ThreadLocalBase::Key
+{
+    DWORD index;
+};
+
+ThreadLocalBase::ThreadLocalBase(Destroy destroy) : _key(new Key), _destroy(destroy)
+{
+    _key->index = TlsAlloc();
+}
+
+void *ThreadLocalBase::get() const
+{
+    const Value *value = static_cast<const Value *>(TlsGetValue(_key->index));
+    return value ? value->value : 0;
+}
+
+void ThreadLocalBase::set(void *value)
+{
+    Value *v = new Value;
+    v->owner = this;
+    v->value = value;
+    {
+        MutexLock lock(_mutex);
+        _values.insert(v);
+    }
+    TlsSetValue(_key->index, v);
+}
+
+#else
+
+struct Mutex::Data
+{
+    pthread_mutex_t mutex;
+};
+
+Mutex::Mutex() : _data(new Data)
+{
+    pthread_mutex_init(&_data->mutex, 0);
+}
+
+Mutex::~Mutex()
+{
+    pthread_mutex_destroy(&_data->mutex);
+    delete _data;
+}
+
+void Mutex::lock()
+{
+    pthread_mutex_lock(&_data->mutex);
+}
+
+void Mutex::unlock()
+{
+    pthread_mutex_unlock(&_data->mutex);
+}
+
+struct ConditionVariable::Data
+{
+    pthread_cond_t cond;
+};
+
+ConditionVariable::ConditionVariable() : _data(new Data)
+{
+    pthread_cond_init(&_data->cond, 0);
+}
+
+ConditionVariable::~ConditionVariable()
+{
+    pthread_cond_destroy(&_data->cond);
+    delete _data;
+}
+
+void ConditionVariable::wait(Mutex &mutex)
+{
+    pthread_cond_wait(&_data->cond, &mutex._data->mutex);
+}
+
+void ConditionVariable::signal()
+{
+    pthread_cond_signal(&_data->cond);
+}
+
+void ConditionVariable::broadcast()
+{
+    pthread_cond_broadcast(&_data->cond);
+}
+
+struct Thread::Data
+{
+    pthread_t thread;
+    Function function;
+    void *argument;
+};
+
+extern "C"
+{
+    static void *threadStart(void *data);
+}
+
+Thread::Thread() : _data(new Data)
+{
+}
+
+Thread::~Thread()
+{
+    delete _data;
+}
+
+bool Thread::start(Function function, void *argument)
+{
+    _data->function = function;
+    _data->argument = argument;
+    return pthread_create(&_data->thread, 0, threadStart, _data) == 0;
+}
+
+void Thread::join()
+{
+    pthread_join(_data->thread, 0);
+}
+
+static void *threadStart(void *data)
+{
+    Thread::run(data);
+    return 0;
+}
+
+struct ThreadLocalBase::Key
+{
+    pthread_key_t key;
+};
+
+extern "C"
+{
+    static void threadLocalExit(void *value);
+}
+
+ThreadLocalBase::ThreadLocalBase(Destroy destroy) : _key(new Key), _destroy(destroy)
+{
+    pthread_key_create(&_key->key, threadLocalExit);
+}
+
+void *ThreadLocalBase::get() const
+{
+    const Value *value = static_cast<const Value *>(pthread_getspecific(_key->key));
+    return value ? value->value : 0;
+}
+
+void ThreadLocalBase::set(void *value)
+{
+    Value *v = new Value;
+    v->owner = this;
+    v->value = value;
+    {
+        MutexLock lock(_mutex);
+        _values.insert(v);
+    }
+    pthread_setspecific(_key->key, v);
+}
+
+void ThreadLocalBase::threadExit(void *value)
+{
+    Value *v = static_cast<Value *>(value);
+    ThreadLocalBase * const owner = v->owner;
+    {
+        MutexLock lock(owner->_mutex);
+        owner->_values.erase(v);
+    }
+    owner->_destroy(v->value);
+    delete v;
+}
+
+static void threadLocalExit(void *value)
+{
+    ThreadLocalBase::threadExit(value);
+}
+
+#endif
+
+void memoryBarrier()
+{
+#if defined(_WIN32)
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+void Thread::run(void *data)
+{
+    const Data * const d = static_cast<const Data *>(data);
+    d->function(d->argument);
+}
+
+ThreadLocalBase::~ThreadLocalBase()
+{
+#if defined(_WIN32)
+    TlsFree(_key->index);
+#else
+    pthread_key_delete(_key->key);
+#endif
+    delete _key;
+
+    for (std::set<Value *>::iterator it = _values.begin(); it != _values.end(); ++it)
+    {
+        _destroy((*it)->value);
+        delete *it;
+    }
+}
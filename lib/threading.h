@@ -0,0 +1,228 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef threadingH
+#define threadingH
+//---------------------------------------------------------------------------
+
+#include <set>
+
+/// @addtogroup Core
+/// @{
+
+/**
+ * @brief A mutex.
+ *
+ * Several CppCheck instances can check files at the same time in
+ * different threads. The data that is shared by the instances is
+ * protected with a mutex.
+ */
+class Mutex
+{
+public:
+    Mutex();
+    ~Mutex();
+
+    void lock();
+    void unlock();
+
+private:
+    // Not implemented..
+    Mutex(const Mutex &);
+    Mutex &operator=(const Mutex &);
+
+    friend class ConditionVariable;
+
+    struct Data;
+    Data * const _data;
+};
+
+/** @brief Locks a mutex for the lifetime of the MutexLock */
+class MutexLock
+{
+public:
+    explicit MutexLock(Mutex &mutex) : _mutex(mutex)
+    {
+        _mutex.lock();
+    }
+
+    ~MutexLock()
+    {
+        _mutex.unlock();
+    }
+
+private:
+    // Not implemented..
+    MutexLock(const MutexLock &);
+    MutexLock &operator=(const MutexLock &);
+
+    Mutex &_mutex;
+};
+
+/**
+ * @brief A condition variable.
+ *
+ * A thread waits until another thread changes the data that is
+ * protected by a mutex, and signals the condition.
+ */
+class ConditionVariable
+{
+public:
+    ConditionVariable();
+    ~ConditionVariable();
+
+    /**
+     * Unlock the mutex and wait until the condition is signalled. The
+     * mutex is locked again when this returns. The mutex must be locked
+     * by the calling thread.
+     */
+    void wait(Mutex &mutex);
+
+    /** Wake up one thread that waits */
+    void signal();
+
+    /** Wake up all threads that wait */
+    void broadcast();
+
+private:
+    // Not implemented..
+    ConditionVariable(const ConditionVariable &);
+    ConditionVariable &operator=(const ConditionVariable &);
+
+    struct Data;
+    Data * const _data;
+};
+
+/**
+ * @brief A full memory barrier. The writes before it are visible to the
+ * other threads before the writes after it.
+ */
+void memoryBarrier();
+
+/**
+ * @brief A thread that runs a function.
+ *
+ * The thread must be joined before the Thread is destroyed.
+ */
+class Thread
+{
+public:
+    typedef void (*Function)(void *argument);
+
+    Thread();
+    ~Thread();
+
+    /**
+     * Start running the function in a new thread
+     * @return false if the thread could not be created
+     */
+    bool start(Function function, void *argument);
+
+    /** Wait until the function has returned */
+    void join();
+
+    /** Called in the new thread, runs the function */
+    static void run(void *data);
+
+private:
+    // Not implemented..
+    Thread(const Thread &);
+    Thread &operator=(const Thread &);
+
+    struct Data;
+    Data * const _data;
+};
+
+/** @brief The values of a ThreadLocal, it does not know their type */
+class ThreadLocalBase
+{
+protected:
+    typedef void (*Destroy)(void *value);
+
+    explicit ThreadLocalBase(Destroy destroy);
+
+    /** Destroys the values of the threads that are still running */
+    ~ThreadLocalBase();
+
+    /** @return the value of the current thread, 0 if it has not been set */
+    void *get() const;
+
+    /** Set the value of the current thread. It is destroyed when the thread ends. */
+    void set(void *value);
+
+public:
+    /** Called when a thread ends, destroys its value */
+    static void threadExit(void *value);
+
+private:
+    // Not implemented..
+    ThreadLocalBase(const ThreadLocalBase &);
+    ThreadLocalBase &operator=(const ThreadLocalBase &);
+
+    struct Value
+    {
+        ThreadLocalBase *owner;
+        void *value;
+    };
+
+    struct Key;
+    Key * const _key;
+    const Destroy _destroy;
+
+    /** The values of all threads */
+    std::set<Value *> _values;
+    Mutex _mutex;
+};
+
+/**
+ * @brief A value that each thread has its own copy of.
+ *
+ * It is used for caches that would need a lock for every lookup if they
+ * were shared by the threads. The value is created the first time that
+ * a thread uses it.
+ */
+template <class T>
+class ThreadLocal : private ThreadLocalBase
+{
+public:
+    ThreadLocal() : ThreadLocalBase(destroy)
+    { }
+
+    T &get()
+    {
+        T *value = static_cast<T *>(ThreadLocalBase::get());
+        if (!value)
+        {
+            value = new T;
+            set(value);
+        }
+        return *value;
+    }
+
+private:
+    static void destroy(void *value)
+    {
+        delete static_cast<T *>(value);
+    }
+};
+
+/// @}
+
+//---------------------------------------------------------------------------
+#endif
@@ -16,47 +16,403 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
 #include "timer.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/time.h>
+#endif
+
 /*
 	TODO:
 	- handle SHOWTIME_TOP5 in TimerResults
 	- sort list by time
 	- do not sort the results alphabetically
 	- rename "file" to "single"
-	- synchronise map access in multithreaded mode or disable timing
 	- add unit tests
 		- for --showtime (needs input file)
-		- for Timer* classes
 */
 
 
-void TimerResults::ShowResults()
+namespace
+{
+    /** Quote a name for a CSV field when it contains a separator or a quote */
+    std::string csvField(const std::string &str)
+    {
+        if (str.find_first_of(",\"\n") == std::string::npos)
+            return str;
+        std::string ret("\"");
+        for (std::string::size_type i = 0; i < str.size(); ++i)
+        {
+            if (str[i] == '"')
+                ret += '"';
+            ret += str[i];
+        }
+        return ret + "\"";
+    }
+
+    std::string jsonString(const std::string &str)
+    {
+        std::string ret("\"");
+        for (std::string::size_type i = 0; i < str.size(); ++i)
+        {
+            const unsigned char c = static_cast<unsigned char>(str[i]);
+            if (c == '"' || c == '\\')
+            {
+                ret += '\\';
+                ret += str[i];
+            }
+            else if (c < 0x20)
+            {
+                static const char hex[] = "0123456789abcdef";
+                ret += "\\u00";
+                ret += hex[c >> 4];
+                ret += hex[c & 0xf];
+            }
+            else
+                ret += str[i];
+        }
+        return ret + "\"";
+    }
+
+    /** Write the results of a stage in the given format */
+    void showResult(std::ostream &ostr, unsigned int showtimeMode, const std::string &name, const TimerResultsData &data)
+    {
+        const double p50 = data._histogram.percentile(50);
+        const double p95 = data._histogram.percentile(95);
+        const double max = data._histogram.percentile(100);
+
+        if (showtimeMode == SHOWTIME_CSV)
+        {
+            ostr << csvField(name) << ',' << data._seconds << ',' << data._numberOfResults << ','
+                 << p50 << ',' << p95 << ',' << max << ',';
+            if (data._hasTokens)
+                ostr << data._tokensBefore << ',' << data._tokensAfter;
+            else
+                ostr << ',';
+            ostr << std::endl;
+        }
+        else if (showtimeMode == SHOWTIME_JSON)
+        {
+            ostr << "{ \"name\": " << jsonString(name)
+                 << ", \"seconds\": " << data._seconds
+                 << ", \"calls\": " << data._numberOfResults
+                 << ", \"p50\": " << p50
+                 << ", \"p95\": " << p95
+                 << ", \"max\": " << max;
+            if (data._hasTokens)
+                ostr << ", \"tokensBefore\": " << data._tokensBefore << ", \"tokensAfter\": " << data._tokensAfter;
+            ostr << " }";
+        }
+        else
+        {
+            const double secAverage = data._numberOfResults ? data._seconds / data._numberOfResults : 0.0;
+            ostr << name << ": " << data._seconds << "s (avg. " << secAverage << "s - " << data._numberOfResults  << " result(s))"
+                 << " p50: " << p50 << "s p95: " << p95 << "s max: " << max << "s";
+            if (data._hasTokens)
+                ostr << " tokens: " << data._tokensBefore << " -> " << data._tokensAfter;
+        }
+    }
+}
+
+TimerHistogram::TimerHistogram()
+    : _total(0)
+    , _min(0)
+    , _max(0)
+{
+}
+
+unsigned int TimerHistogram::bucket(double seconds)
+{
+    if (seconds <= 0)
+        return 0;
+    const double index = std::floor((std::log(seconds) / std::log(2.0) - SmallestExponent) * BucketsPerDoubling);
+    if (index < 0)
+        return 0;
+    if (index >= Buckets)
+        return Buckets - 1;
+    return static_cast<unsigned int>(index);
+}
+
+void TimerHistogram::add(double seconds)
+{
+    if (_counts.empty())
+        _counts.resize(Buckets);
+    _counts[bucket(seconds)]++;
+    if (_total == 0 || seconds < _min)
+        _min = seconds;
+    if (_total == 0 || seconds > _max)
+        _max = seconds;
+    _total++;
+}
+
+void TimerHistogram::merge(const TimerHistogram &other)
+{
+    if (other._total == 0)
+        return;
+    if (_counts.empty())
+        _counts.resize(Buckets);
+    for (unsigned int i = 0; i < Buckets; ++i)
+        _counts[i] += other._counts[i];
+    if (_total == 0 || other._min < _min)
+        _min = other._min;
+    if (_total == 0 || other._max > _max)
+        _max = other._max;
+    _total += other._total;
+}
+
+double TimerHistogram::percentile(unsigned int percent) const
+{
+    if (_total == 0)
+        return 0.0;
+
+    unsigned long rank = (_total * percent + 99) / 100;
+    if (rank == 0)
+        rank = 1;
+
+    unsigned int i = 0;
+    unsigned long count = _counts[0];
+    while (count < rank)
+        count += _counts[++i];
+
+    // The smallest and the largest time are known exactly
+    if (i == bucket(_min))
+        return _min;
+    if (i == bucket(_max))
+        return _max;
+
+    // The middle of the bucket
+    const double exponent = (i + 0.5) / BucketsPerDoubling + SmallestExponent;
+    return std::min(_max, std::max(_min, std::pow(2.0, exponent)));
+}
+
+void TimerHistogram::serialize(std::ostream &ostr) const
+{
+    // "<total> <min> <max> <buckets>" and the index and count of each bucket that is used
+    unsigned int used = 0;
+    for (unsigned int i = 0; i < _counts.size(); ++i)
+        used += _counts[i] ? 1 : 0;
+    ostr << _total << " " << _min << " " << _max << " " << used;
+    for (unsigned int i = 0; i < _counts.size(); ++i)
+    {
+        if (_counts[i])
+            ostr << " " << i << " " << _counts[i];
+    }
+}
+
+bool TimerHistogram::deserialize(std::istream &istr)
+{
+    TimerHistogram histogram;
+    unsigned int used = 0;
+    if (!(istr >> histogram._total >> histogram._min >> histogram._max >> used))
+        return false;
+    histogram._counts.resize(Buckets);
+    unsigned long total = 0;
+    for (unsigned int i = 0; i < used; ++i)
+    {
+        unsigned int index = 0;
+        unsigned long count = 0;
+        if (!(istr >> index >> count) || index >= Buckets)
+            return false;
+        histogram._counts[index] += count;
+        total += count;
+    }
+    if (total != histogram._total)
+        return false;
+    merge(histogram);
+    return true;
+}
+
+void TimerResults::ShowResults(std::ostream &ostr, unsigned int showtimeMode) const
 {
-    std::clock_t overallClocks = 0;
+    double overallSeconds = 0;
 
     std::map<std::string, struct TimerResultsData>::const_iterator I = _results.begin();
     const std::map<std::string, struct TimerResultsData>::const_iterator E = _results.end();
 
+    if (showtimeMode == SHOWTIME_CSV)
+        ostr << "name,seconds,calls,p50,p95,max,tokensBefore,tokensAfter" << std::endl;
+    else if (showtimeMode == SHOWTIME_JSON)
+        ostr << "{" << std::endl << "  \"results\": [";
+
     while (I != E)
     {
-        const double sec = (double)I->second._clocks / CLOCKS_PER_SEC;
-        const double secAverage = (double)(I->second._clocks / I->second._numberOfResults) / CLOCKS_PER_SEC;
-        std::cout << I->first << ": " << sec << "s (avg. " << secAverage << "s - " << I->second._numberOfResults  << " result(s))" << std::endl;
+        if (showtimeMode == SHOWTIME_JSON)
+            ostr << (I == _results.begin() ? "" : ",") << std::endl << "    ";
+        showResult(ostr, showtimeMode, I->first, I->second);
+        if (showtimeMode != SHOWTIME_CSV && showtimeMode != SHOWTIME_JSON)
+            ostr << std::endl;
 
-        overallClocks += I->second._clocks;
+        // the simplifications are already counted in the Tokenizer stages
+        if (!I->second._hasTokens)
+            overallSeconds += I->second._seconds;
 
         ++I;
     }
 
-    const double secOverall = (double)overallClocks / CLOCKS_PER_SEC;
-    std::cout << "Overall time: " << secOverall << "s" << std::endl;
+    if (showtimeMode == SHOWTIME_JSON)
+        ostr << std::endl << "  ]," << std::endl;
+
+    // The time of the files, the slowest file is shown with the maximum
+    if (!_files.empty())
+    {
+        TimerResultsData files;
+        std::map<std::string, double>::const_iterator slowest = _files.begin();
+        for (std::map<std::string, double>::const_iterator it = _files.begin(); it != _files.end(); ++it)
+        {
+            files._seconds += it->second;
+            files._numberOfResults++;
+            files._histogram.add(it->second);
+            if (it->second > slowest->second)
+                slowest = it;
+        }
+
+        if (showtimeMode == SHOWTIME_JSON)
+        {
+            ostr << "  \"files\": ";
+            showResult(ostr, showtimeMode, "Per file", files);
+            ostr << "," << std::endl << "  \"slowestFile\": " << jsonString(slowest->first) << "," << std::endl;
+        }
+        else
+        {
+            showResult(ostr, showtimeMode, "Per file", files);
+            if (showtimeMode != SHOWTIME_CSV)
+                ostr << " slowest: " << slowest->first << std::endl;
+        }
+    }
+
+    if (showtimeMode == SHOWTIME_JSON)
+        ostr << "  \"overall\": " << overallSeconds << std::endl
+             << "}" << std::endl;
+    else if (showtimeMode != SHOWTIME_CSV)
+        ostr << "Overall time: " << overallSeconds << "s" << std::endl;
+}
+
+void TimerResults::AddResults(const std::string& str, double seconds)
+{
+    TimerResultsData &data = _results[str];
+    data._seconds += seconds;
+    data._numberOfResults++;
+    data._histogram.add(seconds);
+}
+
+void TimerResults::AddTokens(const std::string& str, unsigned long tokensBefore, unsigned long tokensAfter)
+{
+    TimerResultsData &data = _results[str];
+    data._hasTokens = true;
+    data._tokensBefore += tokensBefore;
+    data._tokensAfter += tokensAfter;
+}
+
+void TimerResults::AddFileResults(const std::string& file, double seconds)
+{
+    _files[file] += seconds;
+}
+
+void TimerResults::Merge(const TimerResults &other)
+{
+    for (std::map<std::string, struct TimerResultsData>::const_iterator it = other._results.begin(); it != other._results.end(); ++it)
+    {
+        TimerResultsData &data = _results[it->first];
+        data._seconds += it->second._seconds;
+        data._numberOfResults += it->second._numberOfResults;
+        data._histogram.merge(it->second._histogram);
+        if (it->second._hasTokens)
+        {
+            data._hasTokens = true;
+            data._tokensBefore += it->second._tokensBefore;
+            data._tokensAfter += it->second._tokensAfter;
+        }
+    }
+
+    for (std::map<std::string, double>::const_iterator it = other._files.begin(); it != other._files.end(); ++it)
+        _files[it->first] += it->second;
+}
+
+std::string TimerResults::serialize() const
+{
+    // Each result is written as "R <length of name> <name> <tokens> <seconds> <count> <histogram>"
+    // and each file as "F <length of name> <name> <seconds>". The times
+    // of the results are not written, only their histogram.
+    std::ostringstream ostr;
+    ostr << std::setprecision(17);
+    for (std::map<std::string, struct TimerResultsData>::const_iterator it = _results.begin(); it != _results.end(); ++it)
+    {
+        const TimerResultsData &data = it->second;
+        ostr << "R " << it->first.length() << " " << it->first << " "
+             << (data._hasTokens ? 1 : 0) << " " << data._tokensBefore << " " << data._tokensAfter << " "
+             << data._seconds << " " << data._numberOfResults << " ";
+        data._histogram.serialize(ostr);
+        ostr << "\n";
+    }
+    for (std::map<std::string, double>::const_iterator it = _files.begin(); it != _files.end(); ++it)
+        ostr << "F " << it->first.length() << " " << it->first << " " << it->second << "\n";
+    return ostr.str();
+}
+
+bool TimerResults::deserialize(const std::string &data)
+{
+    TimerResults results;
+    std::istringstream istr(data);
+    char type;
+    while (istr >> type)
+    {
+        std::string::size_type len = 0;
+        if (!(istr >> len) || istr.get() != ' ')
+            return false;
+        std::string name(len, '\0');
+        if (len > 0 && !istr.read(&name[0], len))
+            return false;
+
+        if (type == 'R')
+        {
+            int hasTokens = 0;
+            unsigned long tokensBefore = 0, tokensAfter = 0;
+            TimerResultsData &result = results._results[name];
+            if (!(istr >> hasTokens >> tokensBefore >> tokensAfter >> result._seconds >> result._numberOfResults))
+                return false;
+            if (!result._histogram.deserialize(istr))
+                return false;
+            if (hasTokens)
+                results.AddTokens(name, tokensBefore, tokensAfter);
+        }
+        else if (type == 'F')
+        {
+            double seconds = 0;
+            if (!(istr >> seconds))
+                return false;
+            results.AddFileResults(name, seconds);
+        }
+        else
+            return false;
+    }
+
+    Merge(results);
+    return true;
 }
 
-void TimerResults::AddResults(const std::string& str, std::clock_t clocks)
+double Timer::now()
 {
-    _results[str]._clocks += clocks;
-    _results[str]._numberOfResults++;
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+#endif
 }
 
 Timer::Timer(const std::string& str, unsigned int showtimeMode, TimerResultsIntf* timerResults)
@@ -67,7 +423,7 @@ Timer::Timer(const std::string& str, unsigned int showtimeMode, TimerResultsIntf
     , _timerResults(timerResults)
 {
     if (showtimeMode != SHOWTIME_NONE)
-        _start = std::clock();
+        _start = now();
 }
 
 Timer::~Timer()
@@ -79,18 +435,16 @@ void Timer::Stop()
 {
     if ((_showtimeMode != SHOWTIME_NONE) && !_stopped)
     {
-        const std::clock_t end = std::clock();
-        const std::clock_t diff = end - _start;
+        const double sec = now() - _start;
 
         if (_showtimeMode == SHOWTIME_FILE)
         {
-            double sec = (double)diff / CLOCKS_PER_SEC;
             std::cout << _str << ": " << sec << "s" << std::endl;
         }
         else
         {
             if (_timerResults)
-                _timerResults->AddResults(_str, diff);
+                _timerResults->AddResults(_str, sec);
         }
     }
 
@@ -21,14 +21,18 @@
 
 #include <string>
 #include <map>
-#include <ctime>
+#include <vector>
+#include <ostream>
+#include <istream>
 
 enum
 {
     SHOWTIME_NONE = 0,
     SHOWTIME_FILE,
     SHOWTIME_SUMMARY,
-    SHOWTIME_TOP5
+    SHOWTIME_TOP5,
+    SHOWTIME_CSV,
+    SHOWTIME_JSON
 };
 
 class TimerResultsIntf
@@ -36,21 +40,90 @@ class TimerResultsIntf
 public:
     virtual ~TimerResultsIntf() { }
 
-    virtual void AddResults(const std::string& str, std::clock_t clocks) = 0;
+    /** A stage took the given time, in seconds */
+    virtual void AddResults(const std::string& str, double seconds) = 0;
+
+    /**
+     * Number of tokens before and after a Tokenizer simplification. The
+     * simplifications are timed within the Tokenizer stages, so results
+     * that have token counts are not added to the overall time.
+     */
+    virtual void AddTokens(const std::string& str, unsigned long tokensBefore, unsigned long tokensAfter) = 0;
+};
+
+/**
+ * @brief A histogram of times, for the percentiles.
+ *
+ * The times are not kept, only the number of times in each bucket. The
+ * buckets grow logarithmically, there are 8 buckets for each doubling of
+ * the time, from 2^-30 s (about 1 ns) to 2^12 s. So its size is fixed and
+ * a percentile is within about 5% of the exact value. The smallest and
+ * the largest time are exact.
+ */
+class TimerHistogram
+{
+public:
+    TimerHistogram();
+
+    void add(double seconds);
+
+    /** Add the times of another histogram */
+    void merge(const TimerHistogram &other);
+
+    /**
+     * Percentile of the times, with the nearest rank method
+     * @param percent 50 for the median
+     * @return the time, 0 if there are no times
+     */
+    double percentile(unsigned int percent) const;
+
+    /** Write the histogram, only the buckets that are used are written */
+    void serialize(std::ostream &ostr) const;
+
+    /**
+     * Read a histogram that was written with serialize()
+     * @return false if the data is not valid
+     */
+    bool deserialize(std::istream &istr);
+
+private:
+    enum { BucketsPerDoubling = 8, SmallestExponent = -30, LargestExponent = 12 };
+    enum { Buckets = (LargestExponent - SmallestExponent) * BucketsPerDoubling };
+
+    static unsigned int bucket(double seconds);
+
+    /** Number of times in each bucket, empty until a time is added */
+    std::vector<unsigned long> _counts;
+    unsigned long _total;
+    double _min;
+    double _max;
 };
 
 struct TimerResultsData
 {
-    std::clock_t _clocks;
+    double _seconds;
     long _numberOfResults;
+    bool _hasTokens;
+    unsigned long _tokensBefore;
+    unsigned long _tokensAfter;
+
+    /** The times of the results, for the percentiles */
+    TimerHistogram _histogram;
 
     TimerResultsData()
-        : _clocks(0)
+        : _seconds(0)
         , _numberOfResults(0)
+        , _hasTokens(false)
+        , _tokensBefore(0)
+        , _tokensAfter(0)
     {
     }
 };
 
+/**
+ * The results of the timers. Each CppCheck instance has its own results,
+ * the results of the child processes are merged by the ThreadExecutor.
+ */
 class TimerResults : public TimerResultsIntf
 {
 public:
@@ -58,11 +131,36 @@ public:
     {
     }
 
-    void ShowResults();
-    virtual void AddResults(const std::string& str, std::clock_t clocks);
+    /**
+     * Write the results
+     * @param ostr where the results are written
+     * @param showtimeMode SHOWTIME_CSV and SHOWTIME_JSON give machine readable output, other modes give text
+     */
+    void ShowResults(std::ostream &ostr, unsigned int showtimeMode) const;
+
+    virtual void AddResults(const std::string& str, double seconds);
+    virtual void AddTokens(const std::string& str, unsigned long tokensBefore, unsigned long tokensAfter);
+
+    /** Checking the given file took the given time, in seconds */
+    void AddFileResults(const std::string& file, double seconds);
+
+    /** Add the results of another process or thread */
+    void Merge(const TimerResults &other);
+
+    /** Convert the results to a string, for sending them to another process */
+    std::string serialize() const;
+
+    /**
+     * Add results that were converted with serialize()
+     * @return false if the data is not valid
+     */
+    bool deserialize(const std::string &data);
 
 private:
     std::map<std::string, struct TimerResultsData> _results;
+
+    /** the time of each checked file */
+    std::map<std::string, double> _files;
 };
 
 class Timer
@@ -72,12 +170,15 @@ public:
     ~Timer();
     void Stop();
 
+    /** Time of a monotonic high resolution clock, in seconds */
+    static double now();
+
 private:
     Timer& operator=(const Timer&); // disallow assignments
 
     const std::string _str;
     const unsigned int _showtimeMode;
-    std::clock_t _start;
+    double _start;
     bool _stopped;
     TimerResultsIntf* _timerResults;
 };
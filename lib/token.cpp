@@ -19,80 +19,510 @@
 #include "token.h"
 #include "errorlogger.h"
 #include "check.h"
+#include "threading.h"
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <new>
 #include <string>
 #include <iostream>
 #include <cctype>
 #include <sstream>
 #include <map>
+#include <algorithm>
+
+//---------------------------------------------------------------------------
+
+namespace
+{
+    const char * const standardTypes[] =
+    {
+        "bool", "char", "short", "int", "long", "float", "double", "size_t", 0
+    };
+
+    const char * const keywords[] =
+    {
+        "asm", "auto", "break", "case", "catch", "class", "const", "const_cast",
+        "continue", "default", "delete", "do", "dynamic_cast", "else", "enum",
+        "explicit", "extern", "for", "friend", "goto", "if", "inline", "mutable",
+        "namespace", "new", "operator", "private", "protected", "public", "register",
+        "reinterpret_cast", "return", "signed", "sizeof", "static", "static_cast",
+        "struct", "switch", "template", "this", "throw", "try", "typedef", "typename",
+        "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", 0
+    };
+
+    const struct
+    {
+        const char *str;
+        Token::Kind kind;
+    } punctuators[] =
+    {
+        { "{", Token::eOpenBrace }, { "}", Token::eCloseBrace },
+        { "(", Token::eOpenParen }, { ")", Token::eCloseParen },
+        { "[", Token::eOpenBracket }, { "]", Token::eCloseBracket },
+        { ";", Token::eSemicolon }, { ",", Token::eComma },
+        { "=", Token::eAssignmentOp }, { "+=", Token::eAssignmentOp }, { "-=", Token::eAssignmentOp },
+        { "*=", Token::eAssignmentOp }, { "/=", Token::eAssignmentOp }, { "%=", Token::eAssignmentOp },
+        { "&=", Token::eAssignmentOp }, { "|=", Token::eAssignmentOp }, { "^=", Token::eAssignmentOp },
+        { "<<=", Token::eAssignmentOp }, { ">>=", Token::eAssignmentOp },
+        { "==", Token::eComparisonOp }, { "!=", Token::eComparisonOp },
+        { "<", Token::eComparisonOp }, { "<=", Token::eComparisonOp },
+        { ">", Token::eComparisonOp }, { ">=", Token::eComparisonOp },
+        { "+", Token::eArithmeticalOp }, { "-", Token::eArithmeticalOp }, { "*", Token::eArithmeticalOp },
+        { "/", Token::eArithmeticalOp }, { "%", Token::eArithmeticalOp },
+        { "<<", Token::eArithmeticalOp }, { ">>", Token::eArithmeticalOp },
+        { "&", Token::eBitOp }, { "|", Token::eBitOp }, { "^", Token::eBitOp }, { "~", Token::eBitOp },
+        { "&&", Token::eLogicalOp }, { "||", Token::eLogicalOp }, { "!", Token::eLogicalOp },
+        { "++", Token::eIncDecOp }, { "--", Token::eIncDecOp },
+        { 0, Token::eOther }
+    };
+
+    /** Other strings that are common in the token lists and in the Token::Match patterns */
+    const char * const otherCommonStrings[] =
+    {
+        "", "true", "false", "::", ".", "?", ":", "->", "...", "NULL", "0", "1",
+        "std", "free", "malloc", "strcpy", "strlen", 0
+    };
+
+    /**
+     * The common token strings, see Token::commonStrId. The ith string
+     * has the id i+1 in all the string pools.
+     * @return the ith common string, 0 if there are less strings
+     */
+    const char *commonString(unsigned int i)
+    {
+        for (unsigned int k = 0; standardTypes[k]; ++k, --i)
+        {
+            if (i == 0)
+                return standardTypes[k];
+        }
+        for (unsigned int k = 0; keywords[k]; ++k, --i)
+        {
+            if (i == 0)
+                return keywords[k];
+        }
+        for (unsigned int k = 0; punctuators[k].str; ++k, --i)
+        {
+            if (i == 0)
+                return punctuators[k].str;
+        }
+        for (unsigned int k = 0; otherCommonStrings[k]; ++k, --i)
+        {
+            if (i == 0)
+                return otherCommonStrings[k];
+        }
+        return 0;
+    }
+
+    /** Classify a token string, see Token::Kind */
+    Token::Kind classify(const std::string &s)
+    {
+        if (s.empty())
+            return Token::eOther;
+
+        const unsigned char c = static_cast<unsigned char>(s[0]);
+
+        if (std::isdigit(c) || (c == '-' && s.length() > 1 && std::isdigit(static_cast<unsigned char>(s[1]))))
+            return Token::eNumber;
+
+        if (c == '_' || std::isalpha(c))
+        {
+            if (s == "true" || s == "false")
+                return Token::eBoolean;
+
+            for (unsigned int i = 0; standardTypes[i]; ++i)
+            {
+                if (s == standardTypes[i])
+                    return Token::eStandardType;
+            }
+
+            for (unsigned int i = 0; keywords[i]; ++i)
+            {
+                if (s == keywords[i])
+                    return Token::eKeyword;
+            }
+
+            return Token::eName;
+        }
+
+        if (c == '\"')
+            return Token::eString;
+
+        if (c == '\'')
+            return Token::eChar;
+
+        for (unsigned int i = 0; punctuators[i].str; ++i)
+        {
+            if (s == punctuators[i].str)
+                return punctuators[i].kind;
+        }
+
+        return Token::eOther;
+    }
+
+    /** FNV-1a hash of a token string, see Token::strHash */
+    unsigned int hashString(const std::string &s)
+    {
+        unsigned int h = 2166136261U;
+        for (std::string::size_type i = 0; i < s.length(); ++i)
+        {
+            h ^= static_cast<unsigned char>(s[i]);
+            h *= 16777619U;
+        }
+        return h;
+    }
+}
+
+/**
+ * @brief Pool of token strings.
+ * Each unique token string is stored once. Each TokenArena and each
+ * thread has its own pool, so the reference counts are updated without
+ * a lock. Strings that no token refers to are removed when the pool
+ * would grow.
+ */
+class TokenStringPool
+{
+public:
+    TokenStringPool() : _empty(0), _commonCount(0), _nextId(0), _table(MinTableSize, 0)
+    {
+        // The common strings are added first so they have the same ids in
+        // all pools. They are never removed.
+        for (const char *common = commonString(0); common; common = commonString(_commonCount))
+        {
+            --add(common, hashString(common))->refs;
+            ++_commonCount;
+        }
+
+        // The empty string is used by all new tokens
+        _empty = intern("");
+        --_empty->refs;
+    }
+
+    ~TokenStringPool()
+    {
+        for (std::vector<TokenString *>::iterator it = _entries.begin(); it != _entries.end(); ++it)
+            delete *it;
+    }
+
+    /** @return the empty string, with a new reference */
+    TokenString *empty()
+    {
+        ++_empty->refs;
+        return _empty;
+    }
+
+    /** @return the interned string, with a new reference */
+    TokenString *intern(const std::string &s)
+    {
+        const unsigned int h = hashString(s);
+        const std::size_t mask = _table.size() - 1;
+        for (std::size_t index = h & mask; ; index = (index + 1) & mask)
+        {
+            const unsigned int slot = _table[index];
+
+            // New string
+            if (slot == 0)
+                return add(s, h);
+
+            TokenString *entry = _entries[slot - 1];
+            if (entry->hash == h && entry->str == s)
+            {
+                ++entry->refs;
+                return entry;
+            }
+        }
+    }
+
+private:
+    enum { MinTableSize = 1024 };
+
+    TokenString *_empty;
+
+    /** The common strings are the first entries */
+    unsigned int _commonCount;
+
+    /** Id of the next string that is added */
+    unsigned int _nextId;
+
+    /** The strings */
+    std::vector<TokenString *> _entries;
+
+    /** Hash table with index+1 of the entries. 0 is an empty slot */
+    std::vector<unsigned int> _table;
+
+    TokenString *add(const std::string &s, unsigned int h)
+    {
+        // Keep the table at most half full. Before it grows the unused
+        // strings are removed.
+        if ((_entries.size() + 1) * 2 > _table.size())
+            rebuild();
+
+        TokenString *entry = new TokenString(s, h, ++_nextId, this);
+        entry->refs = 1;
+        _entries.push_back(entry);
+        insert(h, static_cast<unsigned int>(_entries.size()));
+        return entry;
+    }
+
+    void insert(unsigned int h, unsigned int slot)
+    {
+        const std::size_t mask = _table.size() - 1;
+        std::size_t index = h & mask;
+        while (_table[index] != 0)
+            index = (index + 1) & mask;
+        _table[index] = slot;
+    }
+
+    /** Remove the unused strings and resize the table so it is at most a quarter full */
+    void rebuild()
+    {
+        std::vector<TokenString *>::size_type used = 0;
+        for (std::vector<TokenString *>::size_type i = 0; i < _entries.size(); ++i)
+        {
+            if (_entries[i]->refs == 0 && _entries[i]->id > _commonCount)
+                delete _entries[i];
+            else
+                _entries[used++] = _entries[i];
+        }
+        _entries.resize(used);
+
+        std::size_t size = MinTableSize;
+        while ((_entries.size() + 1) * 4 > size)
+            size *= 2;
+        std::vector<unsigned int>(size, 0).swap(_table);
+        for (std::vector<TokenString *>::size_type i = 0; i < _entries.size(); ++i)
+            insert(_entries[i]->hash, static_cast<unsigned int>(i + 1));
+    }
+};
+
+namespace
+{
+    /**
+     * The string pools of the threads. It is not a function-local static
+     * because their initialization is not thread-safe with every compiler.
+     */
+    ThreadLocal<TokenStringPool> threadStringPools;
+}
+
+/** The string pool of the current thread, for the tokens that are not in an arena */
+static TokenStringPool &threadStringPool()
+{
+    return threadStringPools.get();
+}
+
+TokenString::TokenString(const std::string &s, unsigned int h, unsigned int i, TokenStringPool *p) :
+    str(s),
+    hash(h),
+    id(i),
+    pool(p),
+    kind(static_cast<unsigned char>(classify(s))),
+    refs(0)
+{
+}
 
 Token::Token(Token **t) :
+    _next(0),
+    _previous(0),
+    _link(0),
+    _str(threadStringPool().empty()),
     tokensBack(t),
-    _str(""),
-    _isName(false),
-    _isNumber(false),
-    _isBoolean(false),
+    _arena(0),
+    _varId(0),
+    _fileIndex(0),
+    _linenr(0),
+    _kind(eOther),
     _isUnsigned(false),
     _isSigned(false),
     _isLong(false),
     _isUnused(false),
-    _varId(0),
+    _isUnchangedScope(false),
+    _progressValue(0)
+{
+}
+
+Token::Token(Token **t, TokenArena *arena) :
     _next(0),
     _previous(0),
     _link(0),
+    _str(arena->strings().empty()),
+    tokensBack(t),
+    _arena(arena),
+    _varId(0),
     _fileIndex(0),
     _linenr(0),
+    _kind(eOther),
+    _isUnsigned(false),
+    _isSigned(false),
+    _isLong(false),
+    _isUnused(false),
+    _isUnchangedScope(false),
     _progressValue(0)
 {
 }
 
 Token::~Token()
 {
+    // A token that is not in an arena uses the string pool of the thread
+    // that created it, it must be deleted by that thread
+    assert(_arena || _str->pool == &threadStringPool());
+    --_str->refs;
+}
+
+void Token::destroy(Token *tok)
+{
+    TokenArena * const arena = tok->_arena;
+    if (arena)
+    {
+        tok->~Token();
+        arena->deallocate(tok);
+    }
+    else
+    {
+        delete tok;
+    }
+}
 
+//---------------------------------------------------------------------------
+
+TokenArena::TokenArena() : _freeList(0), _next(0), _end(0), _useSlabs(true), _strings(0), _patterns(0)
+{
 }
 
-void Token::str(const std::string &s)
+TokenArena::~TokenArena()
 {
-    _str = s;
+    release();
+}
 
-    _isName = bool(_str[0] == '_' || std::isalpha(_str[0]));
+Token *TokenArena::newToken(Token **tokensBack)
+{
+    void *p;
+    if (!_useSlabs)
+        p = ::operator new(sizeof(Token));
 
-    if (std::isdigit(_str[0]))
-        _isNumber = true;
-    else if (_str.length() > 1 && _str[0] == '-' && std::isdigit(_str[1]))
-        _isNumber = true;
-    else
-        _isNumber = false;
+    else if (_freeList)
+    {
+        p = _freeList;
+        _freeList = *static_cast<void **>(p);
+    }
 
-    if (_str == "true" || _str == "false")
-        _isBoolean = true;
     else
-        _isBoolean = false;
+    {
+        if (_next == _end)
+        {
+            char *memory = static_cast<char *>(::operator new(SlabTokens * sizeof(Token) + CacheLineSize));
+            _slabs.push_back(memory);
+
+            // Align the slab to the cache lines
+            const std::size_t misalignment = reinterpret_cast<std::size_t>(memory) % CacheLineSize;
+            _next = misalignment ? memory + (CacheLineSize - misalignment) : memory;
+            _end = _next + SlabTokens * sizeof(Token);
+        }
+
+        p = _next;
+        _next += sizeof(Token);
+    }
+
+    return new (p) Token(tokensBack, this);
+}
+
+void TokenArena::deallocate(Token *tok)
+{
+    if (!_useSlabs)
+    {
+        ::operator delete(tok);
+        return;
+    }
 
+    *reinterpret_cast<void **>(tok) = _freeList;
+    _freeList = tok;
+}
+
+void TokenArena::release()
+{
+    for (std::vector<char *>::iterator it = _slabs.begin(); it != _slabs.end(); ++it)
+        ::operator delete(*it);
+    _slabs.clear();
+    _freeList = 0;
+    _next = _end = 0;
+
+    delete _strings;
+    _strings = 0;
+
+    // The arena can be used by another thread after it is released
+    _patterns = 0;
+}
+
+void TokenArena::useSlabs(bool slabs)
+{
+    assert(empty());
+    _useSlabs = slabs;
+}
+
+TokenStringPool &TokenArena::strings()
+{
+    if (!_strings)
+        _strings = new TokenStringPool;
+    return *_strings;
+}
+
+//---------------------------------------------------------------------------
+
+unsigned int Token::strHash(const std::string &s)
+{
+    return hashString(s);
+}
+
+unsigned int Token::commonStrId(const std::string &s)
+{
+    for (unsigned int i = 0; commonString(i); ++i)
+    {
+        if (s == commonString(i))
+            return i + 1;
+    }
+    return 0;
+}
+
+void Token::intern(const std::string &s)
+{
+    setString((_arena ? _arena->strings() : threadStringPool()).intern(s));
+}
+
+void Token::setString(TokenString *s)
+{
+    assert(_arena || _str->pool == &threadStringPool());
+    --_str->refs;
+    _str = s;
+    _kind = s->kind;
+}
+
+void Token::str(const std::string &s)
+{
+    intern(s);
     _varId = 0;
 }
 
 void Token::concatStr(std::string const& b)
 {
-    _str.erase(_str.length() - 1);
-    _str.append(b.begin() + 1, b.end());
+    std::string s(_str->str);
+    s.erase(s.length() - 1);
+    s.append(b.begin() + 1, b.end());
+    intern(s);
 }
 
 std::string Token::strValue() const
 {
-    assert(_str.length() >= 2);
-    assert(_str[0] == '"');
-    assert(_str[_str.length()-1] == '"');
-    return _str.substr(1, _str.length() - 2);
+    const std::string &text = _str->str;
+    assert(text.length() >= 2);
+    assert(text[0] == '"');
+    assert(text[text.length()-1] == '"');
+    return text.substr(1, text.length() - 2);
 }
 
 void Token::deleteNext()
 {
     Token *n = _next;
     _next = n->next();
-    delete n;
+    destroy(n);
     if (_next)
         _next->previous(this);
     else if (tokensBack)
@@ -103,11 +533,18 @@ void Token::deleteThis()
 {
     if (_next)
     {
-        _str = _next->_str;
-        _isName = _next->_isName;
-        _isNumber = _next->_isNumber;
-        _isBoolean = _next->_isBoolean;
+        // The string can be shared if it is in the same pool
+        if (_next->_arena == _arena)
+        {
+            ++_next->_str->refs;
+            setString(_next->_str);
+        }
+        else
+        {
+            intern(_next->str());
+        }
         _isUnused = _next->_isUnused;
+        _isUnchangedScope = _next->_isUnchangedScope;
         _varId = _next->_varId;
         _fileIndex = _next->_fileIndex;
         _linenr = _next->_linenr;
@@ -158,7 +595,7 @@ void Token::replace(Token *replaceThis, Token *start, Token *end)
     }
 
     // Delete old token, which is replaced
-    delete replaceThis;
+    destroy(replaceThis);
 }
 
 const Token *Token::tokAt(int index) const
@@ -194,7 +631,7 @@ Token *Token::tokAt(int index)
 std::string Token::strAt(int index) const
 {
     const Token *tok = this->tokAt(index);
-    return tok ? tok->_str.c_str() : "";
+    return tok ? tok->_str->str : std::string();
 }
 
 int Token::multiCompare(const char *haystack, const char *needle)
@@ -277,7 +714,7 @@ bool Token::simpleMatch(const Token *tok, const char pattern[])
     {
         size_t length = static_cast<size_t>(next - current);
 
-        if (!tok || length != tok->_str.length() || strncmp(current, tok->_str.c_str(), length))
+        if (!tok || length != tok->str().length() || strncmp(current, tok->str().c_str(), length))
             return false;
 
         current = next;
@@ -342,7 +779,7 @@ int Token::firstWordLen(const char *str)
     return len;
 }
 
-bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
+bool Token::interpretedMatch(const Token *tok, const char pattern[], unsigned int varid)
 {
     const char *p = pattern;
     bool firstpattern = true;
@@ -449,7 +886,7 @@ bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
 
             else if (firstWordEquals(p, "%str%") == 0)
             {
-                if (tok->_str[0] != '\"')
+                if (tok->str()[0] != '\"')
                     return false;
                 p += 5;
             }
@@ -468,9 +905,16 @@ bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
                 p += 6;
             }
 
-            else if (firstWordEquals(p, tok->_str.c_str()))
+            else if (firstWordEquals(p, "%op%") == 0)
+            {
+                if (!tok->isOp())
+                    return false;
+                p += 4;
+            }
+
+            else if (firstWordEquals(p, tok->str().c_str()))
             {
-                p += tok->_str.length();
+                p += tok->str().length();
             }
 
             else
@@ -483,7 +927,7 @@ bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
         }
 
         // [.. => search for a one-character token..
-        else if (p[0] == '[' && tok->_str.length() == 1 && chrInFirstWord(p, ']'))
+        else if (p[0] == '[' && tok->str().length() == 1 && chrInFirstWord(p, ']'))
         {
             const char *temp = p + 1;
             bool chrFound = false;
@@ -497,7 +941,7 @@ bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
                     continue;
                 }
 
-                if (*temp == tok->_str[0])
+                if (*temp == tok->str()[0])
                 {
                     chrFound = true;
                     break;
@@ -508,7 +952,7 @@ bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
 
             if (count > 1)
             {
-                if (tok->_str[0] == ']')
+                if (tok->str()[0] == ']')
                     chrFound = true;
             }
 
@@ -519,7 +963,7 @@ bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
         // Parse multi options, such as void|int|char (accept token which is one of these 3)
         else if (chrInFirstWord(p, '|') && (p[0] != '|' || firstWordLen(p) > 2))
         {
-            int res = multiCompare(p, tok->_str.c_str());
+            int res = multiCompare(p, tok->str().c_str());
             if (res == 0)
             {
                 // Empty alternative matches, use the same token on next round
@@ -541,7 +985,7 @@ bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
                 return false;
         }
 
-        else if (firstWordEquals(p, tok->_str.c_str()) != 0)
+        else if (firstWordEquals(p, tok->str().c_str()) != 0)
         {
             return false;
         }
@@ -556,6 +1000,711 @@ bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
     return true;
 }
 
+//---------------------------------------------------------------------------
+// Compiled patterns for Token::Match
+//---------------------------------------------------------------------------
+
+namespace
+{
+    /** One space separated word of a Token::Match pattern */
+    struct MatchWord
+    {
+        enum Kind { Literal, Multi, Not, Var, Type, Any, VarId, Num, Bool, Str, Or, OrOr, Op, Unknown };
+
+        MatchWord() : kind(Literal), notPrefix(false), charClass(false), tokenKinds(0), textHash(0), textId(0), emptyAlternative(false), kinds(~0U), end(0)
+        {
+            for (unsigned int i = 0; i < 8; ++i)
+                chars[i] = 0;
+        }
+
+        Kind kind;
+
+        /** The word starts with "!!". Such words are skipped at the start and end of the token list */
+        bool notPrefix;
+
+        /** "[abc]" word. This is used for tokens that have one character */
+        bool charClass;
+        unsigned int chars[8];
+
+        /**
+         * Bitmask of Token::Kind. It is used instead of the characters when
+         * all the characters of a "[abc]" word have a Token::Kind of their own.
+         */
+        unsigned int tokenKinds;
+
+        /**
+         * Literal text, its Token::strHash and its Token::commonStrId
+         * (Literal, Not). The id is also used by Or and OrOr.
+         */
+        std::string text;
+        unsigned int textHash;
+        unsigned int textId;
+
+        /** The "a|b|c" alternatives, their Token::strHash and their Token::commonStrId (Multi) */
+        std::vector<std::string> alternatives;
+        std::vector<unsigned int> alternativeHashes;
+        std::vector<unsigned int> alternativeIds;
+        bool emptyAlternative;
+
+        /** Bitmask of the Token::Kind of the tokens that the word can match */
+        unsigned int kinds;
+
+        /** Length of the pattern up to and including the delimiter after the word */
+        std::string::size_type end;
+
+        bool hasChar(unsigned char c) const
+        {
+            return (chars[c >> 5] >> (c & 31)) & 1;
+        }
+
+        void addChar(unsigned char c)
+        {
+            chars[c >> 5] |= 1U << (c & 31);
+        }
+    };
+
+    /**
+     * Token::Kind bitmask for the characters of a "[abc]" word. If some
+     * character doesn't have a Token::Kind of its own, 0 is returned.
+     */
+    unsigned int punctuatorKinds(const MatchWord &word)
+    {
+        unsigned int kinds = 0;
+        for (unsigned int c = 0; c < 256; ++c)
+        {
+            if (!word.hasChar(static_cast<unsigned char>(c)))
+                continue;
+
+            Token::Kind kind;
+            switch (c)
+            {
+            case '{':
+                kind = Token::eOpenBrace;
+                break;
+            case '}':
+                kind = Token::eCloseBrace;
+                break;
+            case '(':
+                kind = Token::eOpenParen;
+                break;
+            case ')':
+                kind = Token::eCloseParen;
+                break;
+            case '[':
+                kind = Token::eOpenBracket;
+                break;
+            case ']':
+                kind = Token::eCloseBracket;
+                break;
+            case ';':
+                kind = Token::eSemicolon;
+                break;
+            case ',':
+                kind = Token::eComma;
+                break;
+            default:
+                return 0;
+            }
+            kinds |= 1U << kind;
+        }
+        return kinds;
+    }
+
+    /**
+     * Bitmask of the Token::Kind of the tokens that can match the given
+     * literal text. Token::Match also matches a token that continues
+     * with a space after the text.
+     */
+    unsigned int literalKinds(const std::string &text)
+    {
+        return (1U << classify(text)) | (1U << classify(text + " "));
+    }
+
+    /** Compare word with token. @return 1 if equal, 0 if not equal, -1 if it should be interpreted */
+    inline int compareWord(const MatchWord &word, const Token *tok)
+    {
+        // A common string is compared by its id
+        if (word.textId)
+        {
+            if (tok->strId() == word.textId)
+                return 1;
+        }
+        else if (tok->strHash() == word.textHash && tok->str() == word.text)
+        {
+            return 1;
+        }
+
+        // Token::firstWordEquals continues to compare after a space
+        const std::string &str = tok->str();
+        const std::string::size_type len = word.text.length();
+        if (str.length() > len && str[len] == ' ' && str.compare(0, len, word.text) == 0)
+            return -1;
+
+        return 0;
+    }
+}
+
+/** A compiled Token::Match pattern */
+class CompiledPattern
+{
+public:
+    explicit CompiledPattern(const char pattern[]) : text(pattern), leadingNots(0), firstKinds(~0U)
+    {
+        compile();
+    }
+
+    std::string text;
+    std::vector<MatchWord> words;
+
+    /** Number of "!!" words at the start of the pattern */
+    std::vector<MatchWord>::size_type leadingNots;
+
+    /** Bitmask of the Token::Kind of the first tokens that can match */
+    unsigned int firstKinds;
+
+    enum Result { NoMatch, Matched, Interpret };
+
+    /**
+     * Match the tokens.
+     * @param tok first token
+     * @param varid varid for %varid%
+     * @param used set to the length of the pattern that the result depends on
+     * @return result. If the pattern can't be matched by the compiled pattern, Interpret is returned.
+     */
+    Result match(const Token *tok, unsigned int varid, std::string::size_type &used) const;
+
+private:
+    void compile();
+};
+
+void CompiledPattern::compile()
+{
+    std::string::size_type pos = 0;
+    while (pos < text.length())
+    {
+        if (text[pos] == ' ')
+        {
+            ++pos;
+            continue;
+        }
+
+        std::string::size_type wordEnd = text.find(' ', pos);
+        if (wordEnd == std::string::npos)
+            wordEnd = text.length();
+        const std::string word(text.substr(pos, wordEnd - pos));
+
+        MatchWord w;
+        w.end = wordEnd + 1;
+
+        // "!!" is a not pattern if it is followed by something
+        w.notPrefix = bool(word.compare(0, 2, "!!") == 0 && (word.length() > 2 || wordEnd < text.length()));
+
+        if (word[0] == '%')
+        {
+            if (word == "%var%")
+                w.kind = MatchWord::Var;
+            else if (word == "%type%")
+                w.kind = MatchWord::Type;
+            else if (word == "%any%")
+                w.kind = MatchWord::Any;
+            else if (word == "%varid%")
+                w.kind = MatchWord::VarId;
+            else if (word == "%num%")
+                w.kind = MatchWord::Num;
+            else if (word == "%bool%")
+                w.kind = MatchWord::Bool;
+            else if (word == "%str%")
+                w.kind = MatchWord::Str;
+            else if (word == "%or%")
+                w.kind = MatchWord::Or;
+            else if (word == "%oror%")
+                w.kind = MatchWord::OrOr;
+            else if (word == "%op%")
+                w.kind = MatchWord::Op;
+            else
+                w.kind = MatchWord::Unknown;
+
+            const unsigned int nameKinds = (1U << Token::eName) | (1U << Token::eKeyword) | (1U << Token::eStandardType) | (1U << Token::eBoolean);
+            const unsigned int opKinds = (1U << Token::eComparisonOp) | (1U << Token::eArithmeticalOp) | (1U << Token::eBitOp) | (1U << Token::eLogicalOp);
+            switch (w.kind)
+            {
+            case MatchWord::Var:
+            case MatchWord::Type:
+                w.kinds = nameKinds;
+                break;
+            case MatchWord::Num:
+                w.kinds = 1U << Token::eNumber;
+                break;
+            case MatchWord::Bool:
+                w.kinds = 1U << Token::eBoolean;
+                break;
+            case MatchWord::Str:
+                w.kinds = 1U << Token::eString;
+                break;
+            case MatchWord::Or:
+                w.kinds = 1U << Token::eBitOp;
+                w.textId = Token::commonStrId("|");
+                break;
+            case MatchWord::OrOr:
+                w.kinds = 1U << Token::eLogicalOp;
+                w.textId = Token::commonStrId("||");
+                break;
+            case MatchWord::Op:
+                w.kinds = opKinds;
+                break;
+            default:
+                break;
+            }
+
+            words.push_back(w);
+            pos = wordEnd;
+            continue;
+        }
+
+        if (word[0] == '[' && word.find(']') != std::string::npos)
+        {
+            w.charClass = true;
+            unsigned int count = 0;
+            for (std::string::size_type i = 1; i < word.length(); ++i)
+            {
+                if (word[i] == ']')
+                    ++count;
+                else
+                    w.addChar(static_cast<unsigned char>(word[i]));
+            }
+            if (count > 1)
+                w.addChar(']');
+        }
+
+        if (word.find('|') != std::string::npos && (word[0] != '|' || word.length() > 2))
+        {
+            w.kind = MatchWord::Multi;
+            w.kinds = 0;
+            std::string::size_type start = 0;
+            for (;;)
+            {
+                const std::string::size_type bar = word.find('|', start);
+                const std::string alternative(word.substr(start, bar == std::string::npos ? std::string::npos : bar - start));
+                if (alternative.empty())
+                    w.emptyAlternative = true;
+                w.alternatives.push_back(alternative);
+                w.alternativeHashes.push_back(Token::strHash(alternative));
+                w.alternativeIds.push_back(Token::commonStrId(alternative));
+                w.kinds |= literalKinds(alternative);
+                if (bar == std::string::npos)
+                    break;
+                start = bar + 1;
+            }
+            if (w.emptyAlternative || w.charClass)
+                w.kinds = ~0U;
+        }
+
+        else if (w.notPrefix)
+        {
+            w.kind = MatchWord::Not;
+            w.text = word.substr(2);
+            w.textHash = Token::strHash(w.text);
+            w.textId = Token::commonStrId(w.text);
+        }
+
+        else
+        {
+            w.text = word;
+            w.textHash = Token::strHash(w.text);
+            w.textId = Token::commonStrId(w.text);
+            if (w.charClass)
+            {
+                w.tokenKinds = punctuatorKinds(w);
+                if (w.tokenKinds)
+                    w.kinds = w.tokenKinds;
+            }
+            else
+                w.kinds = literalKinds(w.text);
+        }
+
+        words.push_back(w);
+        pos = wordEnd;
+    }
+
+    while (leadingNots < words.size() && words[leadingNots].notPrefix)
+        ++leadingNots;
+
+    firstKinds = (words.empty() || leadingNots > 0) ? ~0U : words[0].kinds;
+}
+
+CompiledPattern::Result CompiledPattern::match(const Token *tok, unsigned int varid, std::string::size_type &used) const
+{
+    std::vector<MatchWord>::size_type i = 0;
+
+    // If we are in the first token, we skip all initial !! patterns
+    if (leadingNots && tok && !tok->previous() && tok->next())
+        i = leadingNots;
+
+    for (; i < words.size(); ++i)
+    {
+        const MatchWord &w = words[i];
+        used = w.end;
+
+        if (!tok)
+        {
+            // If we have no tokens, pattern "!!else" should return true
+            if (w.notPrefix)
+                continue;
+            return NoMatch;
+        }
+
+        const std::string &str = tok->str();
+
+        switch (w.kind)
+        {
+        case MatchWord::Var:
+            if (!tok->isName())
+                return NoMatch;
+            break;
+
+        case MatchWord::Type:
+            if (!tok->isName() || tok->varId() != 0 || tok->str() == "delete")
+                return NoMatch;
+            break;
+
+        case MatchWord::Any:
+            break;
+
+        case MatchWord::VarId:
+            if (varid == 0)
+            {
+                std::list<ErrorLogger::ErrorMessage::FileLocation> locationList;
+                const ErrorLogger::ErrorMessage errmsg(locationList,
+                                                       Severity::error,
+                                                       "Internal error. Token::Match called with varid 0.",
+                                                       "cppcheckError");
+                Check::reportError(errmsg);
+            }
+            if (tok->varId() != varid)
+                return NoMatch;
+            break;
+
+        case MatchWord::Num:
+            if (!tok->isNumber())
+                return NoMatch;
+            break;
+
+        case MatchWord::Bool:
+            if (!tok->isBoolean())
+                return NoMatch;
+            break;
+
+        case MatchWord::Str:
+            if (tok->kind() != Token::eString)
+                return NoMatch;
+            break;
+
+        case MatchWord::Or:
+        case MatchWord::OrOr:
+            if (tok->strId() != w.textId)
+                return NoMatch;
+            break;
+
+        case MatchWord::Op:
+            if (!tok->isOp())
+                return NoMatch;
+            break;
+
+        case MatchWord::Unknown:
+            // Unknown %..% words are handled by Token::interpretedMatch
+            return Interpret;
+
+        case MatchWord::Literal:
+        case MatchWord::Not:
+        case MatchWord::Multi:
+            if (w.tokenKinds)
+            {
+                if (!((w.tokenKinds >> tok->kind()) & 1U))
+                    return NoMatch;
+            }
+
+            else if (w.charClass && str.length() == 1)
+            {
+                if (!w.hasChar(static_cast<unsigned char>(str[0])))
+                    return NoMatch;
+            }
+
+            else if (w.kind == MatchWord::Multi)
+            {
+                // Token::multiCompare handles '|' and ' ' in the token specially
+                if (str.find_first_of("| ") != std::string::npos)
+                    return Interpret;
+
+                bool found = false;
+                const unsigned int id = tok->strId();
+                const unsigned int hash = tok->strHash();
+                for (std::vector<unsigned int>::size_type k = 0; k < w.alternativeHashes.size(); ++k)
+                {
+                    if (w.alternativeIds[k] ? (w.alternativeIds[k] == id) : (w.alternativeHashes[k] == hash && w.alternatives[k] == str))
+                    {
+                        found = true;
+                        break;
+                    }
+                }
+
+                if (!found)
+                {
+                    if (!w.emptyAlternative)
+                        return NoMatch;
+
+                    // Empty alternative matches, use the same token on next round
+                    continue;
+                }
+            }
+
+            else
+            {
+                const int res = compareWord(w, tok);
+                if (res < 0)
+                    return Interpret;
+                if ((res == 1) == (w.kind == MatchWord::Not))
+                    return NoMatch;
+            }
+            break;
+        }
+
+        tok = tok->next();
+    }
+
+    used = text.length() + 1;
+    return Matched;
+}
+
+MatchPattern::MatchPattern(const char pattern[]) :
+    _compiled(new CompiledPattern(pattern)),
+    _firstKinds(_compiled->firstKinds)
+{
+}
+
+MatchPattern::~MatchPattern()
+{
+    delete _compiled;
+}
+
+namespace
+{
+    /** @brief The patterns of matchPatternAt(), they are deleted at exit */
+    class CallSitePatterns
+    {
+    public:
+        CallSitePatterns()
+        { }
+
+        ~CallSitePatterns()
+        {
+            for (std::vector<MatchPattern *>::iterator it = patterns.begin(); it != patterns.end(); ++it)
+                delete *it;
+        }
+
+        Mutex mutex;
+        std::vector<MatchPattern *> patterns;
+
+    private:
+        // Not implemented..
+        CallSitePatterns(const CallSitePatterns &);
+        CallSitePatterns &operator=(const CallSitePatterns &);
+    };
+
+    CallSitePatterns callSitePatterns;
+}
+
+const MatchPattern *MatchPattern::compileOnce(const MatchPattern * volatile *slot, const char pattern[])
+{
+    MutexLock lock(callSitePatterns.mutex);
+    if (!*slot)
+    {
+        MatchPattern * const compiled = new MatchPattern(pattern);
+        callSitePatterns.patterns.push_back(compiled);
+
+        // The pattern must be complete before the other threads can see it
+        memoryBarrier();
+        *slot = compiled;
+    }
+    return *slot;
+}
+
+
+bool MatchPattern::compiledMatch(const Token *tok, unsigned int varid) const
+{
+    std::string::size_type used;
+    const CompiledPattern::Result result = _compiled->match(tok, varid, used);
+    if (result == CompiledPattern::Interpret)
+        return Token::interpretedMatch(tok, _compiled->text.c_str(), varid);
+    return bool(result == CompiledPattern::Matched);
+}
+
+//---------------------------------------------------------------------------
+
+/**
+ * @brief The compiled Token::Match patterns of a thread.
+ *
+ * The patterns are cached by their address in a two-way set associative
+ * table, so a lookup costs a few comparisons instead of parsing the
+ * pattern. Most patterns are string literals. A pattern that is built at
+ * runtime can have the same address as an earlier pattern with another
+ * text. So after a match, the part of the pattern that the result
+ * depends on is compared with the compiled text. That is usually just
+ * the first word. If the text at an address has changed, that address is
+ * not compiled again but the pattern is parsed by Token::interpretedMatch.
+ *
+ * A pattern is compiled the second time its address is seen, so the
+ * patterns that are built and used once are not compiled.
+ */
+class PatternCache
+{
+public:
+    PatternCache() : _entries(Sets * 2)
+    { }
+
+    ~PatternCache()
+    {
+        for (std::vector<Entry>::iterator it = _entries.begin(); it != _entries.end(); ++it)
+            delete it->compiled;
+    }
+
+    /**
+     * Match the tokens with the compiled pattern.
+     * @param tok first token, not 0
+     * @param pattern the pattern
+     * @param varid varid for %varid%
+     * @param result set to the result of the match
+     * @return false if the pattern must be parsed by Token::interpretedMatch instead
+     */
+    bool match(const Token *tok, const char pattern[], unsigned int varid, bool &result)
+    {
+        Entry * const entry = find(pattern);
+        if (!entry)
+            return false;
+
+        const CompiledPattern &compiled = *entry->compiled;
+        CompiledPattern::Result r;
+        std::string::size_type used;
+
+        // Most tokens can be rejected by their kind
+        if (!((compiled.firstKinds >> tok->kind()) & 1U))
+        {
+            r = CompiledPattern::NoMatch;
+            used = compiled.words[0].end;
+        }
+        else
+        {
+            r = compiled.match(tok, varid, used);
+        }
+
+        // The text at the address has been changed
+        if (std::strncmp(compiled.text.c_str(), pattern, used) != 0)
+        {
+            delete entry->compiled;
+            entry->compiled = 0;
+            entry->changed = true;
+            entry->hits = 0;
+            return false;
+        }
+
+        if (r == CompiledPattern::Interpret)
+            return false;
+
+        result = bool(r == CompiledPattern::Matched);
+        return true;
+    }
+
+private:
+    // Not implemented..
+    PatternCache(const PatternCache &);
+    PatternCache &operator=(const PatternCache &);
+
+    enum { Sets = 2048, MaxHits = 15 };
+
+    struct Entry
+    {
+        Entry() : pattern(0), compiled(0), hits(0), changed(false)
+        { }
+
+        const char *pattern;
+
+        /** The compiled pattern, 0 until the address is seen the second time */
+        CompiledPattern *compiled;
+
+        unsigned int hits;
+
+        /** Has the text at the address changed? */
+        bool changed;
+    };
+
+    std::vector<Entry> _entries;
+
+    /** @return the entry with the compiled pattern, 0 if the pattern should be parsed */
+    Entry *find(const char pattern[])
+    {
+        const std::size_t address = reinterpret_cast<std::size_t>(pattern);
+        Entry * const set = &_entries[(((address >> 3) ^ (address >> 13)) & (Sets - 1)) * 2];
+
+        for (unsigned int way = 0; way < 2; ++way)
+        {
+            Entry &entry = set[way];
+            if (entry.pattern != pattern)
+                continue;
+
+            if (!entry.compiled)
+            {
+                if (entry.changed)
+                    return 0;
+
+                // Second time the address is seen
+                entry.compiled = new CompiledPattern(pattern);
+                entry.hits = 1;
+                return &entry;
+            }
+
+            if (entry.hits < MaxHits)
+                ++entry.hits;
+            return &entry;
+        }
+
+        // Replace the entry that is used the least. An entry that is used
+        // a lot is not replaced until it has missed as often.
+        Entry &victim = (set[0].hits <= set[1].hits) ? set[0] : set[1];
+        if (victim.hits > 0)
+        {
+            --victim.hits;
+            return 0;
+        }
+
+        delete victim.compiled;
+        victim.pattern = pattern;
+        victim.compiled = 0;
+        victim.changed = false;
+        return 0;
+    }
+};
+
+namespace
+{
+    /** The compiled patterns of each thread */
+    ThreadLocal<PatternCache> patternCaches;
+}
+
+PatternCache &TokenArena::patterns()
+{
+    if (!_patterns)
+        _patterns = &patternCaches.get();
+    return *_patterns;
+}
+
+bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
+{
+    // The tokens of an arena use the compiled patterns
+    bool result;
+    if (tok && tok->_arena && tok->_arena->patterns().match(tok, pattern, varid, result))
+        return result;
+    return interpretedMatch(tok, pattern, varid);
+}
+
 size_t Token::getStrLength(const Token *tok)
 {
     assert(tok != NULL);
@@ -582,15 +1731,6 @@ size_t Token::getStrLength(const Token *tok)
     return len;
 }
 
-bool Token::isStandardType() const
-{
-    bool ret = false;
-    const char *type[] = {"bool", "char", "short", "int", "long", "float", "double", "size_t", 0};
-    for (int i = 0; type[i]; i++)
-        ret |= (_str == type[i]);
-    return ret;
-}
-
 void Token::move(Token *srcStart, Token *srcEnd, Token *newLocation)
 {
     /**[newLocation] -> b -> c -> [srcStart] -> [srcEnd] -> f */
@@ -616,9 +1756,11 @@ void Token::move(Token *srcStart, Token *srcEnd, Token *newLocation)
 
 const Token *Token::findmatch(const Token *tok, const char pattern[], unsigned int varId)
 {
+    // The search usually visits many tokens, so compile the pattern once
+    const MatchPattern matchPattern(pattern);
     for (; tok; tok = tok->next())
     {
-        if (Token::Match(tok, pattern, varId))
+        if (matchPattern.match(tok, varId))
             return tok;
     }
     return 0;
@@ -626,9 +1768,10 @@ const Token *Token::findmatch(const Token *tok, const char pattern[], unsigned i
 
 const Token *Token::findmatch(const Token *tok, const char pattern[], const Token *end, unsigned int varId)
 {
+    const MatchPattern matchPattern(pattern);
     for (; tok && tok != end; tok = tok->next())
     {
-        if (Token::Match(tok, pattern, varId))
+        if (matchPattern.match(tok, varId))
             return tok;
     }
     return 0;
@@ -636,7 +1779,8 @@ const Token *Token::findmatch(const Token *tok, const char pattern[], const Toke
 
 void Token::insertToken(const std::string &tokenStr)
 {
-    Token *newToken = new Token(tokensBack);
+    // The new token is allocated from the same arena as this token
+    Token *newToken = _arena ? _arena->newToken(tokensBack) : new Token(tokensBack);
     newToken->str(tokenStr);
     newToken->_linenr = _linenr;
     newToken->_fileIndex = _fileIndex;
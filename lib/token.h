@@ -22,6 +22,45 @@
 #include <string>
 #include <vector>
 
+class MatchPattern;
+class PatternCache;
+class TokenArena;
+class TokenStringPool;
+
+/**
+ * @brief An interned token string.
+ * The strings of the tokens in a TokenArena are in the pool of the arena.
+ * Each thread has a pool for the strings of the other tokens. The tokens
+ * count their references to the string, when there are no references
+ * left the string can be removed from the pool.
+ */
+struct TokenString
+{
+    TokenString(const std::string &s, unsigned int h, unsigned int i, TokenStringPool *p);
+
+    const std::string str;
+
+    /** Hash of the string, see Token::strHash */
+    const unsigned int hash;
+
+    /** Id of the string in its pool, see Token::strId */
+    const unsigned int id;
+
+    /** The pool that the string is in */
+    TokenStringPool * const pool;
+
+    /** The Token::Kind of the string */
+    const unsigned char kind;
+
+    /** Number of tokens that use the string */
+    unsigned int refs;
+
+private:
+    // Not implemented..
+    TokenString(const TokenString &);
+    TokenString &operator=(const TokenString &);
+};
+
 /// @addtogroup Core
 /// @{
 
@@ -29,33 +68,80 @@
  * @brief The token list that the Tokenizer generates is a linked-list of this class.
  *
  * Tokens are stored as strings. The "if", "while", etc are stored in plain text.
+ * The strings are interned, each unique string is stored only once in a string pool.
+ * The tokens of a TokenArena use the pool of the arena. The other tokens
+ * use the pool of the thread that creates them. Such a token must be
+ * changed and deleted by that thread, and before that thread ends.
  * The reason the Token class is needed (instead of using the string class) is that some extra functionality is also needed for tokens:
  *  - location of the token is stored (linenr, fileIndex)
- *  - functions for classifying the token (isName, isNumber, isBoolean, isStandardType)
+ *  - functions for classifying the token (kind, isName, isNumber, isBoolean, isStandardType, isOp)
  *
  * The Token class also has other functions for management of token list, matching tokens, etc.
  */
 class Token
 {
 private:
-    Token **tokensBack;
-
     // Not implemented..
     Token();
+    Token(const Token &);
+    Token &operator=(const Token &);
+
+    /** Create a token in an arena, see TokenArena::newToken */
+    Token(Token **tokensBack, TokenArena *arena);
+
+    friend class TokenArena;
 
 public:
     Token(Token **tokensBack);
     ~Token();
 
+    /**
+     * Delete a token. A token that was allocated from a TokenArena is
+     * given back to its arena, other tokens are deleted with delete.
+     * The tokens of an arena must not be deleted with delete.
+     */
+    static void destroy(Token *tok);
+
     void str(const std::string &s);
 
     void concatStr(std::string const& b);
 
     const std::string &str() const
     {
-        return _str;
+        return _str->str;
+    }
+
+    /**
+     * Hash of the token string. Tokens that have the same string have
+     * the same hash. Different strings can have the same hash, so
+     * compare the strings when the hashes are equal.
+     */
+    unsigned int strHash() const
+    {
+        return _str->hash;
     }
 
+    /** Get the hash of the given token string */
+    static unsigned int strHash(const std::string &s);
+
+    /**
+     * Id of the token string. Tokens whose strings are in the same pool
+     * have the same id if and only if they have the same string, so the
+     * strings can be compared in O(1). The common strings, see
+     * commonStrId, have the same id in all pools.
+     */
+    unsigned int strId() const
+    {
+        return _str->id;
+    }
+
+    /**
+     * Get the id of a common token string, such as a keyword, a standard
+     * type or a punctuator. It is the same in all the string pools.
+     * @return the id, 0 if the string is not a common string
+     */
+    static unsigned int commonStrId(const std::string &s);
+
     /**
      * Unlink and delete next token.
      */
@@ -105,6 +191,7 @@ public:
      * - "%varid%" Match with parameter varid
      * - "%or%" A bitwise-or operator '|'
      * - "%oror%" A logical-or operator '||'
+     * - "%op%" Any arithmetical, comparison, bit or logical operator, e.g. "+", "==", "&" or "!"
      * - "[abc]" Any of the characters 'a' or 'b' or 'c'
      * - "int|void|char" Any of the strings, int, void or char
      * - "int|void|char|" Any of the strings, int, void or char or empty string
@@ -119,6 +206,11 @@ public:
      *
      * @todo pattern "%type%|%num%" should mean either a type or a num.
      *
+     * @note The pattern is compiled when it is used again, and the
+     * compiled pattern is cached by the address of the pattern, see
+     * PatternCache. The tokens that are not in a TokenArena are matched
+     * by parsing the pattern.
+     *
      * @param tok List of tokens to be compared to the pattern
      * @param pattern The pattern against which the tokens are compared,
      * e.g. "const" or ") const|volatile| {".
@@ -128,6 +220,14 @@ public:
      */
     static bool Match(const Token *tok, const char pattern[], unsigned int varid = 0);
 
+private:
+    friend class MatchPattern;
+
+    /** Same as Match, but the pattern is parsed while it is matched */
+    static bool interpretedMatch(const Token *tok, const char pattern[], unsigned int varid);
+
+public:
+
     /**
      * Return length of C-string.
      *
@@ -137,17 +237,66 @@ public:
      **/
     static size_t getStrLength(const Token *tok);
 
+    /**
+     * Classification of the token string. The kind is determined once
+     * for each unique token string, when it is interned.
+     */
+    enum Kind
+    {
+        eOther,
+        eName,              // name that is not classified below
+        eKeyword,           // if, return, new, const, ..
+        eStandardType,      // bool, char, short, int, long, float, double, size_t
+        eBoolean,           // true, false
+        eNumber,
+        eString,
+        eChar,
+        eOpenBrace,         // {
+        eCloseBrace,        // }
+        eOpenParen,         // (
+        eCloseParen,        // )
+        eOpenBracket,       // [
+        eCloseBracket,      // ]
+        eSemicolon,         // ;
+        eComma,             // ,
+        eAssignmentOp,      // = += -= *= /= %= &= |= ^= <<= >>=
+        eComparisonOp,      // == != < <= > >=
+        eArithmeticalOp,    // + - * / % << >>
+        eBitOp,             // & | ^ ~
+        eLogicalOp,         // && || !
+        eIncDecOp           // ++ --
+    };
+
+    Kind kind() const
+    {
+        return static_cast<Kind>(_kind);
+    }
+
     bool isName() const
     {
-        return _isName;
+        return _kind >= eName && _kind <= eBoolean;
     }
     bool isNumber() const
     {
-        return _isNumber;
+        return _kind == eNumber;
     }
     bool isBoolean() const
     {
-        return _isBoolean;
+        return _kind == eBoolean;
+    }
+
+    /** Is the token an arithmetical, comparison, bit or logical operator? */
+    bool isOp() const
+    {
+        return _kind >= eComparisonOp && _kind <= eLogicalOp;
+    }
+    bool isAssignmentOp() const
+    {
+        return _kind == eAssignmentOp;
+    }
+    bool isComparisonOp() const
+    {
+        return _kind == eComparisonOp;
     }
     bool isUnsigned() const
     {
@@ -181,7 +330,24 @@ public:
     {
         _isUnused = used;
     }
-    bool isStandardType() const;
+
+    /**
+     * Is this the "{" of a scope that was not changed by the last
+     * round of Tokenizer::simplifyTokenList? Such scopes are skipped by
+     * the next round.
+     */
+    bool isUnchangedScope() const
+    {
+        return _isUnchangedScope;
+    }
+    void isUnchangedScope(bool unchanged)
+    {
+        _isUnchangedScope = unchanged;
+    }
+    bool isStandardType() const
+    {
+        return _kind == eStandardType;
+    }
 
     static const Token *findmatch(const Token *tok, const char pattern[], unsigned int varId = 0);
     static const Token *findmatch(const Token *tok, const char pattern[], const Token *end, unsigned int varId = 0);
@@ -387,28 +553,220 @@ private:
     static int firstWordLen(const char *str);
 
 
-    std::string _str;
-    bool _isName;
-    bool _isNumber;
-    bool _isBoolean;
-    bool _isUnsigned;
-    bool _isSigned;
-    bool _isLong;
-    bool _isUnused;
-    unsigned int _varId;
+    /** Set the interned token string without updating the other token properties */
+    void intern(const std::string &s);
+
+    /** Use the given interned string and release the current one */
+    void setString(TokenString *s);
+
+    /*
+     * The members are ordered so the ones that are used when the token
+     * list is traversed and matched come first, and the flags are packed
+     * into a single word. On 64-bit platforms a token fits in 64 bytes.
+     */
+
     Token *_next;
     Token *_previous;
     Token *_link;
+
+    /** The interned token string */
+    TokenString *_str;
+
+    Token **tokensBack;
+
+    /** The arena that the token was allocated from, 0 if it was allocated with new */
+    TokenArena *_arena;
+
+    unsigned int _varId;
     unsigned int _fileIndex;
     unsigned int _linenr;
 
+    /** The Kind of the token string */
+    unsigned char _kind;
+
+    bool _isUnsigned : 1;
+    bool _isSigned : 1;
+    bool _isLong : 1;
+    bool _isUnused : 1;
+    bool _isUnchangedScope : 1;
+
     /**
      * A value from 0-100 that provides a rough idea about where in the token
      * list this token is located.
      */
-    unsigned int _progressValue;
+    unsigned int _progressValue : 7;
 };
 
+/**
+ * @brief Memory for the tokens of a token list.
+ *
+ * The Tokenizer allocates its tokens from an arena. The tokens are
+ * allocated from big slabs and the memory of deleted tokens is put in a
+ * free list and reused. Each token knows the arena it was allocated from,
+ * and tokens that are inserted after it are allocated from the same arena.
+ * The arena also owns the strings of its tokens, so all its memory is
+ * released at once.
+ *
+ * An arena is used by one thread at a time, like the Tokenizer that owns
+ * it, so it doesn't need a lock.
+ */
+class TokenArena
+{
+public:
+    TokenArena();
+    ~TokenArena();
+
+    /** Create a token in the arena. It is deleted with Token::destroy */
+    Token *newToken(Token **tokensBack);
+
+    /**
+     * Release all the tokens and their strings at once. The tokens of
+     * the arena must not be used after this.
+     */
+    void release();
+
+    /** Is there no memory allocated from this arena? */
+    bool empty() const
+    {
+        return _slabs.empty() && !_strings;
+    }
+
+    /**
+     * Allocate the tokens with new and delete them one by one instead of
+     * using the slabs. It is used to benchmark the arena. The tokens must
+     * then be deleted with Token::destroy before the arena is released.
+     * @param slabs use the slabs?
+     */
+    void useSlabs(bool slabs);
+
+    bool usesSlabs() const
+    {
+        return _useSlabs;
+    }
+
+private:
+    // Not implemented..
+    TokenArena(const TokenArena &);
+    TokenArena &operator=(const TokenArena &);
+
+    friend class Token;
+
+    /** Give the memory of a destroyed token back to the arena */
+    void deallocate(Token *tok);
+
+    /** The pool of the token strings */
+    TokenStringPool &strings();
+
+    /** The compiled Token::Match patterns */
+    PatternCache &patterns();
+
+    /** Number of tokens in each slab */
+    enum { SlabTokens = 1024 };
+
+    /** The slabs are aligned so a token doesn't straddle two cache lines */
+    enum { CacheLineSize = 64 };
+
+    /** Allocated memory for the slabs */
+    std::vector<char *> _slabs;
+
+    /** Memory of deleted tokens */
+    void *_freeList;
+
+    /** Unused memory in the last slab */
+    char *_next;
+    char *_end;
+
+    bool _useSlabs;
+
+    /** The strings of the tokens. It is created when the first token is created */
+    TokenStringPool *_strings;
+
+    /**
+     * The compiled patterns of the thread that uses the arena. It is
+     * looked up once, so Token::Match doesn't need to look up the
+     * thread's cache for each pattern.
+     */
+    PatternCache *_patterns;
+};
+
+class CompiledPattern;
+
+/**
+ * @brief A Token::Match pattern that is compiled once, when it is constructed.
+ *
+ * Token::Match looks up its compiled pattern in a cache. In hot code a
+ * MatchPattern can be used instead, then there is no lookup. Use the
+ * TOKEN_MATCH macro, it creates a static MatchPattern for each call site:
+ * @code
+ * if (TOKEN_MATCH(tok, "%var% = %num% ;"))
+ * @endcode
+ */
+class MatchPattern
+{
+public:
+    explicit MatchPattern(const char pattern[]);
+    ~MatchPattern();
+
+    /**
+     * Compile a pattern once, for matchPatternAt(). The first thread
+     * compiles it under a lock, the other threads get the same pattern.
+     * @param slot where the pattern is stored, 0 until it is compiled
+     * @param pattern the pattern
+     * @return the compiled pattern
+     */
+    static const MatchPattern *compileOnce(const MatchPattern * volatile *slot, const char pattern[]);
+
+    /** Same as Token::Match(tok, pattern, varid) */
+    bool match(const Token *tok, unsigned int varid = 0) const
+    {
+        // Most tokens can be rejected by their kind
+        if (tok && !((_firstKinds >> tok->kind()) & 1U))
+            return false;
+        return compiledMatch(tok, varid);
+    }
+
+private:
+    // Not implemented..
+    MatchPattern(const MatchPattern &);
+    MatchPattern &operator=(const MatchPattern &);
+
+    bool compiledMatch(const Token *tok, unsigned int varid) const;
+
+    CompiledPattern * const _compiled;
+
+    /** Bitmask of the Token::Kind of the first tokens that can match the pattern */
+    unsigned int _firstKinds;
+};
+
+#ifdef __COUNTER__
+namespace
+{
+    /**
+     * The MatchPattern for call site N in the current file. A static
+     * MatchPattern would not be initialized thread-safely by Visual
+     * Studio before 2015, so the pointer is set by compileOnce().
+     */
+    template <unsigned int N>
+    const MatchPattern &matchPatternAt(const char pattern[])
+    {
+        static const MatchPattern * volatile compiled;
+        const MatchPattern *p = compiled;
+        if (!p)
+            p = MatchPattern::compileOnce(&compiled, pattern);
+        return *p;
+    }
+}
+
+/** Same as Token::Match(TOK, PATTERN) but the pattern literal is compiled once for the call site */
+#define TOKEN_MATCH(TOK, PATTERN)                 matchPatternAt<__COUNTER__>("" PATTERN "").match(TOK)
+
+/** Same as Token::Match(TOK, PATTERN, VARID) but the pattern literal is compiled once for the call site */
+#define TOKEN_MATCH_VARID(TOK, PATTERN, VARID)    matchPatternAt<__COUNTER__>("" PATTERN "").match(TOK, VARID)
+#else
+#define TOKEN_MATCH(TOK, PATTERN)                 Token::Match(TOK, PATTERN)
+#define TOKEN_MATCH_VARID(TOK, PATTERN, VARID)    Token::Match(TOK, PATTERN, VARID)
+#endif
+
 /// @}
 
 #endif // TokenH
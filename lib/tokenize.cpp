@@ -30,6 +30,8 @@
 #include "check.h"
 #include "path.h"
 #include "symboldatabase.h"
+#include "timer.h"
+#include "threading.h"
 
 #include <locale>
 #include <fstream>
@@ -47,7 +49,7 @@
 //---------------------------------------------------------------------------
 
 Tokenizer::Tokenizer()
-    : _settings(0), _errorLogger(0)
+    : _settings(0), _errorLogger(0), _timerResults(0)
 {
     // No tokens to start with
     _tokens = 0;
@@ -64,7 +66,7 @@ Tokenizer::Tokenizer()
 }
 
 Tokenizer::Tokenizer(const Settings *settings, ErrorLogger *errorLogger)
-    : _settings(settings), _errorLogger(errorLogger)
+    : _settings(settings), _errorLogger(errorLogger), _timerResults(0)
 {
     // make sure settings are specified
     assert(_settings);
@@ -156,7 +158,7 @@ void Tokenizer::addtoken(const char str[], const unsigned int lineno, const unsi
     }
     else
     {
-        _tokens = new Token(&_tokensBack);
+        _tokens = _arena.newToken(&_tokensBack);
         _tokensBack = _tokens;
         _tokensBack->str(str2.str());
     }
@@ -187,7 +189,7 @@ void Tokenizer::addtoken(const Token * tok, const unsigned int lineno, const uns
     }
     else
     {
-        _tokens = new Token(&_tokensBack);
+        _tokens = _arena.newToken(&_tokensBack);
         _tokensBack = _tokens;
         _tokensBack->str(str2.str());
     }
@@ -788,6 +790,10 @@ struct Space
     const Token * classEnd;
 };
 
+/** Counter for the names of unnamed structs. The threads share it. */
+static long unnamedCount = 0;
+static Mutex unnamedCountMutex;
+
 static Token *splitDefinitionFromTypedef(Token *tok)
 {
     Token *tok1;
@@ -811,8 +817,8 @@ static Token *splitDefinitionFromTypedef(Token *tok)
                 name = tok1->next()->str();
             else // create a unique name
             {
-                static long count = 0;
-                name = "Unnamed" + MathLib::toString<long>(count++);
+                MutexLock lock(unnamedCountMutex);
+                name = "Unnamed" + MathLib::toString<long>(unnamedCount++);
             }
             tok->tokAt(1)->insertToken(name.c_str());
         }
@@ -1997,7 +2003,7 @@ bool Tokenizer::tokenize(std::istream &code,
         }
     }
 
-    if (!createLinks())
+    if (!runPass("createLinks", &Tokenizer::createLinks))
     {
         // Source has syntax errors, can't proceed
         return false;
@@ -2016,16 +2022,16 @@ bool Tokenizer::tokenize(std::istream &code,
     }
 
     // remove some unhandled macros in global scope
-    removeMacrosInGlobalScope();
+    runPass("removeMacrosInGlobalScope", &Tokenizer::removeMacrosInGlobalScope);
 
     // specify array size..
-    arraySize();
+    runPass("arraySize", &Tokenizer::arraySize);
 
     // simplify labels..
-    labels();
+    runPass("labels", &Tokenizer::labels);
 
-    simplifyDoWhileAddBraces();
-    simplifyIfAddBraces();
+    runPass("simplifyDoWhileAddBraces", &Tokenizer::simplifyDoWhileAddBraces);
+    runPass("simplifyIfAddBraces", &Tokenizer::simplifyIfAddBraces);
 
     // Combine "- %num%" ..
     for (Token *tok = _tokens; tok; tok = tok->next())
@@ -2100,7 +2106,7 @@ bool Tokenizer::tokenize(std::istream &code,
     }
 
     // ";a+=b;" => ";a=a+b;"
-    simplifyCompoundAssignment();
+    runPass("simplifyCompoundAssignment", &Tokenizer::simplifyCompoundAssignment);
 
     // check for more complicated syntax errors when using templates..
     if (!preprocessorCondition)
@@ -2266,31 +2272,31 @@ bool Tokenizer::tokenize(std::istream &code,
     }
 
     // Remove __declspec()
-    simplifyDeclspec();
+    runPass("simplifyDeclspec", &Tokenizer::simplifyDeclspec);
 
     // remove calling conventions __cdecl, __stdcall..
-    simplifyCallingConvention();
+    runPass("simplifyCallingConvention", &Tokenizer::simplifyCallingConvention);
 
     // remove __attribute__((?))
-    simplifyAttribute();
+    runPass("simplifyAttribute", &Tokenizer::simplifyAttribute);
 
     // remove unnecessary member qualification..
-    removeUnnecessaryQualification();
+    runPass("removeUnnecessaryQualification", &Tokenizer::removeUnnecessaryQualification);
 
     // remove Microsoft MFC..
-    simplifyMicrosoftMFC();
+    runPass("simplifyMicrosoftMFC", &Tokenizer::simplifyMicrosoftMFC);
 
     // Remove Qt signals and slots
-    simplifyQtSignalsSlots();
+    runPass("simplifyQtSignalsSlots", &Tokenizer::simplifyQtSignalsSlots);
 
     // remove Borland stuff..
-    simplifyBorland();
+    runPass("simplifyBorland", &Tokenizer::simplifyBorland);
 
     // Remove "volatile", "inline", "register", and "restrict"
-    simplifyKeyword();
+    runPass("simplifyKeyword", &Tokenizer::simplifyKeyword);
 
     // Remove __builtin_expect, likely and unlikely
-    simplifyBuiltinExpect();
+    runPass("simplifyBuiltinExpect", &Tokenizer::simplifyBuiltinExpect);
 
     // #2449: syntax error: enum with typedef in it
     for (const Token *tok = _tokens; tok; tok = tok->next())
@@ -2314,7 +2320,7 @@ bool Tokenizer::tokenize(std::istream &code,
     }
 
     // typedef..
-    simplifyTypedef();
+    runPass("simplifyTypedef", &Tokenizer::simplifyTypedef);
 
     // catch bad typedef canonicalization
     if (!validate())
@@ -2324,10 +2330,10 @@ bool Tokenizer::tokenize(std::istream &code,
     }
 
     // enum..
-    simplifyEnum();
+    runPass("simplifyEnum", &Tokenizer::simplifyEnum);
 
     // Remove __asm..
-    simplifyAsm();
+    runPass("simplifyAsm", &Tokenizer::simplifyAsm);
 
     // When the assembly code has been cleaned up, no @ is allowed
     for (const Token *tok = _tokens; tok; tok = tok->next())
@@ -2343,13 +2349,13 @@ bool Tokenizer::tokenize(std::istream &code,
 
     // collapse compound standard types into a single token
     // unsigned long long int => long _isUnsigned=true,_isLong=true
-    simplifyStdType();
+    runPass("simplifyStdType", &Tokenizer::simplifyStdType);
 
     // simplify bit fields..
-    simplifyBitfields();
+    runPass("simplifyBitfields", &Tokenizer::simplifyBitfields);
 
     // Use "<" comparison instead of ">"
-    simplifyComparisonOrder();
+    runPass("simplifyComparisonOrder", &Tokenizer::simplifyComparisonOrder);
 
     /**
      * @todo simplify "for"
@@ -2357,72 +2363,72 @@ bool Tokenizer::tokenize(std::istream &code,
      * - try to change "for" loop to a "while" loop instead
      */
 
-    simplifyConst();
+    runPass("simplifyConst", &Tokenizer::simplifyConst);
 
     // struct simplification "struct S {} s; => struct S { } ; S s ;
-    simplifyStructDecl();
+    runPass("simplifyStructDecl", &Tokenizer::simplifyStructDecl);
 
     // struct initialization (must be used before simplifyVarDecl)
-    simplifyStructInit();
+    runPass("simplifyStructInit", &Tokenizer::simplifyStructInit);
 
     // Change initialisation of variable to assignment
-    simplifyInitVar();
+    runPass("simplifyInitVar", &Tokenizer::simplifyInitVar);
 
     // Split up variable declarations.
-    simplifyVarDecl();
+    runPass("simplifyVarDecl", &Tokenizer::simplifyVarDecl);
 
     // f(x=g())   =>   x=g(); f(x)
-    simplifyAssignmentInFunctionCall();
+    runPass("simplifyAssignmentInFunctionCall", &Tokenizer::simplifyAssignmentInFunctionCall);
 
-    simplifyVariableMultipleAssign();
+    runPass("simplifyVariableMultipleAssign", &Tokenizer::simplifyVariableMultipleAssign);
 
     // Remove redundant parentheses
-    simplifyRedundantParanthesis();
+    runPass("simplifyRedundantParanthesis", &Tokenizer::simplifyRedundantParanthesis);
 
     // Handle templates..
-    simplifyTemplates();
+    runPass("simplifyTemplates", &Tokenizer::simplifyTemplates);
 
     // Simplify templates.. sometimes the "simplifyTemplates" fail and
     // then unsimplified function calls etc remain. These have the
     // "wrong" syntax. So this function will just fix so that the
     // syntax is corrected.
-    simplifyTemplates2();
+    runPass("simplifyTemplates2", &Tokenizer::simplifyTemplates2);
 
     // Simplify the operator "?:"
-    simplifyConditionOperator();
+    runPass("simplifyConditionOperator", &Tokenizer::simplifyConditionOperator);
 
     // remove exception specifications..
     removeExceptionSpecifications(_tokens);
 
     // Collapse operator name tokens into single token
     // operator = => operator=
-    simplifyOperatorName();
+    runPass("simplifyOperatorName", &Tokenizer::simplifyOperatorName);
 
     // simplify function pointers
-    simplifyFunctionPointers();
+    runPass("simplifyFunctionPointers", &Tokenizer::simplifyFunctionPointers);
 
     // "if (not p)" => "if (!p)"
     // "if (p and q)" => "if (p && q)"
     // "if (p or q)" => "if (p || q)"
-    while (simplifyLogicalOperators()) { }
+    while (runPass("simplifyLogicalOperators", &Tokenizer::simplifyLogicalOperators)) { }
 
     // Change initialisation of variable to assignment
-    simplifyInitVar();
+    runPass("simplifyInitVar", &Tokenizer::simplifyInitVar);
 
     // Split up variable declarations.
-    simplifyVarDecl();
+    runPass("simplifyVarDecl", &Tokenizer::simplifyVarDecl);
 
     if (!preprocessorCondition)
     {
-        setVarId();
+        runPass("setVarId", &Tokenizer::setVarId);
 
         // Change initialisation of variable to assignment
-        simplifyInitVar();
+        runPass("simplifyInitVar", &Tokenizer::simplifyInitVar);
     }
 
     _tokens->assignProgressValues();
 
-    removeRedundantSemicolons();
+    runPass("removeRedundantSemicolons", &Tokenizer::removeRedundantSemicolons);
 
     return validate();
 }
@@ -3292,7 +3298,7 @@ void Tokenizer::setVarId()
     _varId = 0;
     for (Token *tok = _tokens; tok; tok = tok->next())
     {
-        if (tok != _tokens && !Token::Match(tok, "[;{}(,] %type%"))
+        if (tok != _tokens && !TOKEN_MATCH(tok, "[;{}(,] %type%"))
             continue;
 
         if (_errorLogger)
@@ -3552,7 +3558,7 @@ void Tokenizer::setVarId()
     {
         for (Token *tok2 = _tokens; tok2; tok2 = tok2->next())
         {
-            if (Token::Match(tok2, "%var% :: %var%"))
+            if (TOKEN_MATCH(tok2, "%var% :: %var%"))
             {
                 if (Token::simpleMatch(tok2->tokAt(3), "("))
                     allMemberFunctions.push_back(tok2);
@@ -3565,7 +3571,7 @@ void Tokenizer::setVarId()
     // class members..
     for (Token *tok = _tokens; tok; tok = tok->next())
     {
-        if (Token::Match(tok, "class|struct %var% {|:"))
+        if (TOKEN_MATCH(tok, "class|struct %var% {|:"))
         {
             const std::string &classname(tok->next()->str());
 
@@ -4072,11 +4078,11 @@ bool Tokenizer::simplifyTokenList()
     }
 
     // simplify references
-    simplifyReference();
+    runPass("simplifyReference", &Tokenizer::simplifyReference);
 
-    simplifyStd();
+    runPass("simplifyStd", &Tokenizer::simplifyStd);
 
-    simplifyGoto();
+    runPass("simplifyGoto", &Tokenizer::simplifyGoto);
 
     // Combine wide strings
     for (Token *tok = _tokens; tok; tok = tok->next())
@@ -4095,95 +4101,42 @@ bool Tokenizer::simplifyTokenList()
         if (tok->str()[0] != '"')
             continue;
 
-        tok->str(simplifyString(tok->str()));
+        // The combined string is built here and the token string is set once,
+        // so the intermediate strings of a long chain are not interned
+        std::string combined(simplifyString(tok->str()));
         while (tok->next() && tok->next()->str()[0] == '"')
         {
-            tok->next()->str(simplifyString(tok->next()->str()));
-
             // Two strings after each other, combine them
-            tok->concatStr(tok->next()->str());
+            const std::string str(simplifyString(tok->next()->str()));
+            combined.erase(combined.length() - 1);
+            combined.append(str.begin() + 1, str.end());
             tok->deleteNext();
         }
+        tok->str(combined);
     }
 
     // Convert e.g. atol("0") into 0
-    simplifyMathFunctions();
-
-    // Convert + + into + and + - into -
-    for (Token *tok = _tokens; tok; tok = tok->next())
-    {
-        while (tok->next())
-        {
-            if (tok->str() == "+")
-            {
-                if (tok->next()->str() == "+")
-                {
-                    tok->deleteNext();
-                    continue;
-                }
-                else if (tok->next()->str() == "-")
-                {
-                    tok->str("-");
-                    tok->deleteNext();
-                    continue;
-                }
-            }
-            else if (tok->str() == "-")
-            {
-                if (tok->next()->str() == "-")
-                {
-                    tok->str("+");
-                    tok->deleteNext();
-                    continue;
-                }
-                else if (tok->next()->str() == "+")
-                {
-                    tok->deleteNext();
-                    continue;
-                }
-            }
+    runPass("simplifyMathFunctions", &Tokenizer::simplifyMathFunctions);
 
-            break;
-        }
-    }
-
-    // 0[a] -> a[0]
-    for (Token *tok = _tokens; tok; tok = tok->next())
+    // Convert + + into + and + - into -, and 0[a] into a[0]
+    static const Rule signRules[] =
     {
-        if (Token::Match(tok, "%num% [ %var% ]"))
-        {
-            const std::string temp = tok->str();
-            tok->str(tok->tokAt(2)->str());
-            tok->tokAt(2)->str(temp);
-        }
-    }
+        &Tokenizer::simplifyPlusMinus,
+        &Tokenizer::simplifyArrayIndex
+    };
+    runRules("simplifyPlusMinus,simplifyArrayIndex", signRules, 2);
 
-    simplifySizeof();
+    runPass("simplifySizeof", &Tokenizer::simplifySizeof);
 
-    // replace strlen(str)
-    simplifyKnownVariables();
-    for (Token *tok = _tokens; tok; tok = tok->next())
-    {
-        if (Token::Match(tok, "strlen ( %str% )"))
-        {
-            std::ostringstream ostr;
-            ostr << Token::getStrLength(tok->tokAt(2));
-            tok->str(ostr.str());
-            tok->deleteNext();
-            tok->deleteNext();
-            tok->deleteNext();
-        }
-    }
+    runPass("simplifyKnownVariables", &Tokenizer::simplifyKnownVariables);
 
-    // change array to pointer..
-    for (Token *tok = _tokens; tok; tok = tok->next())
+    // replace strlen(str) and change array to pointer..
+    static const Rule strlenRules[] =
     {
-        if (Token::Match(tok, "%type% %var% [ ] [,;=]"))
-        {
-            Token::eraseTokens(tok->next(), tok->tokAt(4));
-            tok->insertToken("*");
-        }
-    }
+        &Tokenizer::simplifyStrlen,
+        &Tokenizer::simplifyArrayToPointer
+    };
+    runRules("simplifyStrlen,simplifyArrayToPointer", strlenRules, 2);
 
     // Replace constants..
     for (Token *tok = _tokens; tok; tok = tok->next())
@@ -4221,110 +4174,41 @@ bool Tokenizer::simplifyTokenList()
         }
     }
 
-    simplifyCasts();
+    runPass("simplifyCasts", &Tokenizer::simplifyCasts);
 
     // Simplify simple calculations..
-    simplifyCalculations();
+    runPass("simplifyCalculations", &Tokenizer::simplifyCalculations);
 
     // Replace "*(str + num)" => "str[num]"
-    for (Token *tok = _tokens; tok; tok = tok->next())
-    {
-        if (! strchr(";{}(=<>", tok->str()[0]))
-            continue;
-
-        Token *next = tok->next();
-        if (! next)
-            break;
-
-        if (Token::Match(next, "* ( %var% + %num% )") ||
-            Token::Match(next, "* ( %var% + %var% )"))
-        {
-            // var
-            tok = tok->next();
-            tok->str(tok->strAt(2));
-
-            // [
-            tok = tok->next();
-            tok->str("[");
-
-            // num
-            tok = tok->next();
-            tok->str(tok->strAt(2));
-
-            // ]
-            tok = tok->next();
-            tok->str("]");
-
-            tok->deleteNext();
-            tok->deleteNext();
-
-            Token::createMutualLinks(next->tokAt(1), next->tokAt(3));
-        }
-    }
-
     // simplify "x=realloc(y,0);" => "free(y); x=0;"..
     // and "x = realloc (0, n);" => "x = malloc(n);"
-    for (Token *tok = _tokens; tok; tok = tok->next())
+    static const Rule reallocRules[] =
     {
-        if (Token::Match(tok, "; %var% = realloc ( %var% , 0 ) ;"))
-        {
-            const std::string varname(tok->next()->str());
-            const unsigned int varid(tok->next()->varId());
-
-            // Delete the "%var% ="
-            tok->deleteNext();
-            tok->deleteNext();
-
-            // Change function name "realloc" to "free"
-            tok->next()->str("free");
-
-            // delete the ", 0"
-            Token::eraseTokens(tok->tokAt(3), tok->tokAt(6));
-
-            // goto the ";"
-            tok = tok->tokAt(5);
-
-            // insert "var=0;"
-            tok->insertToken(";");
-            tok->insertToken("0");
-            tok->insertToken("=");
-            tok->insertToken(varname);
-            tok->next()->varId(varid);
-        }
-        else if (Token::Match(tok, "; %var% = realloc ( 0 , %num% ) ;"))
-        {
-            const std::string varname(tok->next()->str());
-
-            tok = tok->tokAt(3);
-            // Change function name "realloc" to "malloc"
-            tok->str("malloc");
-
-            // delete "0 ,"
-            tok->next()->deleteNext();
-            tok->next()->deleteNext();
-        }
-    }
+        &Tokenizer::simplifyDereference,
+        &Tokenizer::simplifyRealloc
+    };
+    runRules("simplifyDereference,simplifyRealloc", reallocRules, 2);
 
     // Change initialisation of variable to assignment
-    simplifyInitVar();
+    runPass("simplifyInitVar", &Tokenizer::simplifyInitVar);
 
     // Simplify variable declarations
-    simplifyVarDecl();
-
-    simplifyFunctionParameters();
-    elseif();
-    simplifyErrNoInWhile();
-    simplifyIfAssign();
-    simplifyRedundantParanthesis();
-    simplifyIfNot();
-    simplifyIfNotNull();
-    simplifyIfSameInnerCondition();
-    simplifyComparisonOrder();
-    simplifyNestedStrcat();
-    simplifyWhile0();
-    simplifyFuncInWhile();
-
-    simplifyIfAssign();    // could be affected by simplifyIfNot
+    runPass("simplifyVarDecl", &Tokenizer::simplifyVarDecl);
+
+    runPass("simplifyFunctionParameters", &Tokenizer::simplifyFunctionParameters);
+    runPass("elseif", &Tokenizer::elseif);
+    runPass("simplifyErrNoInWhile", &Tokenizer::simplifyErrNoInWhile);
+    runPass("simplifyIfAssign", &Tokenizer::simplifyIfAssign);
+    runPass("simplifyRedundantParanthesis", &Tokenizer::simplifyRedundantParanthesis);
+    runPass("simplifyIfNot", &Tokenizer::simplifyIfNot);
+    runPass("simplifyIfNotNull", &Tokenizer::simplifyIfNotNull);
+    runPass("simplifyIfSameInnerCondition", &Tokenizer::simplifyIfSameInnerCondition);
+    runPass("simplifyComparisonOrder", &Tokenizer::simplifyComparisonOrder);
+    runPass("simplifyNestedStrcat", &Tokenizer::simplifyNestedStrcat);
+    runPass("simplifyWhile0", &Tokenizer::simplifyWhile0);
+    runPass("simplifyFuncInWhile", &Tokenizer::simplifyFuncInWhile);
+
+    runPass("simplifyIfAssign", &Tokenizer::simplifyIfAssign);    // could be affected by simplifyIfNot
 
     for (Token *tok = _tokens; tok; tok = tok->next())
     {
@@ -4335,20 +4219,27 @@ bool Tokenizer::simplifyTokenList()
     }
 
     // In case variable declarations have been updated...
-    setVarId();
+    runPass("setVarId", &Tokenizer::setVarId);
 
+    // Simplify until nothing changes. A round only simplifies the scopes
+    // that were changed by the previous round.
+    std::vector<std::pair<unsigned int, unsigned int> > scopeHashes;
+    markUnchangedScopes(scopeHashes);
     bool modified = true;
     while (modified)
     {
         modified = false;
-        modified |= simplifyConditions();
-        modified |= simplifyFunctionReturn();
-        modified |= simplifyKnownVariables();
-        modified |= removeReduntantConditions();
-        modified |= simplifyRedundantParanthesis();
-        modified |= simplifyQuestionMark();
-        modified |= simplifyCalculations();
+        modified |= runPass("simplifyConditions", &Tokenizer::simplifyConditions);
+        modified |= runPass("simplifyFunctionReturn", &Tokenizer::simplifyFunctionReturn);
+        modified |= runPass("simplifyKnownVariables", &Tokenizer::simplifyKnownVariables);
+        modified |= runPass("removeReduntantConditions", &Tokenizer::removeReduntantConditions);
+        modified |= runPass("simplifyRedundantParanthesis", &Tokenizer::simplifyRedundantParanthesis);
+        modified |= runPass("simplifyQuestionMark", &Tokenizer::simplifyQuestionMark);
+        modified |= runPass("simplifyCalculations", &Tokenizer::simplifyCalculations);
+
+        markUnchangedScopes(scopeHashes);
     }
+    clearUnchangedScopes();
 
     // Remove redundant parentheses in return..
     for (Token *tok = _tokens; tok; tok = tok->next())
@@ -4368,9 +4259,9 @@ bool Tokenizer::simplifyTokenList()
         }
     }
 
-    removeRedundantAssignment();
+    runPass("removeRedundantAssignment", &Tokenizer::removeRedundantAssignment);
 
-    simplifyComma();
+    runPass("simplifyComma", &Tokenizer::simplifyComma);
     if (_settings->debug)
     {
         _tokens->printOut(0, _files);
@@ -4378,12 +4269,307 @@ bool Tokenizer::simplifyTokenList()
 
     _tokens->assignProgressValues();
 
-    removeRedundantSemicolons();
+    runPass("removeRedundantSemicolons", &Tokenizer::removeRedundantSemicolons);
 
     return validate();
 }
 //---------------------------------------------------------------------------
 
+void Tokenizer::runPass(const char name[], void (Tokenizer::*pass)())
+{
+    if (!_settings || _settings->_showtime == SHOWTIME_NONE)
+    {
+        (this->*pass)();
+        return;
+    }
+
+    const std::string timerName(std::string("Tokenizer::") + name);
+    const unsigned long tokensBefore = tokenCount();
+    {
+        Timer timer(timerName, _settings->_showtime, _timerResults);
+        (this->*pass)();
+    }
+    addTokenCounts(timerName, tokensBefore);
+}
+
+bool Tokenizer::runPass(const char name[], bool (Tokenizer::*pass)())
+{
+    if (!_settings || _settings->_showtime == SHOWTIME_NONE)
+        return (this->*pass)();
+
+    const std::string timerName(std::string("Tokenizer::") + name);
+    const unsigned long tokensBefore = tokenCount();
+    bool ret;
+    {
+        Timer timer(timerName, _settings->_showtime, _timerResults);
+        ret = (this->*pass)();
+    }
+    addTokenCounts(timerName, tokensBefore);
+    return ret;
+}
+
+void Tokenizer::runRules(const char name[], const Rule rules[], unsigned int count)
+{
+    // The rules are fused because each of them is cheap and a walk over
+    // the token list is not. Only local rewrites that can't create or
+    // destroy a match of the other rules in the same walk are fused. The
+    // named passes are not: simplifyCasts, simplifyIfNot,
+    // simplifyIfNotNull, simplifyComparisonOrder and the others skip
+    // scopes, change the tokens before the current one, or need the
+    // result of the pass before them on the whole list.
+    if (!_settings || _settings->_showtime == SHOWTIME_NONE)
+    {
+        applyRules(rules, count);
+        return;
+    }
+
+    const std::string timerName(std::string("Tokenizer::") + name);
+    const unsigned long tokensBefore = tokenCount();
+    {
+        Timer timer(timerName, _settings->_showtime, _timerResults);
+        applyRules(rules, count);
+    }
+    addTokenCounts(timerName, tokensBefore);
+}
+
+void Tokenizer::applyRules(const Rule rules[], unsigned int count)
+{
+    for (Token *tok = _tokens; tok; tok = tok->next())
+    {
+        for (unsigned int i = 0; i < count; ++i)
+            (this->*rules[i])(tok);
+    }
+}
+
+void Tokenizer::simplifyPlusMinus(Token *&tok)
+{
+    while (tok->next())
+    {
+        if (tok->str() == "+")
+        {
+            if (tok->next()->str() == "+")
+            {
+                tok->deleteNext();
+                continue;
+            }
+            else if (tok->next()->str() == "-")
+            {
+                tok->str("-");
+                tok->deleteNext();
+                continue;
+            }
+        }
+        else if (tok->str() == "-")
+        {
+            if (tok->next()->str() == "-")
+            {
+                tok->str("+");
+                tok->deleteNext();
+                continue;
+            }
+            else if (tok->next()->str() == "+")
+            {
+                tok->deleteNext();
+                continue;
+            }
+        }
+
+        break;
+    }
+}
+
+void Tokenizer::simplifyArrayIndex(Token *&tok)
+{
+    if (Token::Match(tok, "%num% [ %var% ]"))
+    {
+        const std::string temp = tok->str();
+        tok->str(tok->tokAt(2)->str());
+        tok->tokAt(2)->str(temp);
+    }
+}
+
+void Tokenizer::simplifyStrlen(Token *&tok)
+{
+    if (Token::Match(tok, "strlen ( %str% )"))
+    {
+        std::ostringstream ostr;
+        ostr << Token::getStrLength(tok->tokAt(2));
+        tok->str(ostr.str());
+        tok->deleteNext();
+        tok->deleteNext();
+        tok->deleteNext();
+    }
+}
+
+void Tokenizer::simplifyArrayToPointer(Token *&tok)
+{
+    if (Token::Match(tok, "%type% %var% [ ] [,;=]"))
+    {
+        Token::eraseTokens(tok->next(), tok->tokAt(4));
+        tok->insertToken("*");
+    }
+}
+
+void Tokenizer::simplifyDereference(Token *&tok)
+{
+    if (! strchr(";{}(=<>", tok->str()[0]))
+        return;
+
+    Token *next = tok->next();
+    if (! next)
+        return;
+
+    if (Token::Match(next, "* ( %var% + %num% )") ||
+        Token::Match(next, "* ( %var% + %var% )"))
+    {
+        // var
+        tok = tok->next();
+        tok->str(tok->strAt(2));
+
+        // [
+        tok = tok->next();
+        tok->str("[");
+
+        // num
+        tok = tok->next();
+        tok->str(tok->strAt(2));
+
+        // ]
+        tok = tok->next();
+        tok->str("]");
+
+        tok->deleteNext();
+        tok->deleteNext();
+
+        Token::createMutualLinks(next->tokAt(1), next->tokAt(3));
+    }
+}
+
+void Tokenizer::simplifyRealloc(Token *&tok)
+{
+    if (Token::Match(tok, "; %var% = realloc ( %var% , 0 ) ;"))
+    {
+        const std::string varname(tok->next()->str());
+        const unsigned int varid(tok->next()->varId());
+
+        // Delete the "%var% ="
+        tok->deleteNext();
+        tok->deleteNext();
+
+        // Change function name "realloc" to "free"
+        tok->next()->str("free");
+
+        // delete the ", 0"
+        Token::eraseTokens(tok->tokAt(3), tok->tokAt(6));
+
+        // goto the ";"
+        tok = tok->tokAt(5);
+
+        // insert "var=0;"
+        tok->insertToken(";");
+        tok->insertToken("0");
+        tok->insertToken("=");
+        tok->insertToken(varname);
+        tok->next()->varId(varid);
+    }
+    else if (Token::Match(tok, "; %var% = realloc ( 0 , %num% ) ;"))
+    {
+        tok = tok->tokAt(3);
+        // Change function name "realloc" to "malloc"
+        tok->str("malloc");
+
+        // delete "0 ,"
+        tok->next()->deleteNext();
+        tok->next()->deleteNext();
+    }
+}
+
+unsigned long Tokenizer::tokenCount() const
+{
+    unsigned long count = 0;
+    for (const Token *tok = _tokens; tok; tok = tok->next())
+        ++count;
+    return count;
+}
+
+void Tokenizer::addTokenCounts(const std::string &name, unsigned long tokensBefore) const
+{
+    if (_timerResults && _settings->_showtime != SHOWTIME_FILE)
+        _timerResults->AddTokens(name, tokensBefore, tokenCount());
+}
+//---------------------------------------------------------------------------
+
+static unsigned int hashToken(unsigned int hash, const Token *tok)
+{
+    return (((hash ^ tok->strHash()) * 16777619U) ^ tok->varId()) * 16777619U;
+}
+
+void Tokenizer::markUnchangedScopes(std::vector<std::pair<unsigned int, unsigned int> > &hashes)
+{
+    // Hash the tokens in front of each top level scope and the tokens of
+    // the scope, and compare with the hashes of the last round. The
+    // scopes that were skipped by the last round keep their hash, so only
+    // the simplified scopes are walked.
+    std::vector<std::pair<unsigned int, unsigned int> > current;
+    std::vector<Token *> scopes;
+    bool reused = false;
+    unsigned int hash = 2166136261U;
+    for (Token *tok = _tokens; tok; tok = tok->next())
+    {
+        if (tok->str() == "{" && tok->link())
+        {
+            unsigned int scopeHash = 2166136261U;
+            if (tok->isUnchangedScope() && current.size() < hashes.size())
+            {
+                scopeHash = hashes[current.size()].second;
+                reused = true;
+            }
+            else
+            {
+                for (const Token *tok2 = tok; tok2 != tok->link(); tok2 = tok2->next())
+                    scopeHash = hashToken(scopeHash, tok2);
+            }
+            current.push_back(std::make_pair(hash, scopeHash));
+            scopes.push_back(tok);
+            hash = 2166136261U;
+            tok = tok->link();
+        }
+        else
+        {
+            hash = hashToken(hash, tok);
+        }
+    }
+
+    const bool sameScopes = bool(current.size() == hashes.size());
+    if (!sameScopes && reused)
+    {
+        // A top level scope was added or removed, the hashes that were
+        // kept may belong to another scope
+        clearUnchangedScopes();
+        hashes.clear();
+        markUnchangedScopes(hashes);
+        return;
+    }
+
+    for (std::vector<Token *>::size_type i = 0; i < scopes.size(); ++i)
+        scopes[i]->isUnchangedScope(sameScopes && current[i] == hashes[i]);
+
+    hashes.swap(current);
+}
+
+void Tokenizer::clearUnchangedScopes()
+{
+    for (Token *tok = _tokens; tok; tok = tok->next())
+    {
+        if (tok->isUnchangedScope())
+            tok->isUnchangedScope(false);
+        if (tok->str() == "{" && tok->link())
+            tok = tok->link();
+    }
+}
+
+//---------------------------------------------------------------------------
+
 void Tokenizer::removeMacrosInGlobalScope()
 {
     for (Token *tok = _tokens; tok; tok = tok->next())
@@ -4463,7 +4649,7 @@ bool Tokenizer::removeReduntantConditions()
     // Return value for function. Set to true if there are any simplifications
     bool ret = false;
 
-    for (Token *tok = _tokens; tok; tok = tok->next())
+    for (Token *tok = _tokens; tok; tok = skipUnchangedScope(tok->next()))
     {
         if (tok->str() != "if")
             continue;
@@ -4945,7 +5131,7 @@ bool Tokenizer::simplifyConditions()
 {
     bool ret = false;
 
-    for (Token *tok = _tokens; tok; tok = tok->next())
+    for (Token *tok = _tokens; tok; tok = skipUnchangedScope(tok->next()))
     {
         if (Token::Match(tok, "! %num%") || Token::Match(tok, "! %bool%"))
         {
@@ -5093,7 +5279,7 @@ bool Tokenizer::simplifyConditions()
 bool Tokenizer::simplifyQuestionMark()
 {
     bool ret = false;
-    for (Token *tok = _tokens; tok; tok = tok->next())
+    for (Token *tok = _tokens; tok; tok = skipUnchangedScope(tok->next()))
     {
         if (tok->str() != "?")
             continue;
@@ -5414,20 +5600,22 @@ void Tokenizer:: simplifyFunctionPointers()
 bool Tokenizer::simplifyFunctionReturn()
 {
     bool ret = false;
-    int indentlevel = 0;
     for (const Token *tok = tokens(); tok; tok = tok->next())
     {
-        if (tok->str() == "{")
-            ++indentlevel;
-
-        else if (tok->str() == "}")
-            --indentlevel;
+        if (tok->str() == "{" && tok->link())
+            tok = tok->link();
 
-        else if (indentlevel == 0 && Token::Match(tok, "%var% ( ) { return %num% ; }") && tok->str() != ")")
+        else if (Token::Match(tok, "%var% ( ) { return %num% ; }") && tok->str() != ")")
         {
+            // The calls in the unchanged scopes were simplified when the
+            // function was found. A function that was just found is
+            // called in all scopes.
+            const bool found = !tok->tokAt(3)->isUnchangedScope();
+            bool simplified = false;
+
             std::ostringstream pattern;
             pattern << "[(=+-*/] " << tok->str() << " ( ) [;)+-*/]";
-            for (Token *tok2 = _tokens; tok2; tok2 = tok2->next())
+            for (Token *tok2 = _tokens; tok2; tok2 = found ? tok2->next() : skipUnchangedScope(tok2->next()))
             {
                 if (Token::Match(tok2, pattern.str().c_str()))
                 {
@@ -5435,9 +5623,16 @@ bool Tokenizer::simplifyFunctionReturn()
                     tok2->str(tok->strAt(5));
                     tok2->deleteNext();
                     tok2->deleteNext();
-                    ret = true;
+                    simplified = true;
                 }
             }
+
+            if (simplified)
+            {
+                ret = true;
+                if (found)
+                    clearUnchangedScopes();
+            }
         }
     }
 
@@ -5474,7 +5669,7 @@ void Tokenizer::simplifyVarDecl()
                 break;
         }
 
-        if (tok->previous() && !Token::Match(tok->previous(), "{|}|;|)|public:|protected:|private:"))
+        if (tok->previous() && !TOKEN_MATCH(tok->previous(), "{|}|;|)|public:|protected:|private:"))
             continue;
 
         Token *type0 = tok;
@@ -5795,8 +5990,8 @@ void Tokenizer::simplifyIfAssign()
 
     for (Token *tok = _tokens; tok; tok = tok->next())
     {
-        if (!Token::Match(tok->next(), "if|while ( !| (| %var% =") &&
-            !Token::Match(tok->next(), "if|while ( !| (| %var% . %var% ="))
+        if (!TOKEN_MATCH(tok->next(), "if|while ( !| (| %var% =") &&
+            !TOKEN_MATCH(tok->next(), "if|while ( !| (| %var% . %var% ="))
             continue;
 
         // simplifying a "while" condition ?
@@ -6253,14 +6448,23 @@ bool Tokenizer::simplifyKnownVariables()
     // constants..
     {
         std::map<unsigned int, std::string> constantValues;
+        bool constantsSimplified = false;
+        bool skipped = false;
         for (Token *tok = _tokens; tok; tok = tok->next())
         {
-            if (Token::Match(tok, "static| const static| %type% %var% = %any% ;"))
+            if (tok->isUnchangedScope())
+            {
+                tok = tok->link();
+                skipped = true;
+                continue;
+            }
+
+            if (TOKEN_MATCH(tok, "static| const static| %type% %var% = %any% ;"))
             {
                 Token *tok1 = tok;
 
                 // start of statement
-                if (tok != _tokens && !Token::Match(tok->previous(),"[;{}]"))
+                if (tok != _tokens && !TOKEN_MATCH(tok->previous(),"[;{}]"))
                     continue;
                 // skip "const" and "static"
                 while (tok->str() == "const" || tok->str() == "static")
@@ -6271,7 +6475,7 @@ bool Tokenizer::simplifyKnownVariables()
 
                 const Token * const vartok = tok->next();
                 const Token * const valuetok = tok->tokAt(3);
-                if (valuetok->isNumber() || Token::Match(valuetok, "%str% ;"))
+                if (valuetok->isNumber() || TOKEN_MATCH(valuetok, "%str% ;"))
                 {
                     constantValues[vartok->varId()] = valuetok->str();
 
@@ -6279,6 +6483,7 @@ bool Tokenizer::simplifyKnownVariables()
                     while (tok1->str() != ";")
                         tok1->deleteThis();
                     tok = tok1;
+                    constantsSimplified = true;
                 }
             }
 
@@ -6287,24 +6492,43 @@ bool Tokenizer::simplifyKnownVariables()
                 tok->str(constantValues[tok->varId()]);
             }
         }
+
+        // The constants may have been used in the unchanged scopes
+        if (constantsSimplified && skipped)
+        {
+            for (Token *tok = _tokens; tok; tok = tok->next())
+            {
+                if (tok->varId() && constantValues.find(tok->varId()) != constantValues.end())
+                    tok->str(constantValues[tok->varId()]);
+            }
+            clearUnchangedScopes();
+        }
     }
 
     // variable id for float/double variables
     std::set<unsigned int> floatvars;
 
     // auto variables..
-    for (Token *tok = _tokens; tok; tok = tok->next())
+    for (Token *tok = _tokens; tok; tok = skipUnchangedScope(tok->next()))
     {
         // Search for a block of code
-        if (! Token::Match(tok, ") const| {"))
+        if (! TOKEN_MATCH(tok, ") const| {"))
+            continue;
+
+        // Skip the block of code if it wasn't changed by the last round of simplifications
+        const Token * const start = (tok->next()->str() == "{") ? tok->next() : tok->tokAt(2);
+        if (start->isUnchangedScope())
+        {
+            tok = start->link();
             continue;
+        }
 
         // parse the block of code..
         int indentlevel = 0;
         Token *tok2 = tok;
         for (; tok2; tok2 = tok2->next())
         {
-            if (Token::Match(tok2, "[;{}] float|double %var% ;"))
+            if (TOKEN_MATCH(tok2, "[;{}] float|double %var% ;"))
             {
                 floatvars.insert(tok2->tokAt(2)->varId());
             }
@@ -6320,32 +6544,32 @@ bool Tokenizer::simplifyKnownVariables()
             }
 
             else if (tok2->previous()->str() != "*" &&
-                     (Token::Match(tok2, "%var% = %num% ;") ||
-                      Token::Match(tok2, "%var% = %str% ;") ||
-                      (Token::Match(tok2, "%var% = %any% ;") && tok2->strAt(2)[0] == '\'') ||
-                      Token::Match(tok2, "%var% [ ] = %str% ;") ||
-                      Token::Match(tok2, "%var% [ %num% ] = %str% ;") ||
-                      Token::Match(tok2, "%var% = %bool% ;") ||
-                      Token::Match(tok2, "%var% = %var% ;") ||
-                      Token::Match(tok2, "%var% = & %var% ;") ||
-                      Token::Match(tok2, "%var% = & %var% [ 0 ] ;")))
+                     (TOKEN_MATCH(tok2, "%var% = %num% ;") ||
+                      TOKEN_MATCH(tok2, "%var% = %str% ;") ||
+                      (TOKEN_MATCH(tok2, "%var% = %any% ;") && tok2->strAt(2)[0] == '\'') ||
+                      TOKEN_MATCH(tok2, "%var% [ ] = %str% ;") ||
+                      TOKEN_MATCH(tok2, "%var% [ %num% ] = %str% ;") ||
+                      TOKEN_MATCH(tok2, "%var% = %bool% ;") ||
+                      TOKEN_MATCH(tok2, "%var% = %var% ;") ||
+                      TOKEN_MATCH(tok2, "%var% = & %var% ;") ||
+                      TOKEN_MATCH(tok2, "%var% = & %var% [ 0 ] ;")))
             {
                 const unsigned int varid = tok2->varId();
                 if (varid == 0)
                     continue;
 
                 // skip loop variable
-                if (Token::Match(tok2->tokAt(-2), "(|:: %type%"))
+                if (TOKEN_MATCH(tok2->tokAt(-2), "(|:: %type%"))
                 {
                     const Token *tok3 = tok2->previous();
-                    while (Token::Match(tok3->previous(), ":: %type%"))
+                    while (TOKEN_MATCH(tok3->previous(), ":: %type%"))
                         tok3 = tok3->tokAt(-2);
-                    if (Token::Match(tok3->tokAt(-2), "for ( %type%"))
+                    if (TOKEN_MATCH(tok3->tokAt(-2), "for ( %type%"))
                         continue;
                 }
 
                 // struct name..
-                const std::string structname = Token::Match(tok2->tokAt(-3), "[;{}] %var% .") ?
+                const std::string structname = TOKEN_MATCH(tok2->tokAt(-3), "[;{}] %var% .") ?
                                                std::string(tok2->strAt(-2) + " .") :
                                                std::string("");
 
@@ -6366,7 +6590,7 @@ bool Tokenizer::simplifyKnownVariables()
                 ret |= simplifyKnownVariablesSimplify(&tok2, tok3, varid, structname, value, valueVarId, valueIsPointer, valueToken, indentlevel);
             }
 
-            else if (Token::Match(tok2, "strcpy ( %var% , %str% ) ;"))
+            else if (TOKEN_MATCH(tok2, "strcpy ( %var% , %str% ) ;"))
             {
                 const unsigned int varid(tok2->tokAt(2)->varId());
                 if (varid == 0)
@@ -6395,7 +6619,7 @@ bool Tokenizer::simplifyKnownVariablesGetData(unsigned int varid, Token **_tok2,
     Token *tok2 = *_tok2;
     Token *tok3 = *_tok3;
 
-    if (Token::Match(tok2->tokAt(-2), "for ( %varid% = %num% ; %varid% <|<= %num% ; ++| %varid% ++| ) {", varid))
+    if (TOKEN_MATCH_VARID(tok2->tokAt(-2), "for ( %varid% = %num% ; %varid% <|<= %num% ; ++| %varid% ++| ) {", varid))
     {
         // is there a "break" in the for loop?
         bool hasbreak = false;
@@ -6473,7 +6697,7 @@ bool Tokenizer::simplifyKnownVariablesGetData(unsigned int varid, Token **_tok2,
 
 bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsigned int varid, const std::string &structname, std::string &value, unsigned int valueVarId, bool valueIsPointer, const Token * const valueToken, int indentlevel)
 {
-    const bool pointeralias(valueToken->isName() || Token::Match(valueToken, "& %var% ["));
+    const bool pointeralias(valueToken->isName() || TOKEN_MATCH(valueToken, "& %var% ["));
 
     bool ret = false;
 
@@ -6491,7 +6715,7 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
             --indentlevel3;
             if (indentlevel3 < indentlevel)
             {
-                if (Token::Match((*tok2)->tokAt(-7), "%type% * %var% ; %var% = & %var% ;") &&
+                if (TOKEN_MATCH((*tok2)->tokAt(-7), "%type% * %var% ; %var% = & %var% ;") &&
                     (*tok2)->tokAt(-5)->str() == (*tok2)->tokAt(-3)->str())
                 {
                     (*tok2) = (*tok2)->tokAt(-4);
@@ -6502,7 +6726,7 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
         }
 
         // Stop if label is found
-        if (Token::Match(tok3, "; %type% : ;"))
+        if (TOKEN_MATCH(tok3, "; %type% : ;"))
             break;
 
         // Stop if return or break is found ..
@@ -6529,8 +6753,8 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
             bool bailout = false;
             for (const Token *tok4 = tok3; tok4 && tok4 != endpar; tok4 = tok4->next())
             {
-                if (Token::Match(tok4, "++|-- %varid%", varid) ||
-                    Token::Match(tok4, "%varid% ++|--|=", varid))
+                if (TOKEN_MATCH_VARID(tok4, "++|-- %varid%", varid) ||
+                    TOKEN_MATCH_VARID(tok4, "%varid% ++|--|=", varid))
                 {
                     bailout = true;
                     break;
@@ -6570,7 +6794,7 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
         }
 
         // Variable used in realloc (see Ticket #1649)
-        if (Token::Match(tok3, "%var% = realloc ( %var% ,") &&
+        if (TOKEN_MATCH(tok3, "%var% = realloc ( %var% ,") &&
             tok3->varId() == varid &&
             tok3->tokAt(4)->varId() == varid)
         {
@@ -6579,10 +6803,10 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
         }
 
         // condition "(|&&|%OROR% %varid% )|&&|%OROR%
-        if (!Token::Match(tok3->previous(), "( %var% )") &&
-            (Token::Match(tok3->previous(), "&&|(") || tok3->strAt(-1) == "||") &&
+        if (!TOKEN_MATCH(tok3->previous(), "( %var% )") &&
+            (TOKEN_MATCH(tok3->previous(), "&&|(") || tok3->strAt(-1) == "||") &&
             tok3->varId() == varid &&
-            (Token::Match(tok3->next(), "&&|)") || tok3->strAt(1) == "||"))
+            (TOKEN_MATCH(tok3->next(), "&&|)") || tok3->strAt(1) == "||"))
         {
             tok3->str(value);
             ret = true;
@@ -6601,7 +6825,7 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
                     break;
 
                 // suppress debug-warning when calling member function
-                if (Token::Match(tok3->next(), ". %var% ("))
+                if (TOKEN_MATCH(tok3->next(), ". %var% ("))
                     break;
 
                 // suppress debug-warning when assignment
@@ -6609,17 +6833,17 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
                     break;
 
                 // taking address of variable..
-                if (Token::Match(tok3->tokAt(-2), "return|= & %var% ;"))
+                if (TOKEN_MATCH(tok3->tokAt(-2), "return|= & %var% ;"))
                     break;
 
                 // parameter in function call..
-                if (Token::Match(tok3->tokAt(-2), "%var% ( %var% ,|)") ||
-                    Token::Match(tok3->previous(), ", %var% ,|)"))
+                if (TOKEN_MATCH(tok3->tokAt(-2), "%var% ( %var% ,|)") ||
+                    TOKEN_MATCH(tok3->previous(), ", %var% ,|)"))
                     break;
 
                 // conditional increment
-                if (Token::Match(tok3->tokAt(-3), ") { ++|--") ||
-                    Token::Match(tok3->tokAt(-2), ") { %var% ++|--"))
+                if (TOKEN_MATCH(tok3->tokAt(-3), ") { ++|--") ||
+                    TOKEN_MATCH(tok3->tokAt(-2), ") { %var% ++|--"))
                     break;
 
                 std::list<ErrorLogger::ErrorMessage::FileLocation> locationList;
@@ -6646,7 +6870,7 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
         if (Token::Match(tok3->previous(), ("if ( " + structname + " %varid% ==|!=|<|<=|>|>=|)").c_str(), varid) ||
             Token::Match(tok3, ("( " + structname + " %varid% ==|!=|<|<=|>|>=").c_str(), varid) ||
             Token::Match(tok3, ("!|==|!=|<|<=|>|>= " + structname + " %varid% ==|!=|<|<=|>|>=|)|;").c_str(), varid) ||
-            Token::Match(tok3->previous(), "strlen|free ( %varid% )", varid))
+            TOKEN_MATCH_VARID(tok3->previous(), "strlen|free ( %varid% )", varid))
         {
             if (value[0] == '\"' && tok3->strAt(-1) != "strlen")
             {
@@ -6659,7 +6883,7 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
                 tok3->deleteNext();
                 tok3->deleteNext();
             }
-            if (Token::Match(valueToken, "& %var% ;"))
+            if (TOKEN_MATCH(valueToken, "& %var% ;"))
             {
                 tok3->insertToken("&");
                 tok3 = tok3->next();
@@ -6672,8 +6896,8 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
 
         // Delete pointer alias
         if (pointeralias && tok3->str() == "delete" &&
-            (Token::Match(tok3, "delete %varid% ;", varid) ||
-             Token::Match(tok3, "delete [ ] %varid%", varid)))
+            (TOKEN_MATCH_VARID(tok3, "delete %varid% ;", varid) ||
+             TOKEN_MATCH_VARID(tok3, "delete [ ] %varid%", varid)))
         {
             tok3 = (tok3->strAt(1) == "[") ? tok3->tokAt(3) : tok3->next();
             tok3->str(value);
@@ -6783,7 +7007,7 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
                         break;
                     --indentlevel4;
                 }
-                if (Token::Match(tok4, "{|, %varid% ,|}", varid))
+                if (TOKEN_MATCH_VARID(tok4, "{|, %varid% ,|}", varid))
                 {
                     tok4->next()->str(value);
                     tok4->next()->varId(valueVarId);
@@ -6801,7 +7025,7 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
                     break;
 
                 // Replace variable used in condition..
-                if (Token::Match(tok4, "; %var% <|<=|!= %var% ; ++| %var% ++| )"))
+                if (TOKEN_MATCH(tok4, "; %var% <|<=|!= %var% ; ++| %var% ++| )"))
                 {
                     const Token *inctok = tok4->tokAt(5);
                     if (inctok->str() == "++")
@@ -6825,10 +7049,10 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
             }
         }
 
-        if (indentlevel == indentlevel3 && Token::Match(tok3->next(), "%varid% ++|--", varid) && MathLib::isInt(value))
+        if (indentlevel == indentlevel3 && TOKEN_MATCH_VARID(tok3->next(), "%varid% ++|--", varid) && MathLib::isInt(value))
         {
             const std::string op(tok3->strAt(2));
-            if (Token::Match(tok3, "[{};] %any% %any% ;"))
+            if (TOKEN_MATCH(tok3, "[{};] %any% %any% ;"))
             {
                 Token::eraseTokens(tok3, tok3->tokAt(3));
             }
@@ -6848,13 +7072,13 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
             ret = true;
         }
 
-        if (indentlevel == indentlevel3 && Token::Match(tok3->next(), "++|-- %varid%", varid) && MathLib::isInt(value) &&
-            !Token::Match(tok3->tokAt(3), "[.[]"))
+        if (indentlevel == indentlevel3 && TOKEN_MATCH_VARID(tok3->next(), "++|-- %varid%", varid) && MathLib::isInt(value) &&
+            !TOKEN_MATCH(tok3->tokAt(3), "[.[]"))
         {
             incdec(value, tok3->strAt(1));
             (*tok2)->tokAt(2)->str(value);
             (*tok2)->tokAt(2)->varId(valueVarId);
-            if (Token::Match(tok3, "[;{}] %any% %any% ;"))
+            if (TOKEN_MATCH(tok3, "[;{}] %any% %any% ;"))
             {
                 Token::eraseTokens(tok3, tok3->tokAt(3));
             }
@@ -6869,7 +7093,7 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
         }
 
         // return variable..
-        if (Token::Match(tok3, "return %varid% %any%", varid) &&
+        if (TOKEN_MATCH_VARID(tok3, "return %varid% %any%", varid) &&
             isOp(tok3->tokAt(2)) &&
             value[0] != '\"')
         {
@@ -6877,7 +7101,7 @@ bool Tokenizer::simplifyKnownVariablesSimplify(Token **tok2, Token *tok3, unsign
             tok3->next()->varId(valueVarId);
         }
 
-        else if (pointeralias && Token::Match(tok3, "return * %varid% ;", varid) && value[0] != '\"')
+        else if (pointeralias && TOKEN_MATCH_VARID(tok3, "return * %varid% ;", varid) && value[0] != '\"')
         {
             tok3->deleteNext();
             tok3->next()->str(value);
@@ -6920,7 +7144,7 @@ void Tokenizer::elseif()
 bool Tokenizer::simplifyRedundantParanthesis()
 {
     bool ret = false;
-    for (Token *tok = _tokens; tok; tok = tok->next())
+    for (Token *tok = _tokens; tok; tok = skipUnchangedScope(tok->next()))
     {
         if (tok->str() != "(")
             continue;
@@ -7028,7 +7252,7 @@ void Tokenizer::simplifyReference()
             for (Token *tok2 = tok; tok2 && tok2 != end; tok2 = tok2->next())
             {
                 // found a reference..
-                if (Token::Match(tok2, "[;{}] %type% & %var% (|= %var% )| ;"))
+                if (TOKEN_MATCH(tok2, "[;{}] %type% & %var% (|= %var% )| ;"))
                 {
                     const unsigned int ref_id = tok2->tokAt(3)->varId();
                     if (!ref_id)
@@ -7054,7 +7278,7 @@ void Tokenizer::simplifyReference()
 bool Tokenizer::simplifyCalculations()
 {
     bool ret = false;
-    for (Token *tok = _tokens; tok; tok = tok->next())
+    for (Token *tok = _tokens; tok; tok = skipUnchangedScope(tok->next()))
     {
         // Remove parentheses around variable..
         // keep parentheses here: dynamic_cast<Fred *>(p);
@@ -7063,7 +7287,7 @@ bool Tokenizer::simplifyCalculations()
         // keep parentheses here: int ( * * ( * compilerHookVector ) (void) ) ( ) ;
         // keep parentheses here: operator new [] (size_t);
         // keep parentheses here: Functor()(a ... )
-        if (Token::Match(tok->next(), "( %var% ) [;),+-*/><]]") &&
+        if (TOKEN_MATCH(tok->next(), "( %var% ) [;),+-*/><]]") &&
             !tok->isName() &&
             tok->str() != ">" &&
             tok->str() != "]" &&
@@ -7817,6 +8041,7 @@ void Tokenizer::simplifyEnum()
                     const std::string pattern = className.empty() ?
                                                 std::string("") :
                                                 std::string(className + " :: " + enumName->str());
+                    const MatchPattern classPattern(pattern.c_str());
                     int level = 1;
                     bool inScope = true;
 
@@ -7861,7 +8086,7 @@ void Tokenizer::simplifyEnum()
                                 ++level;
                             }
                         }
-                        else if (!pattern.empty() && Token::Match(tok2, pattern.c_str()))
+                        else if (!pattern.empty() && classPattern.match(tok2))
                         {
                             simplify = true;
                             hasClass = true;
@@ -8094,7 +8319,10 @@ void Tokenizer::fillFunctionList()
 // Deallocate lists..
 void Tokenizer::deallocateTokens()
 {
-    deleteTokens(_tokens);
+    // The tokens in the arena are released all at once
+    if (!_arena.usesSlabs())
+        deleteTokens(_tokens);
+    _arena.release();
     _tokens = 0;
     _tokensBack = 0;
     _files.clear();
@@ -8105,7 +8333,7 @@ void Tokenizer::deleteTokens(Token *tok)
     while (tok)
     {
         Token *next = tok->next();
-        delete tok;
+        Token::destroy(tok);
         tok = next;
     }
 }
@@ -8473,7 +8701,7 @@ bool Tokenizer::validate() const
     for (const Token *tok = tokens(); tok; tok = tok->next())
     {
         lastTok = tok;
-        if (Token::Match(tok, "[{([]"))
+        if (TOKEN_MATCH(tok, "[{([]"))
         {
             if (tok->link() == 0)
             {
@@ -8485,7 +8713,7 @@ bool Tokenizer::validate() const
             continue;
         }
 
-        else if (Token::Match(tok, "[})]]"))
+        else if (TOKEN_MATCH(tok, "[})]]"))
         {
             if (tok->link() == 0)
             {
@@ -8656,7 +8884,7 @@ void Tokenizer::simplifyComparisonOrder()
     // Use "<" comparison instead of ">"
     for (Token *tok = _tokens; tok; tok = tok->next())
     {
-        if (Token::Match(tok, "[;(] %any% >|>= %any% [);]"))
+        if (TOKEN_MATCH(tok, "[;(] %any% >|>= %any% [);]"))
         {
             if (!tok->next()->isName() && !tok->next()->isNumber())
                 continue;
@@ -8668,7 +8896,7 @@ void Tokenizer::simplifyComparisonOrder()
             else
                 tok->tokAt(2)->str("<=");
         }
-        else if (Token::Match(tok, "( %num% ==|!= %var% )"))
+        else if (TOKEN_MATCH(tok, "( %num% ==|!= %var% )"))
         {
             if (!tok->next()->isName() && !tok->next()->isNumber())
                 continue;
@@ -28,10 +28,12 @@
 #include <vector>
 #include <set>
 
-class Token;
+#include "token.h"
+
 class ErrorLogger;
 class Settings;
 class SymbolDatabase;
+class TimerResultsIntf;
 
 /// @addtogroup Core
 /// @{
@@ -108,6 +110,24 @@ public:
      */
     bool simplifyTokenList();
 
+    /**
+     * Where the times of the simplifications are stored when
+     * --showtime is used
+     */
+    void setTimerResults(TimerResultsIntf *timerResults)
+    {
+        _timerResults = timerResults;
+    }
+
+    /**
+     * Allocate the tokens with new instead of from the slabs of the
+     * token arena. It is used to benchmark the arena.
+     */
+    void allocateTokensWithNew()
+    {
+        _arena.useSlabs(false);
+    }
+
     /**
      * Delete all tokens in given token list
      * @param tok token list to delete
@@ -663,12 +683,84 @@ private:
     /** Disable copy constructor, no implementation */
     Tokenizer(const Tokenizer &);
 
+    /** Run a simplification. It is timed and its tokens are counted with --showtime */
+    void runPass(const char name[], void (Tokenizer::*pass)());
+
+    /** Run a simplification. It is timed and its tokens are counted with --showtime. @return the result of the simplification */
+    bool runPass(const char name[], bool (Tokenizer::*pass)());
+
+    /**
+     * A local simplification that is run with other rules in one walk
+     * over the token list, see runRules(). It only reads and changes tok
+     * and the tokens after it. It may move tok forward over the tokens
+     * that it has handled, but the rules that it is run with must not
+     * match those tokens.
+     */
+    typedef void (Tokenizer::*Rule)(Token *&tok);
+
+    /**
+     * Run the rules at each token, in one walk over the token list. The
+     * walk is timed as one pass with --showtime.
+     * @param name name of the walk
+     * @param rules the rules, they are run in this order at each token
+     * @param count number of rules
+     */
+    void runRules(const char name[], const Rule rules[], unsigned int count);
+
+    /** The walk of runRules() */
+    void applyRules(const Rule rules[], unsigned int count);
+
+    /** Rule: "+ +" => "+", "+ -" => "-", "- -" => "+" and "- +" => "-" */
+    void simplifyPlusMinus(Token *&tok);
+
+    /** Rule: "0[a]" => "a[0]" */
+    void simplifyArrayIndex(Token *&tok);
+
+    /** Rule: "strlen("abc")" => "3" */
+    void simplifyStrlen(Token *&tok);
+
+    /** Rule: "int a[] ;" => "int * a ;" */
+    void simplifyArrayToPointer(Token *&tok);
+
+    /** Rule: "*(str + num)" => "str[num]" */
+    void simplifyDereference(Token *&tok);
+
+    /** Rule: "x=realloc(y,0);" => "free(y); x=0;" and "x = realloc (0, n);" => "x = malloc(n);" */
+    void simplifyRealloc(Token *&tok);
+
+    /** Number of tokens in the token list */
+    unsigned long tokenCount() const;
+
+    /** Give the number of tokens before and after a simplification to the timer results */
+    void addTokenCounts(const std::string &name, unsigned long tokensBefore) const;
+
+    /**
+     * Compare the top level scopes with the last round of simplifications
+     * and mark the scopes that were not changed, see Token::isUnchangedScope
+     * @param hashes hashes of the tokens in front of each scope and of
+     * the scope. They are compared with the current scopes and then
+     * replaced.
+     */
+    void markUnchangedScopes(std::vector<std::pair<unsigned int, unsigned int> > &hashes);
+
+    /** All scopes are simplified by the next simplifications */
+    void clearUnchangedScopes();
+
+    /** Skip the scope that starts at tok if it was not changed by the last round of simplifications */
+    static Token *skipUnchangedScope(Token *tok)
+    {
+        return (tok && tok->isUnchangedScope()) ? tok->link() : tok;
+    }
+
     /** Disable assignment operator, no implementation */
     Tokenizer &operator=(const Tokenizer &);
 
     /** Token list */
     Token *_tokens, *_tokensBack;
 
+    /** memory for the tokens */
+    TokenArena _arena;
+
     /** sizeof information for known types */
     std::map<std::string, unsigned int> _typeSize;
 
@@ -681,6 +773,9 @@ private:
     /** errorlogger */
     ErrorLogger * const _errorLogger;
 
+    /** times of the simplifications, for --showtime */
+    TimerResultsIntf *_timerResults;
+
     /** E.g. "A" for code where "#ifdef A" is true. This is used to
         print additional information in error situations. */
     std::string _configuration;
@@ -70,6 +70,7 @@ SOURCES += options.cpp \
            testsuite.cpp \
            testsymboldatabase.cpp \
            testthreadexecutor.cpp \
+           testtimer.cpp \
            testtoken.cpp \
            testtokenize.cpp \
            testuninitvar.cpp \
@@ -20,6 +20,7 @@
 #include "cmdlineparser.h"
 #include "settings.h"
 #include "redirect.h"
+#include "timer.h"
 
 class TestCmdlineParser : public TestFixture
 {
@@ -73,7 +74,11 @@ private:
         TEST_CASE(jobs);
         TEST_CASE(jobsMissingCount);
         TEST_CASE(jobsInvalid);
+        TEST_CASE(executorThreads);
+        TEST_CASE(executorInvalid);
         TEST_CASE(reportProgress);
+        TEST_CASE(showtimeCsv);
+        TEST_CASE(showtimeJson);
         TEST_CASE(suppressionsOld); // TODO: Create and test real suppression file
         TEST_CASE(suppressions)
         TEST_CASE(suppressionsNoFile)
@@ -517,6 +522,27 @@ private:
         ASSERT(!parser.ParseFromArgs(4, argv));
     }
 
+    void executorThreads()
+    {
+        REDIRECT;
+        const char *argv[] = {"cppcheck", "-j", "3", "--executor=threads", "file.cpp"};
+        Settings settings;
+        CmdLineParser parser(&settings);
+        ASSERT_EQUALS(Settings::EXECUTOR_PROCESSES, settings._executor);
+        ASSERT(parser.ParseFromArgs(5, argv));
+        ASSERT_EQUALS(Settings::EXECUTOR_THREADS, settings._executor);
+        ASSERT_EQUALS(3, settings._jobs);
+    }
+
+    void executorInvalid()
+    {
+        REDIRECT;
+        const char *argv[] = {"cppcheck", "--executor=fibers", "file.cpp"};
+        Settings settings;
+        CmdLineParser parser(&settings);
+        ASSERT(!parser.ParseFromArgs(3, argv));
+    }
+
     void reportProgress()
     {
         REDIRECT;
@@ -527,6 +553,26 @@ private:
         ASSERT(settings.reportProgress);
     }
 
+    void showtimeCsv()
+    {
+        REDIRECT;
+        const char *argv[] = {"cppcheck", "--showtime=csv", "file.cpp"};
+        Settings settings;
+        CmdLineParser parser(&settings);
+        ASSERT(parser.ParseFromArgs(3, argv));
+        ASSERT_EQUALS(SHOWTIME_CSV, settings._showtime);
+    }
+
+    void showtimeJson()
+    {
+        REDIRECT;
+        const char *argv[] = {"cppcheck", "--showtime=json", "file.cpp"};
+        Settings settings;
+        CmdLineParser parser(&settings);
+        ASSERT(parser.ParseFromArgs(3, argv));
+        ASSERT_EQUALS(SHOWTIME_JSON, settings._showtime);
+    }
+
     void suppressionsOld()
     {
         // TODO: Fails because there is no suppr.txt file!
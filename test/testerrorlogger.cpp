@@ -40,6 +40,9 @@ private:
         TEST_CASE(ToXml);
         TEST_CASE(ToVerboseXml);
         TEST_CASE(ToXmlV2);
+        TEST_CASE(SerializeRoundTrip);
+        TEST_CASE(DeserializeInvalid);
+        TEST_CASE(MessageSet);
     }
 
     void FileLocationDefaults()
@@ -162,5 +165,90 @@ private:
         message += "    <location file=\"foo.cpp\" line=\"5\"/>\n  </error>";
         ASSERT_EQUALS(message, msg.toXML(false,2));
     }
+
+    void SerializeRoundTrip()
+    {
+        std::list<ErrorLogger::ErrorMessage::FileLocation> locs;
+        locs.push_back(ErrorLogger::ErrorMessage::FileLocation("foo.cpp", 5));
+        locs.push_back(ErrorLogger::ErrorMessage::FileLocation("dir with spaces/bar:1.h", 123456));
+        std::string verbose("Verbose\n");
+        verbose += '\0';
+        verbose += "\x01 message";
+        ErrorMessage msg(locs, Severity::style, "Short 1 2\n" + verbose, "errorId");
+
+        const std::string data(msg.serialize());
+        ErrorMessage msg2;
+        ASSERT(msg2.deserialize(data));
+        ASSERT_EQUALS("errorId", msg2._id);
+        ASSERT_EQUALS(Severity::style, msg2._severity);
+        ASSERT_EQUALS("Short 1 2", msg2.shortMessage());
+        ASSERT_EQUALS(verbose, msg2.verboseMessage());
+        ASSERT_EQUALS(2U, msg2._callStack.size());
+        ASSERT_EQUALS("foo.cpp", msg2._callStack.front().getfile(false));
+        ASSERT_EQUALS(5U, msg2._callStack.front().line);
+        ASSERT_EQUALS("dir with spaces/bar:1.h", msg2._callStack.back().getfile(false));
+        ASSERT_EQUALS(123456U, msg2._callStack.back().line);
+        ASSERT_EQUALS(msg.toString(true), msg2.toString(true));
+
+        // Directly from a buffer with more data after the message
+        const std::string buffer(data + "next message");
+        ErrorMessage msg3;
+        ASSERT(msg3.deserialize(buffer.data(), data.size()));
+        ASSERT_EQUALS(msg.toString(true), msg3.toString(true));
+    }
+
+    void DeserializeInvalid()
+    {
+        std::list<ErrorLogger::ErrorMessage::FileLocation> locs;
+        locs.push_back(ErrorLogger::ErrorMessage::FileLocation("foo.cpp", 5));
+        ErrorMessage msg(locs, Severity::error, "Programming error.", "errorId");
+        const std::string data(msg.serialize());
+
+        ErrorMessage msg2;
+        ASSERT_EQUALS(false, msg2.deserialize(""));
+        ASSERT_EQUALS(false, msg2.deserialize("5 error"));
+        ASSERT_EQUALS(false, msg2.deserialize(data.substr(0, data.size() - 1)));
+        ASSERT_EQUALS(false, msg2.deserialize(data + "x"));
+    }
+
+    void MessageSet()
+    {
+        std::list<ErrorLogger::ErrorMessage::FileLocation> locs;
+        locs.push_back(ErrorLogger::ErrorMessage::FileLocation("foo.cpp", 5));
+        ErrorMessage msg(locs, Severity::error, "Programming error.\nVerbose error", "errorId");
+
+        ErrorMessageSet set;
+        ASSERT_EQUALS(true, set.insert(msg, false));
+        ASSERT_EQUALS(false, set.insert(msg, false));
+
+        // The same text is the same message, the id is not written
+        ErrorMessage msg2(locs, Severity::error, "Programming error.\nOther verbose error", "otherId");
+        ASSERT_EQUALS(false, set.insert(msg2, false));
+        ASSERT_EQUALS(true, set.insert(msg2, true));
+
+        ErrorMessage msg3(locs, Severity::style, "Programming error.", "errorId");
+        ASSERT_EQUALS(true, set.insert(msg3, false));
+        locs.push_back(ErrorLogger::ErrorMessage::FileLocation("bar.cpp", 5));
+        ErrorMessage msg4(locs, Severity::error, "Programming error.", "errorId");
+        ASSERT_EQUALS(true, set.insert(msg4, false));
+        ASSERT_EQUALS(4U, set.size());
+
+        // Many messages, they are still found when the set has grown
+        for (unsigned int i = 1; i <= 1000; ++i)
+        {
+            locs.back().line = 100 + i;
+            ASSERT_EQUALS(true, set.insert(ErrorMessage(locs, Severity::error, "Programming error.", "errorId"), false));
+        }
+        for (unsigned int i = 1; i <= 1000; ++i)
+        {
+            locs.back().line = 100 + i;
+            ASSERT_EQUALS(false, set.insert(ErrorMessage(locs, Severity::error, "Programming error.", "errorId"), false));
+        }
+        ASSERT_EQUALS(1004U, set.size());
+
+        set.clear();
+        ASSERT_EQUALS(0U, set.size());
+        ASSERT_EQUALS(true, set.insert(msg, false));
+    }
 };
 REGISTER_TEST(TestErrorLogger)
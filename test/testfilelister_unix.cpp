@@ -17,11 +17,14 @@
  */
 
 #include "testsuite.h"
+#include "pathmatch.h"
 
 #define private public
 
 #include "filelister_unix.h"
 
+#include <algorithm>
+
 class TestFileLister: public TestFixture
 {
 public:
@@ -32,31 +35,54 @@ public:
 private:
     void run()
     {
-        TEST_CASE(test_recursiveAddFiles2);
+        TEST_CASE(test_recursiveAddFiles);
+        TEST_CASE(test_recursiveAddFilesIgnored);
     }
 
-    void test_recursiveAddFiles2()
+    void test_recursiveAddFiles()
     {
-        std::vector<std::string> relative, absolute;
+        std::vector<std::string> filenames;
         FileListerUnix ful;
-        ful.recursiveAddFiles2(relative, absolute, ".");
+        ful.recursiveAddFiles(filenames, ".");
 
-        ASSERT(relative.size() != 0);
-        ASSERT_EQUALS((int)relative.size(), (int)absolute.size());
+        ASSERT(filenames.size() != 0);
+        ASSERT(std::find(filenames.begin(), filenames.end(), "./lib/tokenize.cpp") != filenames.end());
 
-        for (std::vector<std::string>::const_iterator r = relative.begin(), r_end = relative.end(),
-             a = absolute.begin(), a_end = absolute.end();
-             r != r_end && a != a_end;
-             ++r, ++a
-            )
+        // Depth first, sorted by name, each file once
+        std::vector<std::string> sorted(filenames);
+        std::sort(sorted.begin(), sorted.end());
+        ASSERT(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+        for (std::vector<std::string>::const_iterator it = filenames.begin(); it != filenames.end(); ++it)
         {
-            static const size_t start_at_relative = std::string("./").size();
-            static const size_t start_at_absolute = std::string("./").size() + a->size() - r->size();
+            ASSERT_EQUALS("./", it->substr(0, 2));
+            ASSERT_EQUALS(std::string::npos, it->find("/."));
+        }
+        ASSERT(std::find(filenames.begin(), filenames.end(), "./cli/main.cpp") <
+               std::find(filenames.begin(), filenames.end(), "./lib/tokenize.cpp"));
+    }
+
+    void test_recursiveAddFilesIgnored()
+    {
+        std::vector<std::string> masks;
+        masks.push_back("lib/");
+        masks.push_back("main.cpp");
+        const PathMatch ignored(masks);
 
-            ASSERT_EQUALS(r->substr(start_at_relative), a->substr(start_at_absolute));
+        std::vector<std::string> all, filenames;
+        FileListerUnix ful;
+        ful.recursiveAddFiles(all, ".");
+        ful.recursiveAddFiles(filenames, ".", ignored);
+
+        // The same files as when they are filtered afterwards
+        std::vector<std::string> filtered;
+        for (std::vector<std::string>::const_iterator it = all.begin(); it != all.end(); ++it)
+        {
+            if (!ignored.Match(*it))
+                filtered.push_back(*it);
         }
+        ASSERT(filtered.size() < all.size());
+        ASSERT(filtered == filenames);
     }
 };
 
 REGISTER_TEST(TestFileLister)
-
@@ -31,6 +31,9 @@
 #include <string>
 #include <sstream>
 #include <stdexcept>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
 
 extern std::ostringstream errout;
 extern std::ostringstream output;
@@ -58,6 +61,12 @@ public:
         {
             return Preprocessor::getHeaderFileName(str);
         }
+
+        static std::size_t ordinaryCode(const std::string &str, std::size_t pos, bool scalar)
+        {
+            return scalar ? Preprocessor::ordinaryCodeScalar(str.data() + pos, str.size() - pos)
+                   : Preprocessor::ordinaryCode(str.data() + pos, str.size() - pos);
+        }
     };
 
 private:
@@ -67,6 +76,7 @@ private:
         // Just read the code into a string. Perform simple cleanup of the code
         TEST_CASE(readCode1);
         TEST_CASE(readCode2);
+        TEST_CASE(ordinaryCode);
 
         // The bug that started the whole work with the new preprocessor
         TEST_CASE(Bug2190219);
@@ -200,6 +210,9 @@ private:
         TEST_CASE(macro_parameters);
         TEST_CASE(newline_in_macro);
         TEST_CASE(includes);
+        TEST_CASE(includeCache);
+        TEST_CASE(includeLargeHeader);
+        TEST_CASE(includeNested);
         TEST_CASE(ifdef_ifdefined);
 
         // define and then ifdef
@@ -207,7 +220,9 @@ private:
         TEST_CASE(define_ifdef);
         TEST_CASE(define_ifndef1);
         TEST_CASE(define_ifndef2);
+        TEST_CASE(define_cfgs);
         TEST_CASE(endfile);
+        TEST_CASE(conditionalCode);
 
         TEST_CASE(redundant_config);
 
@@ -241,6 +256,32 @@ private:
         ASSERT_EQUALS("\" \\\" /* abc */ \\n\"\n", codestr);
     }
 
+    void ordinaryCode()
+    {
+        ASSERT_EQUALS(3, OurPreprocessor::ordinaryCode("abc d", 0, false));
+        ASSERT_EQUALS(20, OurPreprocessor::ordinaryCode("x=a+b;y=c*d;z=f(x,y)/2;", 0, false));
+        ASSERT_EQUALS(0, OurPreprocessor::ordinaryCode("R\"(x)\"", 0, false));
+
+        // Compare the vectorized and the scalar scan on random code
+        const char chars[] = "abcxyzR019_;(){}[]+-*=<>!&|\\/#\"' \t\n\r\x01\x7f\x80\xff";
+        std::srand(2011);
+        for (unsigned int i = 0; i < 200; ++i)
+        {
+            std::string str;
+            const unsigned int length = static_cast<unsigned int>(std::rand() % 100);
+            const unsigned int special = 1 + static_cast<unsigned int>(std::rand() % 40);
+            for (unsigned int j = 0; j < length; ++j)
+            {
+                // Long runs of ordinary code with a few other characters
+                const bool ordinary = (std::rand() % special) != 0;
+                str += chars[std::rand() % (ordinary ? 22 : (sizeof(chars) - 1))];
+            }
+
+            for (std::size_t pos = 0; pos <= str.size(); ++pos)
+                ASSERT_EQUALS(OurPreprocessor::ordinaryCode(str, pos, true), OurPreprocessor::ordinaryCode(str, pos, false));
+        }
+    }
+
 
     void Bug2190219()
     {
@@ -2481,6 +2522,122 @@ private:
         }
     }
 
+    std::string preprocessInclude(Settings &settings)
+    {
+        std::istringstream istr("#include \"testpreprocessor_cache.h\"\n");
+        Preprocessor preprocessor(&settings, this);
+        std::string processedFile;
+        std::list<std::string> configurations;
+        preprocessor.preprocess(istr, processedFile, configurations, "testpreprocessor_cache.c", std::list<std::string>());
+        return processedFile;
+    }
+
+    void includeCache()
+    {
+        const char header[] = "testpreprocessor_cache.h";
+
+        {
+            std::ofstream fout(header);
+            fout << "int a; // comment\n";
+        }
+        Settings settings;
+        ASSERT_EQUALS("#file \"testpreprocessor_cache.h\"\nint a;\n\n#endfile\n", preprocessInclude(settings));
+        ASSERT_EQUALS("#file \"testpreprocessor_cache.h\"\nint a;\n\n#endfile\n", preprocessInclude(settings));
+
+        // The header has changed
+        {
+            std::ofstream fout(header);
+            fout << "int abc;\n";
+        }
+        ASSERT_EQUALS("#file \"testpreprocessor_cache.h\"\nint abc;\n\n#endfile\n", preprocessInclude(settings));
+
+        // The inline suppressions are added for each file that includes the header
+        {
+            std::ofstream fout(header);
+            fout << "// cppcheck-suppress uninitvar\nint x;\n";
+        }
+        for (int i = 0; i < 2; ++i)
+        {
+            Settings settings2;
+            settings2._inlineSuppressions = true;
+            preprocessInclude(settings2);
+            ASSERT_EQUALS(true, settings2.nomsg.isSuppressed("uninitvar", "testpreprocessor_cache.h", 2));
+        }
+
+        std::remove(header);
+    }
+
+    void includeLargeHeader()
+    {
+        // Large headers are mapped to memory
+        std::string header;
+        for (unsigned int i = 0; i < 5000; ++i)
+            header += "int a; /* comment */ \\\r\n\tint b; // comment\r\n";
+
+        {
+            std::ofstream fout("testpreprocessor_cache.h", std::ios::out | std::ios::binary);
+            fout << header;
+        }
+        Settings settings;
+        Preprocessor preprocessor(&settings, this);
+        std::istringstream istr(header);
+        const std::string expected("#file \"testpreprocessor_cache.h\"\n" + preprocessor.read(istr, "testpreprocessor_cache.h", &settings) + "\n#endfile\n");
+        ASSERT_EQUALS(expected, preprocessInclude(settings));
+
+        std::remove("testpreprocessor_cache.h");
+    }
+
+    void includeNested()
+    {
+        {
+            std::ofstream fout("testpreprocessor_a.h");
+            fout << "int a;\n"
+                 << "#include \"testpreprocessor_b.h\"\n"
+                 << "#include \"missing1.h\"\n"
+                 << "int c;\n";
+        }
+        {
+            std::ofstream fout("testpreprocessor_b.h");
+            fout << "int b;\n"
+                 << "#include \"testpreprocessor_a.h\"\n";
+        }
+
+        errout.str("");
+        Settings settings;
+        settings.addEnabled("missingInclude");
+        Preprocessor preprocessor(&settings, this);
+        std::istringstream istr("int x;\n"
+                                "#include \"testpreprocessor_a.h\"\n"
+                                "#include \"missing2.h\"\n"
+                                "int y;\n");
+        std::string processedFile;
+        std::list<std::string> configurations;
+        preprocessor.preprocess(istr, processedFile, configurations, "test.c", std::list<std::string>());
+
+        std::remove("testpreprocessor_a.h");
+        std::remove("testpreprocessor_b.h");
+
+        ASSERT_EQUALS("int x;\n"
+                      "#file \"testpreprocessor_a.h\"\n"
+                      "int a;\n"
+                      "#file \"testpreprocessor_b.h\"\n"
+                      "int b;\n"
+                      "\n"
+                      "\n"
+                      "#endfile\n"
+                      "\n"
+                      "int c;\n"
+                      "\n"
+                      "#endfile\n"
+                      "\n"
+                      "int y;\n", processedFile);
+        // The line numbers in the source file are one too small
+        TODO_ASSERT_EQUALS("[testpreprocessor_a.h:3]: (information) Include file: \"missing1.h\" not found.\n"
+                           "[test.c:3]: (information) Include file: \"missing2.h\" not found.\n",
+                           "[testpreprocessor_a.h:3]: (information) Include file: \"missing1.h\" not found.\n"
+                           "[test.c:2]: (information) Include file: \"missing2.h\" not found.\n", errout.str());
+    }
+
     void ifdef_ifdefined()
     {
         const char filedata[] = "#ifdef ABC\n"
@@ -2685,6 +2842,35 @@ private:
     }
 
 
+    void define_cfgs()
+    {
+        const char filedata[] = "#define A 0\n"
+                                "#define A 1\n"
+                                "#if A\n"
+                                "#endif\n"
+                                "#ifdef NULL\n"
+                                "#endif\n"
+                                "#ifdef B\n"
+                                "#endif\n"
+                                "#ifndef B\n"
+                                "#endif\n"
+                                "#if defined(C) && defined(A)\n"
+                                "#endif\n";
+
+        // Preprocess => actual result..
+        std::istringstream istr(filedata);
+        std::map<std::string, std::string> actual;
+        Settings settings;
+        Preprocessor preprocessor(&settings, this);
+        preprocessor.preprocess(istr, actual, "file.c");
+
+        // Compare results: A has a value, NULL is simplified and B is listed once
+        std::ostringstream cfgs;
+        for (std::map<std::string, std::string>::const_iterator it = actual.begin(); it != actual.end(); ++it)
+            cfgs << "[" << it->first << "]";
+        ASSERT_EQUALS("[][A;C][B]", cfgs.str());
+    }
+
     void endfile()
     {
         const char filedata[] = "char a[] = \"#endfile\";\n"
@@ -2703,6 +2889,34 @@ private:
         ASSERT_EQUALS(1, (int)actual.size());
     }
 
+    void conditionalCode()
+    {
+        // The skipped blocks keep their lines and the #file / #endfile lines
+        const char filedata[] = "#ifdef A\n"
+                                "#define B\n"
+                                "#ifdef C\n"
+                                "#file \"c.h\"\n"
+                                "c;\n"
+                                "#endfile\n"
+                                "#endif\n"
+                                "a;\n"
+                                "#elif defined(D)\n"
+                                "d;\n"
+                                "#else\n"
+                                "x;\n"
+                                "#endif\n"
+                                "#ifdef B\n"
+                                "b;\n"
+                                "#endif\n";
+
+        Settings settings;
+        const ConditionalCode code(filedata, &settings);
+        ASSERT_EQUALS("\n\n\n#file \"c.h\"\n\n#endfile\n\n\n\n\n\nx;\n\n\n\n\n", code.getcode("", "file.c", &settings, this));
+        ASSERT_EQUALS("\n\n\n#file \"c.h\"\n\n#endfile\n\na;\n\n\n\n\n\n\nb;\n\n", code.getcode("A", "file.c", &settings, this));
+        ASSERT_EQUALS("\n\n\n#file \"c.h\"\nc;\n#endfile\n\na;\n\n\n\n\n\n\nb;\n\n", code.getcode("A;C", "file.c", &settings, this));
+        ASSERT_EQUALS("\n\n\n#file \"c.h\"\n\n#endfile\n\n\n\nd;\n\n\n\n\n\n\n", code.getcode("D", "file.c", &settings, this));
+    }
+
     void dup_defines()
     {
         const char filedata[] = "#ifdef A\n"
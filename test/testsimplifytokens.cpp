@@ -22,8 +22,12 @@
 #include "tokenize.h"
 #include "token.h"
 #include "settings.h"
+#include "timer.h"
 
 #include <sstream>
+#include <set>
+#include <map>
+#include <utility>
 
 extern std::ostringstream errout;
 
@@ -302,6 +306,7 @@ private:
 
         // x = realloc(y,0);  =>  free(y);x=0;
         TEST_CASE(simplifyRealloc);
+        TEST_CASE(simplifyRules);
 
         // while(f() && errno==EINTR) { } => while (f()) { }
         TEST_CASE(simplifyErrNoInWhile);
@@ -333,6 +338,12 @@ private:
         TEST_CASE(removeUnnecessaryQualification2);
 
         TEST_CASE(simplifyIfNotNull);
+
+        // The simplifications are timed with --showtime
+        TEST_CASE(showtime);
+
+        // Scopes that are not changed are skipped by the next round of simplifications
+        TEST_CASE(unchangedScopes);
     }
 
     std::string tok(const char code[], bool simplify = true)
@@ -515,6 +526,10 @@ private:
                               "};\n"
                               "}\n";
         ASSERT_EQUALS(tok(code2), tok(code1));
+
+        // a wide string after a string
+        ASSERT_EQUALS("a = \"hello world\" ;", tok("a = \"hello \" L\"world\";"));
+        ASSERT_EQUALS("a = \"a\" L \"b\" ;", tok("a = \"a\" L L\"b\";"));
     }
 
     void double_plus()
@@ -6292,6 +6307,19 @@ private:
                       tok("; p = realloc(0, sizeof(char)*0);"));
     }
 
+    void simplifyRules()
+    {
+        // The rules that are run in the same walk, next to each other
+        ASSERT_EQUALS("; x = a + b ; y = p [ 0 ] ;",
+                      tok("; x = a - - b; y = 0[p];"));
+        ASSERT_EQUALS("; n = 3 ; extern int * a ;",
+                      tok("; n = strlen(\"abc\"); extern int a[];"));
+        ASSERT_EQUALS("; x = p [ 1 ] ; free ( p ) ; p = 0 ;",
+                      tok("; x = *(p + 1); p = realloc(p, 0);"));
+        ASSERT_EQUALS("; p = malloc ( 10 ) ; x = p [ i ] ;",
+                      tok("; p = realloc(0, 10); x = *(p + i);"));
+    }
+
     void simplifyErrNoInWhile()
     {
         ASSERT_EQUALS("; while ( f ( ) ) { }",
@@ -6588,6 +6616,94 @@ private:
         tok(code, false);
         ASSERT_EQUALS("", errout.str());
     }
+
+    /** Records the names of the timers */
+    class TimerNames : public TimerResultsIntf
+    {
+    public:
+        virtual void AddResults(const std::string &str, double)
+        {
+            names.insert(str);
+        }
+
+        virtual void AddTokens(const std::string &str, unsigned long tokensBefore, unsigned long tokensAfter)
+        {
+            tokens[str] = std::make_pair(tokensBefore, tokensAfter);
+        }
+
+        std::set<std::string> names;
+        std::map<std::string, std::pair<unsigned long, unsigned long> > tokens;
+    };
+
+    void showtime()
+    {
+        Settings settings;
+        settings._showtime = SHOWTIME_SUMMARY;
+        TimerNames timerNames;
+        Tokenizer tokenizer(&settings, this);
+        tokenizer.setTimerResults(&timerNames);
+
+        std::istringstream istr("void f() { x = 0 + + 1; y = (char)z; }");
+        tokenizer.tokenize(istr, "test.cpp");
+        tokenizer.simplifyTokenList();
+        std::string code;
+        for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next())
+            code += (tok == tokenizer.tokens() ? "" : " ") + tok->str();
+        ASSERT_EQUALS("void f ( ) { x = 1 ; y = z ; }", code);
+
+        // Each simplification is timed
+        ASSERT_EQUALS(1U, (unsigned int)timerNames.names.count("Tokenizer::simplifyCasts"));
+        ASSERT_EQUALS(1U, (unsigned int)timerNames.names.count("Tokenizer::simplifyKnownVariables"));
+
+        // The rules that share a walk are timed together
+        ASSERT_EQUALS(1U, (unsigned int)timerNames.names.count("Tokenizer::simplifyPlusMinus,simplifyArrayIndex"));
+        ASSERT_EQUALS(timerNames.tokens["Tokenizer::simplifyPlusMinus,simplifyArrayIndex"].first,
+                      timerNames.tokens["Tokenizer::simplifyPlusMinus,simplifyArrayIndex"].second + 1);
+
+        // The simplifications in Tokenizer::tokenize are timed too
+        ASSERT_EQUALS(1U, (unsigned int)timerNames.names.count("Tokenizer::simplifyTypedef"));
+        ASSERT_EQUALS(1U, (unsigned int)timerNames.names.count("Tokenizer::setVarId"));
+
+        // The tokens before and after each simplification are counted
+        ASSERT_EQUALS(timerNames.names.size(), timerNames.tokens.size());
+        ASSERT_EQUALS(19UL, timerNames.tokens["Tokenizer::simplifyCasts"].first);
+        ASSERT_EQUALS(16UL, timerNames.tokens["Tokenizer::simplifyCasts"].second);
+    }
+
+    void unchangedScopes()
+    {
+        // f needs several rounds of simplifications, g and h do not
+        const char code[] = "int g() { return 1; }\n"
+                            "void f() {\n"
+                            "    int a = 1;\n"
+                            "    int b = (a > 0) ? a + 1 : 0;\n"
+                            "    int c = (b > 1) ? b + 1 : 0;\n"
+                            "    x = c + g();\n"
+                            "}\n"
+                            "void h() { y = 2 * 3; }\n";
+        ASSERT_EQUALS("int g ( ) { return 1 ; } "
+                      "void f ( ) { ; x = 4 ; } "
+                      "void h ( ) { y = 6 ; }", tok(code));
+
+        // The call of g only shows up in a later round, in a scope that was
+        // changed; g itself is unchanged and its body is still used
+        const char code2[] = "int g() { return 1; }\n"
+                             "void h() { y = 2 * 3; }\n"
+                             "void f() { int a = 1; int b = (a > 0) ? a + 1 : 0; x = (b > 1) ? g() : 0; }\n";
+        ASSERT_EQUALS("int g ( ) { return 1 ; } "
+                      "void h ( ) { y = 6 ; } "
+                      "void f ( ) { ; x = 1 ; }", tok(code2));
+
+        Settings settings;
+        Tokenizer tokenizer(&settings, this);
+        std::istringstream istr(code);
+        tokenizer.tokenize(istr, "test.cpp");
+        tokenizer.simplifyTokenList();
+
+        // The scopes are not marked after the simplifications
+        for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next())
+            ASSERT_EQUALS(false, tok->isUnchangedScope());
+    }
 };
 
 REGISTER_TEST(TestSimplifyTokens)
@@ -24,6 +24,7 @@
 #include "cppcheck.h"
 #include "testsuite.h"
 #include "threadexecutor.h"
+#include "filelister.h"
 
 #include <algorithm>
 #include <map>
@@ -41,11 +42,20 @@ public:
 
 private:
 
+    /** @brief The reported status, index and max, see reportStatus() */
+    std::vector<std::pair<unsigned int, unsigned int> > _status;
+
+    virtual void reportStatus(unsigned int index, unsigned int max)
+    {
+        _status.push_back(std::make_pair(index, max));
+    }
+
     /**
      * Execute check using n jobs for y files which are have
      * identical data, given within data.
      */
-    void check(unsigned int jobs, int files, int result, const std::string &data)
+    void check(unsigned int jobs, int files, int result, const std::string &data,
+               Settings::Executor executorType = Settings::EXECUTOR_PROCESSES)
     {
         errout.str("");
         output.str("");
@@ -65,6 +75,7 @@ private:
 
         Settings settings;
         settings._jobs = jobs;
+        settings._executor = executorType;
         ThreadExecutor executor(filenames, settings, *this);
         for (unsigned int i = 0; i < filenames.size(); ++i)
             executor.addFileContent(filenames[i], data);
@@ -80,6 +91,20 @@ private:
         TEST_CASE(no_errors_equal_amount_files);
         TEST_CASE(one_error_less_files);
         TEST_CASE(one_error_several_files);
+        TEST_CASE(many_workers);
+        TEST_CASE(showtime);
+        TEST_CASE(each_file_once);
+        TEST_CASE(output_order);
+        TEST_CASE(search_files);
+        TEST_CASE(configurations);
+        TEST_CASE(too_many_configurations);
+        TEST_CASE(threads_many_errors);
+        TEST_CASE(threads_no_errors);
+        TEST_CASE(threads_one_error_several_files);
+        TEST_CASE(threads_showtime);
+        TEST_CASE(threads_output_order);
+        TEST_CASE(threads_search_files);
+        TEST_CASE(threads_configurations);
     }
 
     void deadlock_with_many_errors()
@@ -140,6 +165,270 @@ private:
         oss << "}\n";
         check(2, 20, 20, oss.str());
     }
+
+    void many_workers()
+    {
+        // The pipes of all the workers are waited for at once
+        std::ostringstream oss;
+        oss << "int main()\n"
+            << "{\n";
+        oss << "  {char *a = malloc(10);}\n";
+        oss << "}\n";
+        check(64, 100, 100, oss.str());
+    }
+
+    void showtime(Settings::Executor executorType = Settings::EXECUTOR_PROCESSES)
+    {
+        if (!ThreadExecutor::isEnabled())
+            return;
+
+        std::vector<std::string> filenames;
+        filenames.push_back("file_1.cpp");
+        filenames.push_back("file_2.cpp");
+        filenames.push_back("file_3.cpp");
+
+        Settings settings;
+        settings._jobs = 2;
+        settings._showtime = SHOWTIME_SUMMARY;
+        settings._executor = executorType;
+        ThreadExecutor executor(filenames, settings, *this);
+        for (unsigned int i = 0; i < filenames.size(); ++i)
+            executor.addFileContent(filenames[i], "int main()\n{\n}\n");
+        executor.check();
+
+        // The timer results of the child processes or threads are merged
+        std::ostringstream ostr;
+        executor.timerResults().ShowResults(ostr, SHOWTIME_CSV);
+        ASSERT(ostr.str().find("\nTokenizer::tokenize,") != std::string::npos);
+        ASSERT(ostr.str().find("\nPer file,") != std::string::npos);
+        ASSERT_EQUALS(",3,", ostr.str().substr(ostr.str().find(',', ostr.str().find("\nPer file,") + 10), 3));
+    }
+
+    void each_file_once()
+    {
+        // The workers check several files each
+        check(2, 5, 5, "int main()\n{\n  {char *a = malloc(10);}\n}\n");
+        for (int i = 1; i <= 5; ++i)
+        {
+            std::ostringstream expected;
+            expected << "[file_" << i << ".cpp:3]: (error) Memory leak: a\n";
+            const std::string::size_type pos = errout.str().find(expected.str());
+            ASSERT(pos != std::string::npos);
+            ASSERT_EQUALS(std::string::npos, errout.str().find(expected.str(), pos + 1));
+        }
+    }
+
+    /**
+     * The larger files are checked first, but the errors are reported
+     * in the order the files were given
+     */
+    void output_order(Settings::Executor executorType = Settings::EXECUTOR_PROCESSES)
+    {
+        errout.str("");
+        if (!ThreadExecutor::isEnabled())
+            return;
+
+        std::vector<std::string> filenames;
+        for (int i = 1; i <= 6; ++i)
+        {
+            std::ostringstream oss;
+            oss << "file_" << i << ".cpp";
+            filenames.push_back(oss.str());
+        }
+
+        Settings settings;
+        settings._jobs = 3;
+        settings._executor = executorType;
+        ThreadExecutor executor(filenames, settings, *this);
+        for (unsigned int i = 0; i < filenames.size(); ++i)
+        {
+            std::ostringstream code;
+            code << "int main()\n{\n";
+            for (unsigned int j = 0; j < 50 * i; ++j)
+                code << "  {int x = 0;}\n";
+            code << "  {char *a = malloc(10);}\n}\n";
+            executor.addFileContent(filenames[i], code.str());
+        }
+        ASSERT_EQUALS(6, executor.check());
+
+        std::ostringstream expected;
+        for (unsigned int i = 0; i < filenames.size(); ++i)
+            expected << "[" << filenames[i] << ":" << (3 + 50 * i) << "]: (error) Memory leak: a\n";
+        ASSERT_EQUALS(expected.str(), errout.str());
+    }
+
+    /**
+     * The files are searched while they are checked. Their contents are
+     * given so that only the search uses the file system.
+     */
+    void search_files(Settings::Executor executorType = Settings::EXECUTOR_PROCESSES)
+    {
+        errout.str("");
+        if (!ThreadExecutor::isEnabled())
+            return;
+
+        std::vector<std::string> paths, ignored, found;
+        paths.push_back("cli/");
+        ignored.push_back("main.cpp");
+        getFileLister()->recursiveAddFiles(found, "cli/");
+        found.erase(std::find(found.begin(), found.end(), "cli/main.cpp"));
+        ASSERT(found.size() > 2);
+
+        std::vector<std::string> filenames;
+        filenames.push_back("given.cpp");
+
+        Settings settings;
+        settings._jobs = 3;
+        settings._executor = executorType;
+        ThreadExecutor executor(filenames, settings, *this);
+        executor.searchFiles(paths, ignored);
+        executor.addFileContent("given.cpp", "void f()\n{\n  {char *a = malloc(10);}\n}\n");
+        for (unsigned int i = 0; i < found.size(); ++i)
+            executor.addFileContent(found[i], "void f()\n{\n  {char *a = malloc(10);}\n}\n");
+        _status.clear();
+        ASSERT_EQUALS(found.size() + 1, executor.check());
+
+        // The total is not reported until the search has finished
+        ASSERT_EQUALS(found.size() + 1, _status.size());
+        for (unsigned int i = 0; i < _status.size(); ++i)
+        {
+            ASSERT_EQUALS(i + 1, _status[i].first);
+            ASSERT(_status[i].second == 0 || _status[i].second == found.size() + 1);
+        }
+
+        // The given file first, then the found files in the order they are found
+        filenames.insert(filenames.end(), found.begin(), found.end());
+        ASSERT(filenames == executor.filenames());
+        std::ostringstream expected;
+        for (unsigned int i = 0; i < filenames.size(); ++i)
+            expected << "[" << filenames[i] << ":3]: (error) Memory leak: a\n";
+        ASSERT_EQUALS(expected.str(), errout.str());
+    }
+
+    /**
+     * Check the files with the executor and with a single CppCheck
+     * instance, the errors should be the same
+     */
+    void compareWithSingleInstance(const std::vector<std::string> &code, Settings::Executor executorType)
+    {
+        errout.str("");
+        if (!ThreadExecutor::isEnabled())
+            return;
+
+        std::vector<std::string> filenames;
+        for (unsigned int i = 0; i < code.size(); ++i)
+        {
+            std::ostringstream oss;
+            oss << "file_" << (i + 1) << ".cpp";
+            filenames.push_back(oss.str());
+        }
+
+        CppCheck cppCheck(*this, true);
+        for (unsigned int i = 0; i < filenames.size(); ++i)
+            cppCheck.addFile(filenames[i], code[i]);
+        cppCheck.check();
+        const std::string expected(errout.str());
+        ASSERT(!expected.empty());
+
+        errout.str("");
+        Settings settings;
+        settings._jobs = 3;
+        settings._executor = executorType;
+        ThreadExecutor executor(filenames, settings, *this);
+        for (unsigned int i = 0; i < filenames.size(); ++i)
+            executor.addFileContent(filenames[i], code[i]);
+        ASSERT_EQUALS(filenames.size(), executor.check());
+        ASSERT_EQUALS(expected, errout.str());
+    }
+
+    /** The configurations of a file are checked by several workers */
+    void configurations(Settings::Executor executorType = Settings::EXECUTOR_PROCESSES)
+    {
+        std::vector<std::string> code;
+        code.push_back("#ifdef A\n"
+                       "void a() { char *p = malloc(10); }\n"
+                       "#endif\n"
+                       "#ifdef B\n"
+                       "void b() { char *p = malloc(10); }\n"
+                       "#endif\n"
+                       "#ifdef C\n"
+                       "void c() { char *p = malloc(10); }\n"
+                       "#endif\n"
+                       "void f() { char *p = malloc(10); }\n");
+        code.push_back("void g() { char *p = malloc(10); }\n");
+        code.push_back("#ifdef D\n"
+                       "void d() { char *p = malloc(10); }\n"
+                       "#else\n"
+                       "void e() { char *p = malloc(10); }\n"
+                       "#endif\n");
+        compareWithSingleInstance(code, executorType);
+    }
+
+    void too_many_configurations()
+    {
+        std::ostringstream oss;
+        for (int i = 0; i < 14; ++i)
+            oss << "#ifdef C" << i << "\n"
+                << "void f" << i << "() { char *p = malloc(10); }\n"
+                << "#endif\n";
+
+        std::vector<std::string> code;
+        code.push_back(oss.str());
+        code.push_back("void g() { char *p = malloc(10); }\n");
+        compareWithSingleInstance(code, Settings::EXECUTOR_PROCESSES);
+        ASSERT(errout.str().find("toomanyconfigs") != std::string::npos ||
+               errout.str().find("too many #ifdef configurations") != std::string::npos);
+        compareWithSingleInstance(code, Settings::EXECUTOR_THREADS);
+    }
+
+    void threads_many_errors()
+    {
+        std::ostringstream oss;
+        oss << "int main()\n"
+            << "{\n";
+        for (int i = 0; i < 500; i++)
+            oss << "  {char *a = malloc(10);}\n";
+
+        oss << "}\n";
+        check(2, 3, 3, oss.str(), Settings::EXECUTOR_THREADS);
+        ASSERT_EQUALS("[file_1.cpp:3]: (error) Memory leak: a\n", errout.str().substr(0, errout.str().find('\n') + 1));
+    }
+
+    void threads_no_errors()
+    {
+        check(4, 2, 0, "int main()\n{\n}\n", Settings::EXECUTOR_THREADS);
+        ASSERT_EQUALS("", errout.str());
+    }
+
+    void threads_one_error_several_files()
+    {
+        std::ostringstream oss;
+        oss << "int main()\n"
+            << "{\n";
+        oss << "  {char *a = malloc(10);}\n";
+        oss << "}\n";
+        check(3, 20, 20, oss.str(), Settings::EXECUTOR_THREADS);
+    }
+
+    void threads_showtime()
+    {
+        showtime(Settings::EXECUTOR_THREADS);
+    }
+
+    void threads_output_order()
+    {
+        output_order(Settings::EXECUTOR_THREADS);
+    }
+
+    void threads_search_files()
+    {
+        search_files(Settings::EXECUTOR_THREADS);
+    }
+
+    void threads_configurations()
+    {
+        configurations(Settings::EXECUTOR_THREADS);
+    }
 };
 
 REGISTER_TEST(TestThreadExecutor)
@@ -0,0 +1,198 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <sstream>
+#include <vector>
+#include "testsuite.h"
+#include "timer.h"
+
+class TestTimer : public TestFixture
+{
+public:
+    TestTimer() : TestFixture("TestTimer")
+    { }
+
+private:
+
+    void run()
+    {
+        TEST_CASE(summary);
+        TEST_CASE(csv);
+        TEST_CASE(csvQuoted);
+        TEST_CASE(json);
+        TEST_CASE(jsonEscaped);
+        TEST_CASE(percentile);
+        TEST_CASE(serialize);
+        TEST_CASE(deserializeInvalid);
+        TEST_CASE(timer);
+    }
+
+    /**
+     * A stage that was run twice, with a simplification in it, and two
+     * files
+     */
+    static void addResults(TimerResults &results)
+    {
+        results.AddResults("Tokenizer::simplifyTokenList", 1.0);
+        results.AddResults("Tokenizer::simplifyTokenList", 3.0);
+        results.AddResults("Tokenizer::simplifyCasts", 0.5);
+        results.AddTokens("Tokenizer::simplifyCasts", 100, 90);
+        results.AddFileResults("a.c", 1.0);
+        results.AddFileResults("b.c", 2.5);
+    }
+
+    static std::string show(const TimerResults &results, unsigned int showtimeMode)
+    {
+        std::ostringstream ostr;
+        results.ShowResults(ostr, showtimeMode);
+        return ostr.str();
+    }
+
+    void summary()
+    {
+        TimerResults results;
+        addResults(results);
+        ASSERT_EQUALS("Tokenizer::simplifyCasts: 0.5s (avg. 0.5s - 1 result(s)) p50: 0.5s p95: 0.5s max: 0.5s tokens: 100 -> 90\n"
+                      "Tokenizer::simplifyTokenList: 4s (avg. 2s - 2 result(s)) p50: 1s p95: 3s max: 3s\n"
+                      "Per file: 3.5s (avg. 1.75s - 2 result(s)) p50: 1s p95: 2.5s max: 2.5s slowest: b.c\n"
+                      "Overall time: 4s\n", show(results, SHOWTIME_SUMMARY));
+    }
+
+    void csv()
+    {
+        TimerResults results;
+        addResults(results);
+        ASSERT_EQUALS("name,seconds,calls,p50,p95,max,tokensBefore,tokensAfter\n"
+                      "Tokenizer::simplifyCasts,0.5,1,0.5,0.5,0.5,100,90\n"
+                      "Tokenizer::simplifyTokenList,4,2,1,3,3,,\n"
+                      "Per file,3.5,2,1,2.5,2.5,,\n", show(results, SHOWTIME_CSV));
+    }
+
+    void csvQuoted()
+    {
+        TimerResults results;
+        results.AddResults("a,\"b\"", 1.0);
+        ASSERT_EQUALS("name,seconds,calls,p50,p95,max,tokensBefore,tokensAfter\n"
+                      "\"a,\"\"b\"\"\",1,1,1,1,1,,\n", show(results, SHOWTIME_CSV));
+    }
+
+    void json()
+    {
+        TimerResults results;
+        addResults(results);
+        ASSERT_EQUALS("{\n"
+                      "  \"results\": [\n"
+                      "    { \"name\": \"Tokenizer::simplifyCasts\", \"seconds\": 0.5, \"calls\": 1, \"p50\": 0.5, \"p95\": 0.5, \"max\": 0.5, \"tokensBefore\": 100, \"tokensAfter\": 90 },\n"
+                      "    { \"name\": \"Tokenizer::simplifyTokenList\", \"seconds\": 4, \"calls\": 2, \"p50\": 1, \"p95\": 3, \"max\": 3 }\n"
+                      "  ],\n"
+                      "  \"files\": { \"name\": \"Per file\", \"seconds\": 3.5, \"calls\": 2, \"p50\": 1, \"p95\": 2.5, \"max\": 2.5 },\n"
+                      "  \"slowestFile\": \"b.c\",\n"
+                      "  \"overall\": 4\n"
+                      "}\n", show(results, SHOWTIME_JSON));
+    }
+
+    void jsonEscaped()
+    {
+        TimerResults results;
+        results.AddResults("a\"b\\c\t", 1.0);
+        ASSERT_EQUALS("{\n"
+                      "  \"results\": [\n"
+                      "    { \"name\": \"a\\\"b\\\\c\\u0009\", \"seconds\": 1, \"calls\": 1, \"p50\": 1, \"p95\": 1, \"max\": 1 }\n"
+                      "  ],\n"
+                      "  \"overall\": 1\n"
+                      "}\n", show(results, SHOWTIME_JSON));
+    }
+
+    void percentile()
+    {
+        TimerHistogram histogram;
+        ASSERT_EQUALS(0.0, histogram.percentile(50));
+
+        histogram.add(7.0);
+        ASSERT_EQUALS(7.0, histogram.percentile(50));
+        ASSERT_EQUALS(7.0, histogram.percentile(100));
+
+        // 20 samples in reverse order, the percentiles are within 5%
+        histogram = TimerHistogram();
+        for (unsigned int i = 20; i > 0; --i)
+            histogram.add(i);
+        ASSERT(std::fabs(histogram.percentile(50) / 10.0 - 1.0) < 0.05);
+        ASSERT(std::fabs(histogram.percentile(95) / 19.0 - 1.0) < 0.05);
+        ASSERT_EQUALS(1.0, histogram.percentile(1));
+        ASSERT_EQUALS(20.0, histogram.percentile(100));
+
+        // A million samples take no more space than a few
+        for (unsigned int i = 0; i < 1000000; ++i)
+            histogram.add(0.001);
+        ASSERT_EQUALS(0.001, histogram.percentile(50));
+        ASSERT_EQUALS(20.0, histogram.percentile(100));
+    }
+
+    void serialize()
+    {
+        TimerResults results;
+        addResults(results);
+        results.AddResults("name with spaces", 0.125);
+        results.AddFileResults("dir with spaces/c.c", 0.25);
+
+        // The results of two child processes are merged
+        TimerResults merged;
+        ASSERT(merged.deserialize(results.serialize()));
+        ASSERT_EQUALS(show(results, SHOWTIME_CSV), show(merged, SHOWTIME_CSV));
+
+        ASSERT(merged.deserialize(results.serialize()));
+        TimerResults twice;
+        twice.Merge(results);
+        twice.Merge(results);
+        ASSERT_EQUALS(show(twice, SHOWTIME_CSV), show(merged, SHOWTIME_CSV));
+        ASSERT_EQUALS("Tokenizer::simplifyCasts: 1s (avg. 0.5s - 2 result(s)) p50: 0.5s p95: 0.5s max: 0.5s tokens: 200 -> 180\n",
+                      show(merged, SHOWTIME_SUMMARY).substr(0, show(merged, SHOWTIME_SUMMARY).find('\n') + 1));
+    }
+
+    void deserializeInvalid()
+    {
+        TimerResults results;
+        ASSERT_EQUALS(false, results.deserialize("X 1 a"));
+        ASSERT_EQUALS(false, results.deserialize("R 100 a"));
+        ASSERT_EQUALS(false, results.deserialize("R 1 a 0 0 0 2 1.0"));
+        ASSERT_EQUALS(false, results.deserialize("R 1 a 0 0 0 2 2 2 1 1 1 240 1"));
+        ASSERT_EQUALS(false, results.deserialize("R 1 a 0 0 0 1 1 1 1 1 1 9999 1"));
+        ASSERT_EQUALS("Overall time: 0s\n", show(results, SHOWTIME_SUMMARY));
+    }
+
+    void timer()
+    {
+        const double start = Timer::now();
+
+        TimerResults results;
+        {
+            Timer t("stage", SHOWTIME_SUMMARY, &results);
+        }
+        {
+            Timer t("stage", SHOWTIME_NONE, &results);
+        }
+
+        ASSERT(Timer::now() >= start);
+        const std::string csv(show(results, SHOWTIME_CSV));
+        ASSERT_EQUALS("stage,", csv.substr(csv.find('\n') + 1, 6));
+        ASSERT_EQUALS(std::string::npos, csv.find("stage", csv.find("stage") + 1));
+    }
+};
+
+REGISTER_TEST(TestTimer)
@@ -38,14 +38,23 @@ private:
         TEST_CASE(multiCompare);
         TEST_CASE(getStrLength);
         TEST_CASE(strValue);
+        TEST_CASE(strHash);
+        TEST_CASE(strId);
+        TEST_CASE(kind);
 
         TEST_CASE(deleteLast);
+        TEST_CASE(arena);
+        TEST_CASE(layout);
 
         TEST_CASE(matchAny);
         TEST_CASE(matchNothingOrAnyNotElse);
         TEST_CASE(matchNumeric);
         TEST_CASE(matchBoolean);
         TEST_CASE(matchOr);
+        TEST_CASE(matchOp);
+        TEST_CASE(matchCompiled);
+        TEST_CASE(matchCompiledSpecialTokens);
+        TEST_CASE(matchChangedPattern);
     }
 
     void nextprevious()
@@ -119,6 +128,124 @@ private:
     }
 
 
+    void strHash()
+    {
+        Token *token = new Token(0);
+        token->str("int");
+        token->insertToken("int");
+        token->next()->insertToken("x");
+
+        // Equal strings are interned once
+        ASSERT_EQUALS(true, token->strHash() == token->next()->strHash());
+        ASSERT_EQUALS(true, &token->str() == &token->next()->str());
+        ASSERT_EQUALS(true, token->strHash() == Token::strHash("int"));
+        ASSERT_EQUALS(false, token->strHash() == token->tokAt(2)->strHash());
+
+        // Changing the string changes the hash
+        token->next()->str("x");
+        ASSERT_EQUALS(true, token->next()->strHash() == token->tokAt(2)->strHash());
+        ASSERT_EQUALS("int", token->str());
+
+        token->str("\"a\"");
+        token->concatStr("\"b\"");
+        ASSERT_EQUALS("\"ab\"", token->str());
+        ASSERT_EQUALS(true, token->strHash() == Token::strHash("\"ab\""));
+
+        Tokenizer::deleteTokens(token);
+    }
+
+    void strId()
+    {
+        TokenArena arena;
+        Token *tokensBack = 0;
+        Token *token = arena.newToken(&tokensBack);
+        token->str("int");
+        token->insertToken("x");
+        token->next()->insertToken("int");
+        token->tokAt(2)->insertToken("x");
+
+        // Equal strings have the same id, different strings have different ids
+        ASSERT_EQUALS(true, token->strId() == token->tokAt(2)->strId());
+        ASSERT_EQUALS(true, token->next()->strId() == token->tokAt(3)->strId());
+        ASSERT_EQUALS(false, token->strId() == token->next()->strId());
+
+        // Common strings have the same id in all pools
+        Token *other = new Token(0);
+        other->str("int");
+        ASSERT_EQUALS(true, Token::commonStrId("int") != 0);
+        ASSERT_EQUALS(true, token->strId() == Token::commonStrId("int"));
+        ASSERT_EQUALS(true, other->strId() == Token::commonStrId("int"));
+        ASSERT_EQUALS(true, Token::commonStrId(";") != Token::commonStrId("int"));
+        ASSERT_EQUALS(0U, Token::commonStrId("x"));
+        Token::destroy(other);
+
+        // The id of a common string doesn't change when the unused strings are removed
+        for (unsigned int i = 0; i < 2000; ++i)
+        {
+            std::ostringstream ostr;
+            ostr << "x" << i;
+            token->next()->str(ostr.str());
+        }
+        token->next()->str("while");
+        ASSERT_EQUALS(true, token->next()->strId() == Token::commonStrId("while"));
+
+        arena.release();
+    }
+
+    void kind()
+    {
+        Token *token = new Token(0);
+
+        const struct
+        {
+            const char *str;
+            Token::Kind kind;
+        } kinds[] =
+        {
+            { "abc", Token::eName }, { "_x", Token::eName }, { "if", Token::eKeyword },
+            { "return", Token::eKeyword }, { "void", Token::eKeyword }, { "int", Token::eStandardType },
+            { "size_t", Token::eStandardType }, { "true", Token::eBoolean }, { "12", Token::eNumber },
+            { "-1", Token::eNumber }, { "\"a\"", Token::eString }, { "'a'", Token::eChar },
+            { "{", Token::eOpenBrace }, { "}", Token::eCloseBrace }, { "(", Token::eOpenParen },
+            { ")", Token::eCloseParen }, { "[", Token::eOpenBracket }, { "]", Token::eCloseBracket },
+            { ";", Token::eSemicolon }, { ",", Token::eComma }, { "<<=", Token::eAssignmentOp },
+            { "!=", Token::eComparisonOp }, { ">>", Token::eArithmeticalOp }, { "~", Token::eBitOp },
+            { "!", Token::eLogicalOp }, { "--", Token::eIncDecOp }, { "::", Token::eOther },
+            { "", Token::eOther }
+        };
+
+        for (unsigned int i = 0; i < sizeof(kinds) / sizeof(*kinds); ++i)
+        {
+            token->str(kinds[i].str);
+            if (token->kind() != kinds[i].kind)
+                ASSERT_EQUALS(kinds[i].str, "");
+        }
+
+        // The classification functions are consistent with the kind
+        token->str("int");
+        ASSERT_EQUALS(true, token->isName());
+        ASSERT_EQUALS(true, token->isStandardType());
+        token->str("false");
+        ASSERT_EQUALS(true, token->isName());
+        ASSERT_EQUALS(true, token->isBoolean());
+        token->str("-1");
+        ASSERT_EQUALS(false, token->isName());
+        ASSERT_EQUALS(true, token->isNumber());
+        token->str("&&");
+        ASSERT_EQUALS(true, token->isOp());
+        token->str("+=");
+        ASSERT_EQUALS(false, token->isOp());
+        ASSERT_EQUALS(true, token->isAssignmentOp());
+
+        // The kind follows the token when a token is deleted
+        token->str("x");
+        token->insertToken("{");
+        token->deleteThis();
+        ASSERT_EQUALS(Token::eOpenBrace, token->kind());
+
+        Tokenizer::deleteTokens(token);
+    }
+
     void deleteLast()
     {
         Token *tokensBack = 0;
@@ -130,6 +257,77 @@ private:
     }
 
 
+    void arena()
+    {
+        TokenArena arena;
+        ASSERT_EQUALS(true, arena.empty());
+
+        Token *tokensBack = 0;
+        Token *token = arena.newToken(&tokensBack);
+        token->str("1");
+        token->insertToken("2");
+        token->next()->insertToken("3");
+        ASSERT_EQUALS(false, arena.empty());
+        ASSERT_EQUALS(true, tokensBack == token->tokAt(2));
+
+        // Tokens in an arena are aligned to the cache lines
+        ASSERT_EQUALS(0U, (unsigned int)(reinterpret_cast<std::size_t>(token) % 64));
+
+        // The memory of a deleted token is reused by the next token
+        const Token *deleted = token->next();
+        token->deleteNext();
+        token->insertToken("4");
+        ASSERT_EQUALS(true, token->next() == deleted);
+        ASSERT_EQUALS("4", token->strAt(1));
+        ASSERT_EQUALS("3", token->strAt(2));
+
+        // The strings are interned in the pool of the arena
+        token->tokAt(2)->str("1");
+        ASSERT_EQUALS(true, &token->str() == &token->tokAt(2)->str());
+
+        // Tokens that are allocated with new are interned in another pool
+        Token *other = new Token(0);
+        other->str("1");
+        ASSERT_EQUALS(false, &token->str() == &other->str());
+        Token::destroy(other);
+
+        // All the tokens are released at once
+        arena.release();
+        ASSERT_EQUALS(true, arena.empty());
+    }
+
+    void layout()
+    {
+        // A token fits in a cache line
+        ASSERT(sizeof(Token) <= 64);
+
+        Token *token = new Token(0);
+
+        // The packed flags are independent of each other
+        token->str("abc");
+        token->isUnsigned(true);
+        token->isLong(true);
+        ASSERT_EQUALS(true, token->isName());
+        ASSERT_EQUALS(false, token->isNumber());
+        ASSERT_EQUALS(true, token->isUnsigned());
+        ASSERT_EQUALS(false, token->isSigned());
+        ASSERT_EQUALS(true, token->isLong());
+        ASSERT_EQUALS(false, token->isUnused());
+        token->isUnsigned(false);
+        ASSERT_EQUALS(false, token->isUnsigned());
+        ASSERT_EQUALS(true, token->isLong());
+
+        // The progress value is packed, all the values 0-100 fit
+        for (unsigned int i = 0; i < 99; ++i)
+            token->insertToken("x");
+        token->assignProgressValues();
+        ASSERT_EQUALS(0U, token->progressValue());
+        ASSERT_EQUALS(50U, token->tokAt(50)->progressValue());
+        ASSERT_EQUALS(99U, token->tokAt(99)->progressValue());
+
+        Tokenizer::deleteTokens(token);
+    }
+
     void matchAny()
     {
         givenACodeSampleToTokenize varBitOrVar("abc|def");
@@ -222,6 +420,107 @@ private:
         ASSERT_EQUALS(false, Token::Match(logicalOr.tokens(), "%or%"));
         ASSERT_EQUALS(false, Token::Match(bitwiseOr.tokens(), "%oror%"));
     }
+
+    void matchOp()
+    {
+        givenACodeSampleToTokenize op("a + b == c && !d");
+        ASSERT_EQUALS(true, Token::Match(op.tokens(), "%var% %op% %var% %op% %var% %op% %op% %var%"));
+
+        givenACodeSampleToTokenize assign("a += 1");
+        ASSERT_EQUALS(false, Token::Match(assign.tokens(), "%var% %op%"));
+        ASSERT_EQUALS(false, MatchPattern("%var% %op%").match(assign.tokens()));
+    }
+
+    void matchCompiled()
+    {
+        // The compiled patterns must give the same result as the interpreted patterns
+        const char * const patterns[] =
+        {
+            "", " ", "%var%", "%type%", "%any% %any%", "%num%", "%bool%", "%str%",
+            "%or%", "%oror%", "%var% = %num% ;", "%type% %var% [;=]", "[;{}]",
+            "[]]", "[]]]", "[(|]", "if|while (", "if|while|", "|if ( %var%",
+            "!!else", "!!else ;", "!! if", "if ; !!else",
+            "!!return if", "( !!)", "| |", "||", "|=", "|||", "\"a b\"",
+            "\"a", "[abc", "! !", "%op%", "%var% %op% %num%", "[{}]", "[(,]",
+            "[;{}] %var%", "!![;{}]", "[;{}]|else", 0
+        };
+
+        const char * const code[] =
+        {
+            "", "if ; else", "int x = 3 ;", "abc|def", "abc||def", "x|=1;",
+            "if (a) { b; }", "while ( x ) ;", "return true;", "s = \"a b\";",
+            "a[0] = ]", "delete p;", "x = a + b * !c;", "f(a, b);", 0
+        };
+
+        for (unsigned int c = 0; code[c]; ++c)
+        {
+            givenACodeSampleToTokenize sample(code[c]);
+            for (const Token *tok = sample.tokens(); tok; tok = tok->next())
+            {
+                for (unsigned int p = 0; patterns[p]; ++p)
+                {
+                    const bool expected = Token::Match(tok, patterns[p]);
+                    if (MatchPattern(patterns[p]).match(tok) != expected)
+                        ASSERT_EQUALS(std::string(patterns[p]) + " : " + tok->str(), "");
+                }
+            }
+            ASSERT_EQUALS(true, MatchPattern("!!else").match(0));
+            ASSERT_EQUALS(false, MatchPattern("else").match(0));
+        }
+    }
+
+    void matchCompiledSpecialTokens()
+    {
+        // The simplifications create tokens with spaces and pipes
+        Token *token = new Token(0);
+        token->str("operator =");
+        token->insertToken("a b");
+        token->next()->insertToken("b|c");
+        token->tokAt(2)->insertToken("- 1");
+
+        const char * const patterns[] =
+        {
+            "operator =", "operator", "a b", "a|b|c", "b|c", "b", "%var%",
+            "%any% a b", "-", "- 1", "%num%", "%op%", "[-+]", 0
+        };
+
+        for (const Token *tok = token; tok; tok = tok->next())
+        {
+            for (unsigned int p = 0; patterns[p]; ++p)
+            {
+                const bool expected = Token::Match(tok, patterns[p]);
+                if (MatchPattern(patterns[p]).match(tok) != expected)
+                    ASSERT_EQUALS(std::string(patterns[p]) + " : " + tok->str(), "");
+            }
+        }
+
+        Tokenizer::deleteTokens(token);
+    }
+
+    void matchChangedPattern()
+    {
+        givenACodeSampleToTokenize sample("int x ;");
+
+        // A pattern buffer that is changed between the calls is matched with its new contents
+        char pattern[20] = "int %var% ;";
+        ASSERT_EQUALS(true, Token::Match(sample.tokens(), pattern));
+        std::strcpy(pattern, "int %num% ;");
+        ASSERT_EQUALS(false, Token::Match(sample.tokens(), pattern));
+        std::strcpy(pattern, "int");
+        ASSERT_EQUALS(true, Token::Match(sample.tokens(), pattern));
+        std::strcpy(pattern, "int x ; y");
+        ASSERT_EQUALS(false, Token::Match(sample.tokens(), pattern));
+        // The pattern is compiled when its address is seen again
+        char pattern2[20] = "int %var% ;";
+        ASSERT_EQUALS(true, Token::Match(sample.tokens(), pattern2));
+        ASSERT_EQUALS(true, Token::Match(sample.tokens(), pattern2));
+        std::strcpy(pattern2, "int %var% ; x");
+        ASSERT_EQUALS(false, Token::Match(sample.tokens(), pattern2));
+        std::strcpy(pattern2, "char");
+        ASSERT_EQUALS(false, Token::Match(sample.tokens(), pattern2));
+        std::strcpy(pattern2, "int %var% ;");
+        ASSERT_EQUALS(true, Token::Match(sample.tokens(), pattern2));
+    }
 };
 
 REGISTER_TEST(TestToken)
@@ -46,7 +46,9 @@ void getDeps(const std::string &filename, std::vector<std::string> &depfiles)
     std::ifstream f(filename.c_str());
     if (! f.is_open())
     {
-        if (filename.compare(0, 4, "cli/") == 0 || filename.compare(0, 5, "test/") == 0)
+        if (filename.compare(0, 6, "bench/") == 0)
+            getDeps("test" + filename.substr(filename.find("/")), depfiles);
+        else if (filename.compare(0, 4, "cli/") == 0 || filename.compare(0, 5, "test/") == 0)
             getDeps("lib" + filename.substr(filename.find("/")), depfiles);
         return;
     }
@@ -175,6 +177,9 @@ int main(int argc, char **argv)
         return EXIT_FAILURE;
     }
 
+    std::vector<std::string> benchfiles;
+    getCppFiles(benchfiles, "bench/");
+
     std::vector<std::string> externalfiles;
     getCppFiles(externalfiles, "externals/");
 
@@ -186,6 +191,7 @@ int main(int argc, char **argv)
         {
             fout1 << "# no manual edits - this file is autogenerated by dmake\n\n";
             fout1 << "LIBS += -L../externals -lpcre\n";
+            fout1 << "unix:LIBS += -lpthread\n";
             fout1 << "INCLUDEPATH += ../externals ../externals/tinyxml\n";
             fout1 << "HEADERS += $${BASEPATH}check.h \\\n";
             for (unsigned int i = 0; i < libfiles.size(); ++i)
@@ -253,6 +259,7 @@ int main(int argc, char **argv)
     makeConditionalVariable(fout, "INCLUDE_FOR_LIB", "-Ilib");
     makeConditionalVariable(fout, "INCLUDE_FOR_CLI", "-Ilib -Iexternals -Iexternals/tinyxml");
     makeConditionalVariable(fout, "INCLUDE_FOR_TEST", "-Ilib -Icli -Iexternals -Iexternals/tinyxml");
+    makeConditionalVariable(fout, "INCLUDE_FOR_BENCH", "-Ilib -Itest");
 
     fout << "BIN=$(DESTDIR)$(PREFIX)/bin\n\n";
     fout << "# For 'make man': sudo apt-get install xsltproc docbook-xsl docbook-xml on Linux\n";
@@ -273,26 +280,32 @@ int main(int argc, char **argv)
     for (unsigned int i = 1; i < testfiles.size(); ++i)
         fout << " \\" << std::endl << std::string(14, ' ') << objfile(testfiles[i]);
     fout << "\n\n";
+    fout << "BENCHOBJ =    " << objfile(benchfiles[0]);
+    for (unsigned int i = 1; i < benchfiles.size(); ++i)
+        fout << " \\" << std::endl << std::string(14, ' ') << objfile(benchfiles[i]);
+    fout << "\n\n";
 
     makeExtObj(fout, externalfiles);
 
     fout << "\n###### Targets\n\n";
     fout << "cppcheck: $(LIBOBJ) $(CLIOBJ) $(EXTOBJ)\n";
-    fout << "\t$(CXX) $(CPPFLAGS) $(CXXFLAGS) -o cppcheck $(CLIOBJ) $(LIBOBJ) $(EXTOBJ) -lpcre $(LDFLAGS)\n\n";
+    fout << "\t$(CXX) $(CPPFLAGS) $(CXXFLAGS) -o cppcheck $(CLIOBJ) $(LIBOBJ) $(EXTOBJ) -lpcre -lpthread $(LDFLAGS)\n\n";
     fout << "all:\tcppcheck testrunner\n\n";
     fout << "testrunner: $(TESTOBJ) $(LIBOBJ) $(EXTOBJ) cli/threadexecutor.o cli/cmdlineparser.o cli/cppcheckexecutor.o cli/filelister.o cli/filelister_unix.o cli/pathmatch.o\n";
-    fout << "\t$(CXX) $(CPPFLAGS) $(CXXFLAGS) -o testrunner $(TESTOBJ) $(LIBOBJ) $(EXTOBJ) -lpcre cli/threadexecutor.o cli/cmdlineparser.o cli/filelister.o cli/filelister_unix.o cli/pathmatch.o $(LDFLAGS)\n\n";
+    fout << "\t$(CXX) $(CPPFLAGS) $(CXXFLAGS) -o testrunner $(TESTOBJ) $(LIBOBJ) $(EXTOBJ) -lpcre -lpthread cli/threadexecutor.o cli/cmdlineparser.o cli/filelister.o cli/filelister_unix.o cli/pathmatch.o $(LDFLAGS)\n\n";
+    fout << "benchmark: $(BENCHOBJ) $(LIBOBJ) $(EXTOBJ) test/testsuite.o test/options.o\n";
+    fout << "\t$(CXX) $(CPPFLAGS) $(CXXFLAGS) -o benchmark $(BENCHOBJ) $(LIBOBJ) $(EXTOBJ) -lpcre -lpthread test/testsuite.o test/options.o $(LDFLAGS)\n\n";
     fout << "test:\tall\n";
     fout << "\t./testrunner\n\n";
     fout << "check:\tall\n";
     fout << "\t./testrunner -g -q\n\n";
     fout << "dmake:\ttools/dmake.cpp\n";
-    fout << "\t$(CXX) -o dmake tools/dmake.cpp cli/filelister*.cpp lib/path.cpp -Ilib\n\n";
+    fout << "\t$(CXX) -o dmake tools/dmake.cpp cli/filelister*.cpp cli/pathmatch.cpp lib/path.cpp lib/threading.cpp -Ilib -lpthread\n\n";
     fout << "clean:\n";
 #ifdef _WIN32
-    fout << "\tdel lib\*.o\n\tdel cli\*.o\n\tdel test\*.o\n\tdel *.exe\n";
+    fout << "\tdel lib\*.o\n\tdel cli\*.o\n\tdel test\*.o\n\tdel bench\*.o\n\tdel *.exe\n";
 #else
-    fout << "\trm -f lib/*.o cli/*.o test/*.o externals/tinyxml/*.o testrunner cppcheck cppcheck.1\n\n";
+    fout << "\trm -f lib/*.o cli/*.o test/*.o bench/*.o externals/tinyxml/*.o testrunner benchmark cppcheck cppcheck.1\n\n";
     fout << "man:\tman/cppcheck.1\n\n";
     fout << "man/cppcheck.1:\t$(MAN_SOURCE)\n\n";
     fout << "\t$(XP) $(DB2MAN) $(MAN_SOURCE)\n\n";
@@ -308,6 +321,7 @@ int main(int argc, char **argv)
     compilefiles(fout, libfiles, "${INCLUDE_FOR_LIB}");
     compilefiles(fout, clifiles, "${INCLUDE_FOR_CLI}");
     compilefiles(fout, testfiles, "${INCLUDE_FOR_TEST}");
+    compilefiles(fout, benchfiles, "${INCLUDE_FOR_BENCH}");
 
     return 0;
 }